@@ -0,0 +1,73 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef DATA_BENCH
+#define DATA_BENCH
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <data/types.hpp>
+
+// utilities shared by the benchmarks. 
+namespace data::bench {
+    
+    using clock = std::chrono::steady_clock;
+    
+    // time a function in seconds. 
+    template <typename F>
+    double seconds(F f) {
+        auto start = clock::now();
+        f();
+        return std::chrono::duration<double>(clock::now() - start).count();
+    }
+    
+    // keep a result alive so that the compiler cannot discard 
+    // the work that computed it. 
+    template <typename X>
+    inline void keep(const X& x) {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(x) : "memory");
+#else
+        static volatile const void* sink;
+        sink = &x;
+#endif
+    }
+    
+    // the first command line argument, if given, overrides 
+    // the largest power of ten that a benchmark will try. 
+    inline uint32 max_exponent(int argc, char** argv, uint32 fallback) {
+        if (argc < 2) return fallback;
+        return static_cast<uint32>(std::strtoul(argv[1], nullptr, 10));
+    }
+    
+    inline uint64 power_of_ten(uint32 exponent) {
+        uint64 x = 1;
+        for (uint32 i = 0; i < exponent; i++) x *= 10;
+        return x;
+    }
+    
+    inline void header(const string& title) {
+        std::cout << std::endl << title << std::endl;
+    }
+    
+    // print one row of results as the name of the case, the 
+    // number of operations, and nanoseconds per operation. 
+    inline void row(const string& name, uint64 n, uint64 ops, double seconds) {
+        std::cout << "  " << std::left << std::setw(36) << name 
+            << " n = " << std::setw(10) << n 
+            << std::right << std::setw(12) << std::fixed << std::setprecision(1) 
+            << (seconds * 1e9 / ops) << " ns/op" << std::endl;
+    }
+    
+    inline void skipped(const string& name, uint64 n) {
+        std::cout << "  " << std::left << std::setw(36) << name 
+            << " n = " << std::setw(10) << n << std::right << std::setw(18) << "skipped" << std::endl;
+    }
+    
+}
+
+#endif
@@ -0,0 +1,84 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <data/tools.hpp>
+#include <data/tools/allocation.hpp>
+#include <milewski/OrdList/OrdList.hpp>
+#include "bench.hpp"
+
+namespace data::bench {
+    
+    // push n elements onto a stack and pop them all again. 
+    template <typename alloc>
+    void push_pop(const string& name, uint64 n) {
+        tool::linked_stack<uint64, alloc> s{};
+        row(name + " push", n, n, seconds([&]() {
+            for (uint64 i = 0; i < n; i++) s = s << i;
+        }));
+        
+        uint64 sum = 0;
+        row(name + " pop", n, n, seconds([&]() {
+            while (!s.empty()) {
+                sum += s.first();
+                s = s.rest();
+            }
+        }));
+        
+        if (sum != n * (n - 1) / 2) std::cout << "  wrong result" << std::endl;
+    }
+    
+    template <typename alloc>
+    void tree_insert(const string& name, uint64 n) {
+        milewski::okasaki::RBMap<uint64, uint64, alloc> m{};
+        row(name + " RBMap insert", n, n, seconds([&]() {
+            for (uint64 i = 0; i < n; i++) m = m.inserted((i * 2654435761u) % n, i);
+        }));
+        
+        row(name + " RBMap remove", n, n, seconds([&]() {
+            for (uint64 i = 0; i < n; i++) m = m.removed((i * 2654435761u) % n);
+        }));
+    }
+    
+    template <typename alloc>
+    void ordered_insert(const string& name, uint64 n) {
+        milewski::okasaki::OrdList<uint64, alloc> o{};
+        row(name + " OrdList insert", n, n, seconds([&]() {
+            for (uint64 i = 0; i < n; i++) o = o.inserted(n - i);
+        }));
+    }
+    
+    void run(uint32 max) {
+        header("linked_stack push and pop of n elements");
+        for (uint32 e = 4; e <= max; e++) {
+            uint64 n = power_of_ten(e);
+            push_pop<tool::allocation::shared>("shared", n);
+            push_pop<tool::allocation::pooled>("pooled", n);
+            push_pop<tool::allocation::local>("local", n);
+        }
+        
+        header("insert and remove n keys");
+        for (uint32 e = 4; e <= max - 1; e++) {
+            uint64 n = power_of_ten(e);
+            tree_insert<tool::allocation::shared>("shared", n);
+            tree_insert<tool::allocation::pooled>("pooled", n);
+            tree_insert<tool::allocation::local>("local", n);
+        }
+        
+        // OrdList is destroyed recursively, so it is kept small. 
+        header("insert n descending keys into an ordered list");
+        for (uint32 e = 4; e <= max - 2; e++) {
+            uint64 n = power_of_ten(e);
+            ordered_insert<tool::allocation::shared>("shared", n);
+            ordered_insert<tool::allocation::pooled>("pooled", n);
+            ordered_insert<tool::allocation::local>("local", n);
+        }
+    }
+    
+}
+
+int main(int argc, char** argv) {
+    using namespace data::bench;
+    run(max_exponent(argc, argv, 7));
+    return 0;
+}
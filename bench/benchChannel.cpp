@@ -0,0 +1,164 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <data/tools/channel.hpp>
+#include <data/tools/bounded_channel.hpp>
+#include <data/tools/spsc_channel.hpp>
+#include <data/tools/select.hpp>
+#include "bench.hpp"
+#include <iterator>
+#include <thread>
+#include <vector>
+
+namespace data::bench {
+
+    // n messages from p producers to p consumers.
+    template <typename chan>
+    double throughput(chan c, uint32 p, uint64 n) {
+        return seconds([&]() {
+            std::vector<std::thread> threads{};
+            for (uint32 i = 0; i < p; i++) threads.emplace_back([c, i, p, n]() mutable {
+                for (uint64 x = i; x < n; x += p) c.put(x);
+            });
+
+            std::vector<std::thread> consumers{};
+            for (uint32 i = 0; i < p; i++) consumers.emplace_back([c]() mutable {
+                uint64 x;
+                while (c.get(x)) {}
+            });
+
+            for (auto& t : threads) t.join();
+            c.close();
+            for (auto& t : consumers) t.join();
+        });
+    }
+
+    // the same, with put_n and get_n in batches of b.
+    template <typename chan>
+    double throughput(chan c, uint32 p, uint64 n, uint32 b) {
+        return seconds([&]() {
+            std::vector<std::thread> threads{};
+            for (uint32 i = 0; i < p; i++) threads.emplace_back([c, i, p, n, b]() mutable {
+                std::vector<uint64> batch{};
+                for (uint64 x = i; x < n; x += p) {
+                    batch.push_back(x);
+                    if (batch.size() == b) {
+                        c.put_n(batch.begin(), batch.end());
+                        batch.clear();
+                    }
+                }
+                c.put_n(batch.begin(), batch.end());
+            });
+
+            std::vector<std::thread> consumers{};
+            for (uint32 i = 0; i < p; i++) consumers.emplace_back([c, b]() mutable {
+                std::vector<uint64> batch(b);
+                while (c.get_n(batch.begin(), b) != 0) {}
+            });
+
+            for (auto& t : threads) t.join();
+            c.close();
+            for (auto& t : consumers) t.join();
+        });
+    }
+
+    // n round trips between two threads.
+    template <typename chan>
+    double round_trip(chan there, chan back, uint64 n) {
+        return seconds([&]() {
+            std::thread echo{[there, back]() mutable {
+                uint64 x;
+                while (there.get(x)) back.put(x);
+            }};
+
+            uint64 x = 0;
+            for (uint64 i = 0; i < n; i++) {
+                there.put(i);
+                back.get(x);
+            }
+
+            there.close();
+            echo.join();
+        });
+    }
+
+    // n messages from each of four producers, got by one thread with select.
+    template <typename chan>
+    double selected(chan a, chan b, chan c, chan d, uint64 n) {
+        return seconds([&]() {
+            std::vector<std::thread> threads{};
+            for (chan x : {a, b, c, d}) threads.emplace_back([x, n]() mutable {
+                for (uint64 i = 0; i < n; i++) x.put(i);
+                x.close();
+            });
+
+            uint64 sum = 0;
+            auto add = [&sum](uint64 x) {
+                sum += x;
+            };
+            auto on_a = tool::on(a.From, add);
+            auto on_b = tool::on(b.From, add);
+            auto on_c = tool::on(c.From, add);
+            auto on_d = tool::on(d.From, add);
+            while (tool::select(on_a, on_b, on_c, on_d) >= 0) {}
+
+            for (auto& t : threads) t.join();
+        });
+    }
+
+    void run(uint32 max) {
+        header("passing n messages with a capacity of 1024");
+        for (uint32 e = 4; e <= max; e++) {
+            uint64 n = power_of_ten(e);
+            for (uint32 p : {1, 2, 4, 8}) {
+                string threads = " " + std::to_string(p) + "x" + std::to_string(p);
+                row("channel" + threads, n, n, throughput(tool::channel<uint64>{1024}, p, n));
+                row("bounded_channel" + threads, n, n, throughput(tool::bounded_channel<uint64>{1024}, p, n));
+            }
+            row("spsc_channel 1x1", n, n, throughput(tool::spsc_channel<uint64>{1024}, 1, n));
+        }
+
+        header("passing n messages in batches with a capacity of 1024");
+        for (uint32 e = 5; e <= max; e++) {
+            uint64 n = power_of_ten(e);
+            for (uint32 p : {1, 4})
+                for (uint32 b : {64, 1024}) {
+                    string threads = " " + std::to_string(p) + "x" + std::to_string(p) + " by " + std::to_string(b);
+                    row("channel" + threads, n, n, throughput(tool::channel<uint64>{1024}, p, n, b));
+                    row("bounded_channel" + threads, n, n, throughput(tool::bounded_channel<uint64>{1024}, p, n, b));
+                }
+            for (uint32 b : {64, 1024})
+                row("spsc_channel 1x1 by " + std::to_string(b), n, n, throughput(tool::spsc_channel<uint64>{1024}, 1, n, b));
+        }
+
+        header("latency of one hop, as half of n round trips");
+        for (uint32 e = 3; e + 1 <= max; e++) {
+            uint64 n = power_of_ten(e);
+            row("channel", n, 2 * n, round_trip(tool::channel<uint64>{1}, tool::channel<uint64>{1}, n));
+            row("bounded_channel", n, 2 * n, round_trip(tool::bounded_channel<uint64>{2}, tool::bounded_channel<uint64>{2}, n));
+            row("spsc_channel", n, 2 * n, round_trip(tool::spsc_channel<uint64>{2}, tool::spsc_channel<uint64>{2}, n));
+        }
+
+        header("selecting from four channels with a capacity of 1024");
+        for (uint32 e = 4; e + 1 <= max; e++) {
+            uint64 n = power_of_ten(e);
+            using tool::channel;
+            using tool::bounded_channel;
+            using tool::spsc_channel;
+            row("channel", n, 4 * n, selected(channel<uint64>{1024}, channel<uint64>{1024},
+                channel<uint64>{1024}, channel<uint64>{1024}, n));
+            row("bounded_channel", n, 4 * n, selected(bounded_channel<uint64>{1024}, bounded_channel<uint64>{1024},
+                bounded_channel<uint64>{1024}, bounded_channel<uint64>{1024}, n));
+            row("spsc_channel", n, 4 * n, selected(spsc_channel<uint64>{1024}, spsc_channel<uint64>{1024},
+                spsc_channel<uint64>{1024}, spsc_channel<uint64>{1024}, n));
+        }
+    }
+
+}
+
+int main(int argc, char** argv) {
+    using namespace data::bench;
+    run(max_exponent(argc, argv, 6));
+    return 0;
+}
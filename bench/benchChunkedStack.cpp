@@ -0,0 +1,47 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <data/tools/linked_stack.hpp>
+#include <data/tools/chunked_stack.hpp>
+#include "bench.hpp"
+
+namespace data::bench {
+    
+    template <typename stack>
+    void run_case(const string& name, uint64 n) {
+        stack s{};
+        row(name + " push", n, n, seconds([&]() {
+            for (uint64 i = 0; i < n; i++) s = s << i;
+        }));
+        
+        uint64 sum = 0;
+        uint64 scans = 10000000 / n + 1;
+        row(name + " scan", n, n * scans, seconds([&]() {
+            for (uint64 j = 0; j < scans; j++) for (uint64 x : s) sum += x;
+        }));
+        
+        row(name + " pop", n, n, seconds([&]() {
+            while (!s.empty()) s = s.rest();
+        }));
+        
+        if (sum != scans * (n * (n - 1) / 2)) std::cout << "  wrong result" << std::endl;
+    }
+    
+    void run(uint32 max) {
+        header("stack of n uint64");
+        for (uint32 e = 3; e <= max; e++) {
+            uint64 n = power_of_ten(e);
+            run_case<tool::linked_stack<uint64>>("linked_stack", n);
+            run_case<tool::chunked_stack<uint64, 16>>("chunked_stack<16>", n);
+            run_case<tool::chunked_stack<uint64, 64>>("chunked_stack<64>", n);
+        }
+    }
+    
+}
+
+int main(int argc, char** argv) {
+    using namespace data::bench;
+    run(max_exponent(argc, argv, 7));
+    return 0;
+}
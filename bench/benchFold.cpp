@@ -0,0 +1,54 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <data/tools.hpp>
+#include <data/parallel.hpp>
+#include "bench.hpp"
+#include <numeric>
+#include <vector>
+
+namespace data::bench {
+
+    void run(uint32 max) {
+        header("folding n elements");
+        auto sum = [](uint64 a, uint64 b) -> uint64 {
+            return a + b;
+        };
+
+        for (uint32 e = 3; e <= max; e++) {
+            uint64 n = power_of_ten(e);
+            uint64 total = 0;
+
+            stack<uint64> s{};
+            for (uint64 i = 0; i < n; i++) s = s << i;
+            row("stack fold", n, n, seconds([&]() {
+                total += fold(sum, uint64{0}, s);
+            }));
+
+            row("stack reduce", n, n, seconds([&]() {
+                total += reduce<uint64>(sum, s);
+            }));
+
+            cross<uint64> c(n);
+            std::iota(c.begin(), c.end(), 0);
+            for (uint32 threads : {1, 2, 4}) row("cross parallel_reduce " + std::to_string(threads), n, n, seconds([&]() {
+                total += parallel_reduce(plus<uint64>{}, c, threads);
+            }));
+
+            tool::linked_tree<uint64> t = tool::linked_tree<uint64>::balanced(c.begin(), c.end());
+            for (uint32 threads : {1, 2, 4}) row("tree parallel_reduce " + std::to_string(threads), n, n, seconds([&]() {
+                total += parallel_reduce(plus<uint64>{}, t, threads);
+            }));
+
+            keep(total);
+        }
+    }
+
+}
+
+int main(int argc, char** argv) {
+    using namespace data::bench;
+    run(max_exponent(argc, argv, 7));
+    return 0;
+}
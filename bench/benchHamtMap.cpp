@@ -0,0 +1,84 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <data/tools.hpp>
+#include "bench.hpp"
+#include <array>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace data::bench {
+
+    // stands in for a 32 byte digest, which is compared with memcmp.
+    using key32 = std::array<byte, 32>;
+
+    struct key32_hash {
+        size_t operator()(const key32& k) const {
+            size_t h;
+            std::memcpy(&h, k.data(), sizeof(h));
+            return h;
+        }
+    };
+
+    template <typename key, typename hash>
+    void run_case(const string& name, const std::vector<key>& keys) {
+        uint64 n = keys.size();
+        uint64 sum = 0;
+
+        tool::hamt_map<key, uint64, hash> h{};
+        row(name + " hamt insert", n, n, seconds([&]() {
+            for (uint64 i = 0; i < n; i++) h = h.insert(keys[i], i);
+        }));
+
+        row(name + " hamt transient insert", n, n, seconds([&]() {
+            typename tool::hamt_map<key, uint64, hash>::transient t{};
+            for (uint64 i = 0; i < n; i++) t.insert(keys[i], i);
+            sum += t.size();
+        }));
+
+        row(name + " hamt lookup", n, n, seconds([&]() {
+            for (const key& k : keys) sum += h[k];
+        }));
+
+        if (n <= 1000000) {
+            tool::rb_map<key, uint64> r{};
+            row(name + " rb_map insert", n, n, seconds([&]() {
+                for (uint64 i = 0; i < n; i++) r = r.insert(keys[i], i);
+            }));
+
+            row(name + " rb_map lookup", n, n, seconds([&]() {
+                for (const key& k : keys) sum += r[k];
+            }));
+        } else {
+            skipped(name + " rb_map insert", n);
+            skipped(name + " rb_map lookup", n);
+        }
+
+        keep(sum);
+    }
+
+    void run(uint32 max) {
+        header("maps of n random keys");
+        std::mt19937_64 random{1};
+        for (uint32 e = 3; e <= max; e++) {
+            uint64 n = power_of_ten(e);
+
+            std::vector<uint64> ints(n);
+            for (uint64& x : ints) x = random();
+            run_case<uint64, std::hash<uint64>>("uint64", ints);
+
+            std::vector<key32> digests(n);
+            for (key32& k : digests) for (byte& b : k) b = static_cast<byte>(random());
+            run_case<key32, key32_hash>("digest", digests);
+        }
+    }
+
+}
+
+int main(int argc, char** argv) {
+    using namespace data::bench;
+    run(max_exponent(argc, argv, 6));
+    return 0;
+}
@@ -0,0 +1,82 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <vector>
+#include <data/tools/linked_stack.hpp>
+#include <data/tools/indexed_list.hpp>
+#include "bench.hpp"
+
+namespace data::bench {
+    
+    using seq = tool::indexed_list<uint64>;
+    using stack = tool::linked_stack<uint64>;
+    
+    void run(uint32 max, uint32 max_stack) {
+        header("sequence of n elements");
+        
+        random_engine engine{13};
+        
+        for (uint32 e = 3; e <= max; e++) {
+            uint64 n = power_of_ten(e);
+            std::vector<uint64> v(n);
+            for (uint64 i = 0; i < n; i++) v[i] = i;
+            std::uniform_int_distribution<uint64> index{0, n - 1};
+            
+            seq s{};
+            row("indexed_list from", n, n, seconds([&]() {
+                s = seq::from(v.begin(), v.end());
+            }));
+            
+            uint64 sum = 0;
+            row("indexed_list iterate", n, n, seconds([&]() {
+                for (uint64 x : s) sum += x;
+            }));
+            
+            uint64 ops = 10000;
+            row("indexed_list []", n, ops, seconds([&]() {
+                for (uint64 i = 0; i < ops; i++) sum += s[index(engine)];
+            }));
+            
+            seq t{};
+            row("indexed_list update", n, ops, seconds([&]() {
+                for (uint64 i = 0; i < ops; i++) t = s.update(index(engine), i);
+            }));
+            
+            row("indexed_list split and concat", n, ops, seconds([&]() {
+                for (uint64 i = 0; i < ops; i++) {
+                    auto p = s.split(index(engine));
+                    t = p.second << p.first;
+                }
+            }));
+            
+            if (e > max_stack) {
+                skipped("linked_stack [] and from", n);
+                skipped("linked_stack concat", n);
+                continue;
+            }
+            
+            stack l{};
+            for (uint64 i = n; i > 0; i--) l = l << v[i - 1];
+            
+            uint64 stack_ops = 100;
+            row("linked_stack [] and from", n, stack_ops, seconds([&]() {
+                for (uint64 i = 0; i < stack_ops; i++) sum += l[index(engine)] + l.from(index(engine)).size();
+            }));
+            
+            row("linked_stack concat", n, stack_ops, seconds([&]() {
+                for (uint64 i = 0; i < stack_ops; i++) sum += (l ^ l).size();
+            }));
+            
+            keep(sum);
+        }
+    }
+    
+}
+
+int main(int argc, char** argv) {
+    using namespace data::bench;
+    data::uint32 max = max_exponent(argc, argv, 7);
+    run(max, 6);
+    return 0;
+}
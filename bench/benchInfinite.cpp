@@ -0,0 +1,65 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <data/list/infinite.hpp>
+#include "bench.hpp"
+
+namespace data::bench {
+
+    // stands in for a step of a hash chain.
+    uint64 mix(uint64 x, uint32 rounds) {
+        for (uint32 i = 0; i < rounds; i++) {
+            x ^= x >> 33;
+            x *= 0xff51afd7ed558ccdULL;
+            x ^= x >> 33;
+        }
+        return x;
+    }
+
+    void run(uint32 max) {
+        header("walking n elements of an infinite list");
+        auto next = [](uint64 x) -> uint64 {
+            return mix(x, 200);
+        };
+
+        using chain = infinite<uint64, decltype(next)>;
+
+        for (uint32 e = 2; e <= max; e++) {
+            uint64 n = power_of_ten(e);
+            uint64 total = 0;
+
+            chain c{next, 1};
+            row("first walk", n, n, seconds([&]() {
+                chain x = c;
+                for (uint64 i = 0; i < n; i++) x = x.rest();
+                total += x.first();
+            }));
+
+            row("second walk", n, n, seconds([&]() {
+                chain x = c;
+                for (uint64 i = 0; i < n; i++) x = x.rest();
+                total += x.first();
+            }));
+
+            // the reader does as much work as the generator, so
+            // with two cores the prefetcher hides the generator.
+            for (size_t k : {0, 64}) row("walk with work, prefetch " + std::to_string(k), n, n, seconds([&]() {
+                chain x = chain{next, 2}.prefetch(k);
+                for (uint64 i = 0; i < n; i++) {
+                    total += mix(x.first(), 200);
+                    x = x.rest();
+                }
+            }));
+
+            keep(total);
+        }
+    }
+
+}
+
+int main(int argc, char** argv) {
+    using namespace data::bench;
+    run(max_exponent(argc, argv, 6));
+    return 0;
+}
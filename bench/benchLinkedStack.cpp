@@ -0,0 +1,87 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <pthread.h>
+#include <data/tools/linked_stack.hpp>
+#include "bench.hpp"
+
+namespace data::bench {
+    
+    using stack = tool::linked_stack<uint64>;
+    
+    // every case is run on a thread with a small stack so 
+    // that anything which recurses once per element crashes
+    // instead of reporting a time. 
+    constexpr size_t stack_bytes = 256 * 1024;
+    
+    template <typename F>
+    void on_small_stack(F f) {
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        pthread_attr_setstacksize(&attr, stack_bytes);
+        pthread_t thread;
+        pthread_create(&thread, &attr, [](void* p) -> void* {
+            (*static_cast<F*>(p))();
+            return nullptr;
+        }, &f);
+        pthread_join(thread, nullptr);
+        pthread_attr_destroy(&attr);
+    }
+    
+    void run(uint32 max) {
+        header("linked_stack of n elements, run with a 256 KiB stack");
+        
+        for (uint32 e = 3; e <= max; e++) {
+            uint64 n = power_of_ten(e);
+            on_small_stack([n]() {
+                stack a{};
+                stack b{};
+                row("prepend", n, n, seconds([&]() {
+                    for (uint64 i = 0; i < n; i++) a = a << i;
+                }));
+                
+                for (uint64 i = 0; i < n; i++) b = b << i;
+                
+                bool result = true;
+                row("valid", n, n, seconds([&]() {
+                    result = result && a.valid();
+                }));
+                
+                row("contains (missing)", n, n, seconds([&]() {
+                    result = result && !a.contains(n);
+                }));
+                
+                row("== (no shared nodes)", n, n, seconds([&]() {
+                    result = result && a == b;
+                }));
+                
+                row("from(n - 1)", n, n, seconds([&]() {
+                    result = result && a.from(n - 1).first() == 0;
+                }));
+                
+                uint64 sum = 0;
+                row("range-for", n, n, seconds([&]() {
+                    for (uint64 x : a) sum += x;
+                }));
+                
+                row("reverse", n, n, seconds([&]() {
+                    result = result && data::reverse(a).first() == 0;
+                }));
+                
+                row("destroy", n, n, seconds([&]() {
+                    a = stack{};
+                }));
+                
+                if (!result || sum != n * (n - 1) / 2) std::cout << "  wrong result" << std::endl;
+            });
+        }
+    }
+    
+}
+
+int main(int argc, char** argv) {
+    using namespace data::bench;
+    run(max_exponent(argc, argv, 7));
+    return 0;
+}
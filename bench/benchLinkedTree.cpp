@@ -0,0 +1,50 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <data/tools.hpp>
+#include "bench.hpp"
+#include <vector>
+
+namespace data::bench {
+    
+    template <typename traversal>
+    uint64 sum(traversal t) {
+        uint64 s = 0;
+        for (uint64 x : t) s += x;
+        return s;
+    }
+    
+    void run(uint32 max) {
+        header("balanced tree of n elements");
+        for (uint32 e = 3; e <= max; e++) {
+            uint64 n = power_of_ten(e);
+            std::vector<uint64> v(n);
+            for (uint64 i = 0; i < n; i++) v[i] = i;
+            
+            tree<uint64> t{};
+            row("balanced", n, n, seconds([&]() {
+                t = tree<uint64>::balanced(v.begin(), v.end());
+            }));
+            
+            uint64 s = 0;
+            row("pre-order", n, n, seconds([&]() { s += sum(t.pre_order()); }));
+            row("in-order", n, n, seconds([&]() { s += sum(t.in_order()); }));
+            row("post-order", n, n, seconds([&]() { s += sum(t.post_order()); }));
+            row("contains (absent)", n, n, seconds([&]() { s += t.contains(n); }));
+            
+            auto add = [](uint64 x, uint64 l, uint64 r) -> uint64 { return x + l + r; };
+            row("fold", n, n, seconds([&]() { s += t.fold(add, uint64{0}); }));
+            row("parallel fold", n, n, seconds([&]() { s += t.parallel_fold(add, uint64{0}); }));
+            
+            keep(s);
+        }
+    }
+    
+}
+
+int main(int argc, char** argv) {
+    using namespace data::bench;
+    run(max_exponent(argc, argv, 7));
+    return 0;
+}
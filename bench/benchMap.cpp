@@ -0,0 +1,157 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <data/tools.hpp>
+#include "bench.hpp"
+
+namespace data::bench {
+    
+    using rb = milewski::okasaki::RBMap<uint64, uint64>;
+    
+    // the old implementation of rb_map::remove, which rebuilt 
+    // the whole tree without the removed key. 
+    rb remove_by_rebuild(const rb& m, uint64 k) {
+        rb r{};
+        milewski::okasaki::forEach(m, [&r, k](const uint64& key, const uint64& value) -> void {
+            if (key != k) r = r.inserted(key, value);
+        });
+        return r;
+    }
+    
+    rb build(uint64 n, random_engine& engine) {
+        std::vector<uint64> keys(n);
+        for (uint64 i = 0; i < n; i++) keys[i] = i;
+        std::shuffle(keys.begin(), keys.end(), engine);
+        rb m{};
+        for (uint64 k : keys) m = m.inserted(k, k);
+        return m;
+    }
+    
+    void remove(uint32 max, uint32 max_rebuild) {
+        header("remove one key from a map of n keys");
+        
+        random_engine engine{5};
+        
+        for (uint32 e = 3; e <= max; e++) {
+            uint64 n = power_of_ten(e);
+            rb m = build(n, engine);
+            std::uniform_int_distribution<uint64> key{0, n - 1};
+            
+            uint64 removals = 10000;
+            rb result;
+            row("path-copying delete", n, removals, seconds([&]() {
+                for (uint64 i = 0; i < removals; i++) result = m.removed(key(engine));
+            }));
+            
+            if (e > max_rebuild) {
+                skipped("rebuild", n);
+                continue;
+            }
+            
+            uint64 rebuilds = e <= 4 ? 100 : 1;
+            row("rebuild", n, rebuilds, seconds([&]() {
+                for (uint64 i = 0; i < rebuilds; i++) result = remove_by_rebuild(m, key(engine));
+            }));
+        }
+    }
+    
+    void churn(uint32 max) {
+        header("replace the value of an existing key in a map of n keys");
+        
+        random_engine engine{7};
+        
+        for (uint32 e = 3; e <= max; e++) {
+            uint64 n = power_of_ten(e);
+            tool::rb_map<uint64, uint64> m{};
+            for (uint64 i = 0; i < n; i++) m = m.insert(i, i);
+            std::uniform_int_distribution<uint64> key{0, n - 1};
+            
+            uint64 updates = 10000;
+            row("rb_map::insert", n, updates, seconds([&]() {
+                for (uint64 i = 0; i < updates; i++) m = m.insert(key(engine), i + n);
+            }));
+        }
+    }
+    
+    void iterate(uint32 max) {
+        header("iterate over a map of n keys");
+        
+        for (uint32 e = 3; e <= max; e++) {
+            uint64 n = power_of_ten(e);
+            tool::rb_map<uint64, uint64> m{};
+            for (uint64 i = 0; i < n; i++) m = m.insert(i, i);
+            
+            uint64 sum = 0;
+            row("range-for over rb_map", n, n, seconds([&]() {
+                for (const auto& x : m) sum += x.Value;
+            }));
+            
+            uint64 scans = 1000;
+            uint64 width = 100;
+            std::uniform_int_distribution<uint64> key{0, n - width};
+            random_engine engine{11};
+            row("scan of 100 keys", n, scans, seconds([&]() {
+                for (uint64 i = 0; i < scans; i++) {
+                    uint64 k = key(engine);
+                    for (const auto& x : m.scan(k, k + width - 1)) sum += x.Value;
+                }
+            }));
+            
+            keep(sum);
+        }
+    }
+    
+    
+    // merge two snapshots of n keys which differ in one key 
+    // in a hundred, as by sorted build and split / join, 
+    // against n inserts into a copy. 
+    void merge(uint32 max, uint32 max_insert) {
+        header("build, and take the union of two sets of n keys");
+        
+        for (uint32 e = 3; e <= max; e++) {
+            uint64 n = power_of_ten(e);
+            std::vector<uint64> a(n);
+            std::vector<uint64> b(n);
+            for (uint64 i = 0; i < n; i++) {
+                a[i] = 2 * i;
+                b[i] = i % 100 == 0 ? 2 * i + 1 : 2 * i;
+            }
+            
+            set<uint64> x{};
+            set<uint64> y{};
+            row("from_sorted", n, 2 * n, seconds([&]() {
+                x = set<uint64>::from_sorted(a.begin(), a.end());
+                y = set<uint64>::from_sorted(b.begin(), b.end());
+            }));
+            
+            set<uint64> u{};
+            row("split / join union", n, n, seconds([&]() {
+                u = x & y;
+            }));
+            
+            if (e > max_insert) {
+                skipped("insert one at a time", n);
+                continue;
+            }
+            
+            set<uint64> v = x;
+            row("insert one at a time", n, n, seconds([&]() {
+                for (uint64 k : b) v = v.insert(k);
+            }));
+            
+            if (u.size() != v.size()) std::cout << "union sizes differ" << std::endl;
+        }
+    }
+    
+}
+
+int main(int argc, char** argv) {
+    using namespace data::bench;
+    data::uint32 max = max_exponent(argc, argv, 7);
+    remove(max, 6);
+    churn(max);
+    iterate(max);
+    merge(max, 6);
+    return 0;
+}
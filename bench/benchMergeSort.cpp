@@ -0,0 +1,75 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <data/tools.hpp>
+#include <data/iterable.hpp>
+#include "bench.hpp"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace data::bench {
+
+    void run_stack(uint64 n, std::mt19937_64& random) {
+        std::vector<uint64> v(n);
+        for (uint64& x : v) x = random();
+        stack<uint64> s = sorting::stack_from<stack<uint64>>(v.begin(), v.end());
+        uint64 sum = 0;
+
+        row("stack merge_sort random", n, n, seconds([&]() {
+            sum += merge_sort(s).first();
+        }));
+
+        // sorted except for one element in a thousand.
+        std::sort(v.begin(), v.end());
+        for (uint64 i = 0; i < n; i += 1000) v[i] = random();
+        s = sorting::stack_from<stack<uint64>>(v.begin(), v.end());
+
+        row("stack merge_sort nearly sorted", n, n, seconds([&]() {
+            sum += merge_sort(s).first();
+        }));
+
+        row("stack natural_merge_sort nearly sorted", n, n, seconds([&]() {
+            sum += natural_merge_sort(s).first();
+        }));
+
+        keep(sum);
+    }
+
+    void run_contiguous(uint64 n, std::mt19937_64& random) {
+        cross<uint64> c(n);
+        for (uint64& x : c) x = random();
+        uint64 sum = 0;
+
+        row("cross std::stable_sort", n, n, seconds([&]() {
+            cross<uint64> d = c;
+            std::stable_sort(d.begin(), d.end());
+            sum += d[0];
+        }));
+
+        for (uint32 threads : {1, 2, 4, 8}) row("cross parallel_merge_sort " + std::to_string(threads), n, n, seconds([&]() {
+            sum += parallel_merge_sort(c, threads)[0];
+        }));
+
+        keep(sum);
+    }
+
+    void run(uint32 max) {
+        header("sorting n random elements");
+        std::mt19937_64 random{1};
+        for (uint32 e = 3; e <= max; e++) {
+            uint64 n = power_of_ten(e);
+            if (e <= 7) run_stack(n, random);
+            else skipped("stack merge_sort", n);
+            run_contiguous(n, random);
+        }
+    }
+
+}
+
+int main(int argc, char** argv) {
+    using namespace data::bench;
+    run(max_exponent(argc, argv, 7));
+    return 0;
+}
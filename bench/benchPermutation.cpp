@@ -0,0 +1,172 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <data/math/permutation.hpp>
+#include <data/math/algebra/permutation_group.hpp>
+#include "bench.hpp"
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace data::bench {
+    using dense = math::dense_permutation;
+
+    dense random_permutation(size_t n, std::mt19937& random) {
+        std::vector<uint32> v(n);
+        std::iota(v.begin(), v.end(), 0);
+        std::shuffle(v.begin(), v.end(), random);
+        return dense{v};
+    }
+
+    void run(uint32 max) {
+        header("permutations of n points");
+        std::mt19937 random{1};
+
+        for (uint32 e = 3; e <= max; e++) {
+            uint64 n = power_of_ten(e);
+            uint64 total = 0;
+
+            dense p = random_permutation(n, random);
+            dense q = random_permutation(n, random);
+            dense r{};
+
+            // for comparison, copying the same amount of memory. 
+            std::vector<uint32> copy(n);
+            row("copy", n, n, seconds([&]() {
+                std::copy(p.Image.begin(), p.Image.end(), copy.begin());
+            }));
+            total += copy[n / 2];
+
+            row("dense compose", n, n, seconds([&]() {
+                r = p * q;
+            }));
+            total += r(0);
+
+            row("dense inverse", n, n, seconds([&]() {
+                r = p.inverse();
+            }));
+            total += r(0);
+
+            row("dense cycles", n, n, seconds([&]() {
+                total += p.cycles().size();
+            }));
+
+            row("dense signature", n, n, seconds([&]() {
+                total += p.signature();
+            }));
+
+            if (n <= 100000) {
+                math::permutation<uint32> a{p};
+                math::permutation<uint32> b{q};
+                row("cycle form compose", n, n, seconds([&]() {
+                    total += (a * b).Cycles.size();
+                }));
+            } else skipped("cycle form compose", n);
+
+            keep(total);
+        }
+    }
+
+}
+
+namespace data::bench {
+    using group = math::algebra::permutation_group;
+
+    dense cycle(std::vector<uint32> c, size_t n) {
+        return dense::from_cycles({c}, n);
+    }
+
+    // x -> x + 1 and x -> r x on the integers mod p,
+    // where r is a primitive root.
+    group affine(uint32 p) {
+        std::vector<uint32> shift(p);
+        for (uint32 x = 0; x < p; x++) shift[x] = (x + 1) % p;
+        uint32 r = 2;
+        while (true) {
+            uint64 x = r;
+            uint32 k = 1;
+            for (; x != 1; k++) x = x * r % p;
+            if (k == p - 1) break;
+            r++;
+        }
+        std::vector<uint32> scale(p);
+        for (uint32 x = 0; x < p; x++) scale[x] = uint64(x) * r % p;
+        return group{p, {dense{shift}, dense{scale}}};
+    }
+
+    // C_2 wr C_(n/2), in which the base is half as long as the degree.
+    group wreath(uint32 n) {
+        std::vector<uint32> shift(n);
+        for (uint32 x = 0; x < n; x++) shift[x] = (x + 2) % n;
+        return group{n, {cycle({0, 1}, n), dense{shift}}};
+    }
+
+    void run(const string& name, uint32 n, std::function<group()> make) {
+        std::mt19937_64 random{n};
+        group g{};
+        row(name + " build", n, 1, seconds([&]() {
+            g = make();
+        }));
+
+        std::vector<dense> x{};
+        row(name + " random", n, 20, seconds([&]() {
+            for (int i = 0; i < 20; i++) x.push_back(g.random(random));
+        }));
+
+        size_t count = 0;
+        row(name + " contains", n, 20, seconds([&]() {
+            for (const dense& p : x) count += g.contains(p);
+        }));
+
+        if (count != x.size()) std::cout << "  membership test failed" << std::endl;
+    }
+
+    void run_groups() {
+        header("permutation groups of degree n; build is per group, random and contains per element");
+        for (uint32 n : {100, 1000, 5000}) {
+            std::vector<uint32> all(n);
+            std::iota(all.begin(), all.end(), 0);
+            run("symmetric", n, [n, all]() {
+                return group{n, {cycle({0, 1}, n), cycle(all, n)}};
+            });
+
+            run("alternating", n, [n, all]() {
+                return group{n, {cycle({0, 1, 2}, n), cycle(std::vector<uint32>(all.begin() + n % 2 + 1, all.end()), n)}};
+            });
+
+            std::vector<uint32> p{};
+            for (uint32 i = 1; i < n; i++) p.push_back(n - i);
+            run("dihedral", n, [n, all, p]() {
+                return group{n, {cycle(all, n), dense{[&]() {
+                    std::vector<uint32> r{0};
+                    r.insert(r.end(), p.begin(), p.end());
+                    return r;
+                }()}}};
+            });
+
+            uint32 q = n;
+            while (!std::all_of(all.begin() + 2, all.begin() + std::min<uint32>(q, 100), [q](uint32 d) {
+                return d * d > q || q % d != 0;
+            })) q--;
+            run("affine", q, [q]() {
+                return affine(q);
+            });
+
+            if (n <= 1000) run("wreath", n, [n]() {
+                return wreath(n);
+            });
+            else skipped("wreath build", n);
+        }
+    }
+
+}
+
+int main(int argc, char** argv) {
+    using namespace data::bench;
+    run(max_exponent(argc, argv, 7));
+    run_groups();
+    return 0;
+}
@@ -0,0 +1,54 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <data/tools.hpp>
+#include <data/pipeline.hpp>
+#include "bench.hpp"
+
+namespace data::bench {
+
+    void run(uint32 max) {
+        header("map, filter and fold over n elements");
+
+        auto triple = [](uint64 x) -> uint64 {
+            return 3 * x;
+        };
+
+        auto even = [](uint64 x) -> bool {
+            return x % 2 == 0;
+        };
+
+        auto sum = [](uint64 a, uint64 b) -> uint64 {
+            return a + b;
+        };
+
+        for (uint32 e = 3; e <= max; e++) {
+            uint64 n = power_of_ten(e);
+            uint64 total = 0;
+
+            stack<uint64> s{};
+            for (uint64 i = 0; i < n; i++) s = s << i;
+
+            // what for_each does: a new stack for every step.
+            row("stack eager", n, n, seconds([&]() {
+                stack<uint64> m = pipeline::to<stack<uint64>>(pipeline::map(triple, s));
+                stack<uint64> f = pipeline::to<stack<uint64>>(pipeline::filter(even, m));
+                total += fold(sum, uint64{0}, f);
+            }));
+
+            row("stack pipeline", n, n, seconds([&]() {
+                total += pipeline::fold(sum, uint64{0}, pipeline::filter(even, pipeline::map(triple, s)));
+            }));
+
+            keep(total);
+        }
+    }
+
+}
+
+int main(int argc, char** argv) {
+    using namespace data::bench;
+    run(max_exponent(argc, argv, 7));
+    return 0;
+}
@@ -0,0 +1,103 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <data/tools.hpp>
+#include <data/tools/pairing_heap.hpp>
+#include <data/tools/binary_heap.hpp>
+#include "bench.hpp"
+#include <random>
+#include <vector>
+
+namespace data::bench {
+
+    template <typename heap>
+    void run_case(const string& name, const std::vector<uint64>& v) {
+        uint64 n = v.size();
+        uint64 sum = 0;
+
+        heap h{};
+        row(name + " insert", n, n, seconds([&]() {
+            for (uint64 x : v) h = h.insert(x);
+        }));
+
+        row(name + " rest", n, n, seconds([&]() {
+            for (heap p = h; !p.empty(); p = p.rest()) sum += p.first();
+        }));
+
+        heap b{};
+        row(name + " from", n, n, seconds([&]() {
+            b = heap::from(v.begin(), v.end());
+        }));
+
+        row(name + " merge", n, 1, seconds([&]() {
+            sum += h.merge(b).first();
+        }));
+
+        keep(sum);
+    }
+
+    // as a scheduler would use it: pop the next entry and put it
+    // back with a later time.
+    template <typename heap>
+    void run_schedule(const string& name, const std::vector<uint64>& v, uint64 steps) {
+        heap h = heap::from(v.begin(), v.end());
+        row(name + " reschedule", v.size(), steps, seconds([&]() {
+            for (uint64 i = 0; i < steps; i++) {
+                uint64 x = h.first();
+                h = h.rest().insert(x + v[i % v.size()]);
+            }
+        }));
+    }
+
+    void run_binary(const std::vector<uint64>& v, uint64 steps) {
+        uint64 n = v.size();
+        uint64 sum = 0;
+
+        tool::binary_heap<uint64> h{};
+        row("binary insert", n, n, seconds([&]() {
+            for (uint64 x : v) h.insert(x);
+        }));
+
+        row("binary pop", n, n, seconds([&]() {
+            while (!h.empty()) {
+                sum += h.first();
+                h.pop();
+            }
+        }));
+
+        row("binary from", n, n, seconds([&]() {
+            h = tool::binary_heap<uint64>{v.begin(), v.end()};
+        }));
+
+        row("binary reschedule", n, steps, seconds([&]() {
+            for (uint64 i = 0; i < steps; i++)
+                h.update(h.first_handle(), h.first() + v[i % n]);
+        }));
+
+        keep(sum);
+    }
+
+    void run(uint32 max) {
+        header("priority queue of n random elements");
+        std::mt19937_64 random{1};
+        for (uint32 e = 3; e <= max; e++) {
+            uint64 n = power_of_ten(e);
+            std::vector<uint64> v(n);
+            for (uint64& x : v) x = random() % (n * 10);
+            run_case<tool::leftist_heap<uint64>>("leftist", v);
+            run_case<tool::pairing_heap<uint64>>("pairing", v);
+            run_case<tool::pairing_heap<uint64, tool::allocation::pooled>>("pairing pooled", v);
+            run_schedule<tool::leftist_heap<uint64>>("leftist", v, 100000);
+            run_schedule<tool::pairing_heap<uint64>>("pairing", v, 100000);
+            run_binary(v, 100000);
+        }
+    }
+
+}
+
+int main(int argc, char** argv) {
+    using namespace data::bench;
+    run(max_exponent(argc, argv, 6));
+    return 0;
+}
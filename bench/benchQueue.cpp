@@ -0,0 +1,50 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <data/tools.hpp>
+#include <data/tools/real_time_queue.hpp>
+#include "bench.hpp"
+
+namespace data::bench {
+    
+    // the worst case for the two-stack queue: a version whose 
+    // front has one element and whose rear has n - 1. Each 
+    // call to rest on it reverses the rear again. 
+    template <typename queue>
+    void run_case(const string& name, uint64 n, uint64 repeats) {
+        queue q{};
+        row(name + " append", n, n, seconds([&]() {
+            for (uint64 i = 0; i < n; i++) q = q << i;
+        }));
+        
+        uint64 sum = 0;
+        row(name + " iterate", n, n, seconds([&]() {
+            for (uint64 x : q) sum += x;
+        }));
+        
+        queue r{};
+        for (uint64 i = 0; i < n; i++) r = r << i;
+        row(name + " old rest", n, repeats, seconds([&]() {
+            for (uint64 i = 0; i < repeats; i++) sum += r.rest().first();
+        }));
+        
+        keep(sum);
+    }
+    
+    void run(uint32 max) {
+        header("queue of n elements");
+        for (uint32 e = 3; e <= max; e++) {
+            uint64 n = power_of_ten(e);
+            run_case<list<uint64>>("functional", n, e <= 5 ? 1000 : 10);
+            run_case<tool::real_time_queue<uint64>>("real time", n, 1000);
+        }
+    }
+    
+}
+
+int main(int argc, char** argv) {
+    using namespace data::bench;
+    run(max_exponent(argc, argv, 6));
+    return 0;
+}
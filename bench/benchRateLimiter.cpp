@@ -0,0 +1,79 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <data/tools/token_bucket.hpp>
+#include <data/tools/keyed_limiter.hpp>
+#include <data/tools/rate_limiter.h>
+#include "bench.hpp"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace data::bench {
+    using namespace std::chrono_literals;
+
+    // call f(thread, i) n times in total, divided between threads.
+    template <typename F>
+    double contended(uint32 threads, uint64 n, F f) {
+        return seconds([&]() {
+            std::vector<std::thread> v{};
+            for (uint32 t = 0; t < threads; t++) v.emplace_back([&f, t, threads, n]() {
+                for (uint64 i = t; i < n; i += threads) f(t, i);
+            });
+            for (auto &x : v) x.join();
+        });
+    }
+
+    // every limiter allows so much that no call ever waits, so
+    // this measures only what it costs to ask.
+    void run(uint32 max) {
+        std::atomic<uint64> total{0};
+
+        header("acquire() n times, divided between threads");
+        for (uint32 e = 4; e <= max; e++) {
+            uint64 n = power_of_ten(e);
+            for (uint32 threads : {1, 2, 4, 8}) {
+                tool::token_bucket b{1000000000, 1s, n};
+                row("token_bucket " + std::to_string(threads), n, n, contended(threads, n, [&b](uint32, uint64) {
+                    b.acquire();
+                }));
+
+                tools::rate_limiter r{int(n), 1};
+                row("rate_limiter " + std::to_string(threads), n, n, contended(threads, n, [&r, &total](uint32, uint64) {
+                    total += r.getTime();
+                }));
+            }
+        }
+
+        header("try_acquire(key) n times, divided between threads");
+        for (uint32 e = 4; e <= max; e++) {
+            uint64 n = power_of_ten(e);
+            for (uint32 threads : {1, 2, 4, 8}) {
+                tool::keyed_limiter<uint32> one{1000000000, 1s, n};
+                row("keyed_limiter one key " + std::to_string(threads), n, n, contended(threads, n, [&one, &total](uint32, uint64) {
+                    total += one.try_acquire(0);
+                }));
+
+                tool::keyed_limiter<uint32> own{1000000000, 1s, n};
+                row("keyed_limiter key per thread " + std::to_string(threads), n, n, contended(threads, n, [&own, &total](uint32 t, uint64) {
+                    total += own.try_acquire(t);
+                }));
+
+                tool::keyed_limiter<uint64> many{1000000000, 1s, n};
+                row("keyed_limiter 1000 keys " + std::to_string(threads), n, n, contended(threads, n, [&many, &total](uint32, uint64 i) {
+                    total += many.try_acquire(i % 1000);
+                }));
+            }
+        }
+
+        keep(total);
+    }
+
+}
+
+int main(int argc, char** argv) {
+    using namespace data::bench;
+    run(max_exponent(argc, argv, 6));
+    return 0;
+}
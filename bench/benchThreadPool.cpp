@@ -0,0 +1,101 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <data/tools/thread_pool.hpp>
+#include "bench.hpp"
+#include <atomic>
+#include <future>
+#include <vector>
+
+namespace data::bench {
+
+    // a task for every call, as in fib in the tests.
+    uint64 fib(tool::thread_pool &p, uint32 n) {
+        if (n < 2) return n;
+        auto a = p.spawn([&p, n]() {
+            return fib(p, n - 1);
+        });
+        uint64 b = fib(p, n - 2);
+        return a.get() + b;
+    }
+
+    uint64 fib(uint32 n) {
+        return n < 2 ? n : fib(n - 1) + fib(n - 2);
+    }
+
+    // how many calls fib(n) makes.
+    uint64 calls(uint32 n) {
+        return 2 * fib(n + 1) - 1;
+    }
+
+    void run(uint32 max) {
+        uint64 total = 0;
+
+        header("spawning n empty tasks from outside the pool and waiting for them");
+        for (uint32 e = 3; e <= max; e++) {
+            uint64 n = power_of_ten(e);
+            for (uint32 threads : {1, 2, 4, 8}) {
+                tool::thread_pool p{threads};
+                row("thread_pool " + std::to_string(threads), n, n, seconds([&]() {
+                    std::vector<tool::future<void>> v{};
+                    v.reserve(n);
+                    for (uint64 i = 0; i < n; i++) v.push_back(p.spawn([]() {}));
+                    for (auto &f : v) f.get();
+                }));
+            }
+
+            if (e > 4) skipped("std::async", n);
+            else row("std::async", n, n, seconds([&]() {
+                std::vector<std::future<void>> v{};
+                v.reserve(n);
+                for (uint64 i = 0; i < n; i++) v.push_back(std::async(std::launch::async, []() {}));
+                for (auto &f : v) f.get();
+            }));
+        }
+
+        header("fib(n) with a task for every call");
+        for (uint32 n = 10; n <= 5 * max - 5; n += 5) {
+            row("sequential", n, calls(n), seconds([&]() {
+                total += fib(n);
+            }));
+            for (uint32 threads : {1, 2, 4, 8}) {
+                tool::thread_pool p{threads};
+                row("thread_pool " + std::to_string(threads), n, calls(n), seconds([&]() {
+                    total += p.spawn([&p, n]() {
+                        return fib(p, n);
+                    }).get();
+                }));
+            }
+        }
+
+        header("parallel_for over n indices that each do almost nothing");
+        for (uint32 e = 4; e <= max + 1; e++) {
+            uint64 n = power_of_ten(e);
+            std::vector<uint64> v(n);
+            for (uint32 threads : {1, 4})
+                for (size_t grain : {0, 64, 1}) {
+                    if (grain == 1 && e > max) {
+                        skipped("thread_pool " + std::to_string(threads) + " grain 1", n);
+                        continue;
+                    }
+                    tool::thread_pool p{threads};
+                    row("thread_pool " + std::to_string(threads) + " grain " + std::to_string(grain), n, n, seconds([&]() {
+                        p.parallel_for(0, n, [&v](size_t i) {
+                            v[i] += i;
+                        }, grain);
+                    }));
+                }
+            total += v[n - 1];
+        }
+
+        keep(total);
+    }
+
+}
+
+int main(int argc, char** argv) {
+    using namespace data::bench;
+    run(max_exponent(argc, argv, 6));
+    return 0;
+}
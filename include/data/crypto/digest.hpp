@@ -6,6 +6,9 @@
 #define DATA_CRYPTO_DIGEST
 #include "data/types.hpp"
 #include <data/math/number/bounded/bounded.hpp>
+#include <algorithm>
+#include <cstring>
+#include <functional>
 
 namespace data::crypto {
     
@@ -16,7 +19,7 @@ namespace data::crypto {
         using uint<s>::uint;
         
         digest() : uint<s>() {}
-        digest(const digest& d) : uint<s>{static_cast<uint<s>&>(d)} {}
+        digest(const digest& d) : uint<s>{static_cast<const uint<s>&>(d)} {}
         
         digest(bytes_view b) : uint<s>{0} {
             if (b.size() == s) std::copy(b.begin(), b.end(), uint<s>::begin());
@@ -25,6 +28,14 @@ namespace data::crypto {
         bool valid() const;
         
         digest& operator=(const digest&);
+        
+        bool operator==(const digest& d) const {
+            return std::equal(uint<s>::begin(), uint<s>::end(), d.begin());
+        }
+        
+        bool operator!=(const digest& d) const {
+            return !operator==(d);
+        }
     };
     
     template<size_t s>
@@ -40,5 +51,20 @@ namespace data::crypto {
     
 }
 
+namespace std {
+    
+    // a digest is already uniformly distributed, so its first 
+    // bytes will do as a hash. 
+    template <size_t s>
+    struct hash<data::crypto::digest<s>> {
+        size_t operator()(const data::crypto::digest<s>& d) const noexcept {
+            size_t h = 0;
+            std::memcpy(&h, d.data(), s < sizeof(size_t) ? s : sizeof(size_t));
+            return h;
+        }
+    };
+    
+}
+
 #endif
 
@@ -5,6 +5,7 @@
 #ifndef DATA_FUNCTION
 #define DATA_FUNCTION
 
+#include <optional>
 #include <data/types.hpp>
 
 namespace data::meta {
@@ -70,6 +71,31 @@ namespace data {
             return Function(Value, x);
         }
     };
+    
+    // holds a function so that it can be assigned even if it is a 
+    // lambda, which cannot be. A sequence that holds a function 
+    // can then be stepped through with x = x.rest(). 
+    template <typename F> 
+    class assignable {
+        mutable std::optional<F> Function;
+        
+    public:
+        assignable(const F& f) : Function{f} {}
+        assignable(const assignable& a) : Function{a.Function} {}
+        
+        assignable& operator=(const assignable& a) {
+            if (this != &a) {
+                Function.reset();
+                Function.emplace(*a.Function);
+            }
+            return *this;
+        }
+        
+        template <typename ... X>
+        decltype(auto) operator()(X&& ... x) const {
+            return (*Function)(std::forward<X>(x)...);
+        }
+    };
 
 }
 
@@ -34,7 +34,9 @@ namespace data::functional {
         bool contains(X x) const;
     };
     
-    // an iterator that could go with a list. 
+    // an iterator that could go with a list. It holds a 
+    // plain pointer to the current node so that stepping 
+    // through a list does not touch any reference counts. 
     template <typename list, typename element> 
     class stack_iterator {
         list Next;
@@ -117,7 +119,7 @@ namespace data::functional {
     inline bool stack_node<X, Y>::contains(X x) const {
         if (x == First) return true;
         
-        return contains(Rest, x);
+        return Rest.contains(x);
     }
     
     // an iterator that could go with a list. 
@@ -132,7 +134,7 @@ namespace data::functional {
     inline stack_iterator<L, element>& stack_iterator<L, element>::operator++() { // Prefix
         if (Next == nullptr) return *this;
         if (Next->Size == 1) return operator=(stack_iterator{Index + 1});
-        return operator=(stack_iterator{Next->Rest.Next, Index + 1});
+        return operator=(stack_iterator{Next->Rest.Next.get(), Index + 1});
     }
     
     template <typename L, typename element> 
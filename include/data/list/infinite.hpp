@@ -1,32 +1,179 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
 #ifndef DATA_LIST_INFINITE_HPP
 #define DATA_LIST_INFINITE_HPP
 
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <data/list.hpp>
-#include <data/data.hpp>
-#include <data/fold.hpp>
+#include <data/function.hpp>
+#include <data/tools/once.hpp>
 #include <type_traits>
-    
+
 namespace data {
-        
+
+    // the infinite list x, f(x), f(f(x)), ... Each element is computed
+    // the first time it is asked for and then kept, and copies of the
+    // list share the elements that have been computed, so walking the
+    // same list twice calls f only once per element. Computing an
+    // element is thread safe.
+    //
+    // prefetch(k) gives the same list with a thread that keeps the
+    // next k elements computed ahead of wherever it is read.
     template <typename X, typename f>
-    struct infinite {
-        constexpr static list::definition::list<infinite<X, f>, X> is_list{};
-        
-        f Function;
-        X First;
-            
+    class infinite {
+        struct cell;
+        struct prefetcher;
+
+        using generator = assignable<f>;
+
+        ptr<const cell> Cell;
+        ptr<prefetcher> Prefetch;
+
+        infinite(ptr<const cell> c, ptr<prefetcher> p) : Cell{c}, Prefetch{p} {}
+
+    public:
+        infinite(f fun, const X& first) :
+            Cell{std::make_shared<const cell>(first, 0, std::make_shared<const generator>(fun))}, Prefetch{} {}
+
         bool empty() const {
             return false;
         }
 
         const X& first() const {
-            return First;
+            return Cell->Value;
+        }
+
+        infinite rest() const {
+            const ptr<const cell>& next = Cell->next();
+            if (Prefetch != nullptr) Prefetch->request(next);
+            return infinite{next, Prefetch};
+        }
+
+        infinite prefetch(size_t k) const {
+            if (k == 0) return infinite{Cell, nullptr};
+            auto p = std::make_shared<prefetcher>(k);
+            p->request(Cell);
+            return infinite{Cell, p};
+        }
+    };
+
+    template <typename X, typename f>
+    struct infinite<X, f>::cell {
+        X Value;
+        size_t Index;
+        ptr<const generator> Function;
+
+        mutable tool::once Once;
+        mutable ptr<const cell> Next;
+
+        cell(const X& x, size_t i, ptr<const generator> fun) :
+            Value{x}, Index{i}, Function{fun}, Once{}, Next{} {}
+
+        const ptr<const cell>& next() const {
+            Once([this]() {
+                Next = std::make_shared<const cell>((*Function)(Value), Index + 1, Function);
+            });
+            return Next;
         }
-            
-        const infinite rest() const {
-            return infinite{Function, Function(First)};
+
+        bool evaluated() const {
+            return Once.finished();
+        }
+
+        // a long list that nothing else refers to is taken
+        // apart one cell at a time rather than recursively.
+        ~cell() {
+            ptr<const cell> n = std::move(Next);
+            while (n != nullptr && n.use_count() == 1) {
+                ptr<const cell> m = std::move(n->Next);
+                n = std::move(m);
+            }
+        }
+    };
+
+    // Whenever the list is read, the prefetcher is told of the cell that
+    // was reached, and it evaluates the cells after it until it is k
+    // ahead. It is only woken when it is less than k / 2 ahead, so
+    // most reads do not touch the mutex. If f throws, the
+    // prefetcher stops, and a thread that reads that element either
+    // gets the same exception, if it was waiting for the prefetcher,
+    // or calls f again.
+    template <typename X, typename f>
+    struct infinite<X, f>::prefetcher {
+        size_t Ahead;
+
+        // the index of the last cell that the worker has evaluated.
+        std::atomic<size_t> Reached;
+
+        std::mutex Mutex;
+        std::condition_variable Wake;
+        ptr<const cell> Requested;
+        bool Stop;
+
+        std::thread Worker;
+
+        explicit prefetcher(size_t k) : Ahead{k}, Reached{0}, Mutex{}, Wake{}, Requested{}, Stop{false}, Worker{} {
+            Worker = std::thread{[this]() {
+                run();
+            }};
+        }
+
+        ~prefetcher() {
+            {
+                std::lock_guard<std::mutex> lock{Mutex};
+                Stop = true;
+            }
+            Wake.notify_one();
+            Worker.join();
+        }
+
+        void request(const ptr<const cell>& c) {
+            if (c->Index + Ahead / 2 < Reached.load(std::memory_order_relaxed)) return;
+            {
+                std::lock_guard<std::mutex> lock{Mutex};
+                Requested = c;
+            }
+            Wake.notify_one();
+        }
+
+        void run() {
+            ptr<const cell> frontier{};
+            while (true) {
+                ptr<const cell> c;
+                {
+                    std::unique_lock<std::mutex> lock{Mutex};
+                    Wake.wait(lock, [this]() {
+                        return Stop || Requested != nullptr;
+                    });
+                    if (Stop) return;
+                    c = std::move(Requested);
+                    Requested = nullptr;
+                }
+
+                if (frontier == nullptr || frontier->Index < c->Index) frontier = c;
+                size_t target = c->Index + Ahead;
+                c = nullptr;
+
+                try {
+                    while (frontier->Index < target) {
+                        if (frontier->Index % 16 == 0) {
+                            std::lock_guard<std::mutex> lock{Mutex};
+                            if (Stop) return;
+                        }
+                        frontier = frontier->next();
+                        Reached.store(frontier->Index, std::memory_order_relaxed);
+                    }
+                } catch (...) {
+                    return;
+                }
+            }
         }
-        
     };
 
 }
@@ -0,0 +1,415 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef DATA_MATH_ALGEBRA_PERMUTATION_GROUP
+#define DATA_MATH_ALGEBRA_PERMUTATION_GROUP
+
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <data/math/permutation.hpp>
+#include <data/math/dense_permutation.hpp>
+
+namespace data::math::algebra {
+
+    // A group of permutations of 0, ..., n - 1 given by generators.
+    //
+    // It is stored as a base b_0, b_1, ... and a strong generating set,
+    // which is built with the random Schreier-Sims algorithm. The orbit
+    // of each b_i under the stabilizer of b_0, ..., b_(i-1) is kept as a
+    // Schreier vector rather than as a table of coset representatives,
+    // so the memory used is O(n) per base point and strong generator.
+    //
+    // Random Schreier-Sims is a Monte Carlo algorithm. It stops once
+    // `confidence` random elements in a row are found to be in the group
+    // that it has built so far, so the chance that the order comes out
+    // too small is at most about 2^-confidence.
+    //
+    // Groups that are the whole symmetric or alternating group, which
+    // would have a base of length n, are recognized before Schreier-Sims
+    // is tried, and are handled without a stabilizer chain.
+    class permutation_group {
+    public:
+        permutation_group(size_t n, const std::vector<dense_permutation>& generators,
+            uint64 seed = 0, uint32 confidence = 40);
+
+        template <typename elem>
+        permutation_group(size_t n, list<permutation<elem>> generators,
+            uint64 seed = 0, uint32 confidence = 40);
+
+        static permutation_group symmetric(size_t n);
+        static permutation_group alternating(size_t n);
+
+        // the trivial group.
+        explicit permutation_group(size_t n = 0) : permutation_group{n, std::vector<dense_permutation>{}} {}
+
+        size_t degree() const {
+            return Degree;
+        }
+
+        const std::vector<dense_permutation>& generators() const {
+            return Generators;
+        }
+
+        bool is_symmetric() const {
+            return Kind == symmetric_kind;
+        }
+
+        bool is_alternating() const {
+            return Kind == alternating_kind;
+        }
+
+        std::vector<uint32> base() const;
+
+        // the size of the orbit of each base point under the stabilizer
+        // of the points before it. The order is the product of these.
+        std::vector<size_t> orbit_sizes() const;
+
+        // N must be big enough to hold the order. For large groups
+        // use math::N or double.
+        template <typename N = uint64>
+        N order() const {
+            N r{1};
+            for (size_t s : orbit_sizes()) r = r * N(s);
+            return r;
+        }
+
+        // false for permutations that move points past the degree.
+        bool contains(const dense_permutation& g) const;
+
+        bool contains(const permutation<uint32>& g) const {
+            return contains(g.dense());
+        }
+
+        // uniformly distributed.
+        template <typename engine>
+        dense_permutation random(engine& e) const;
+
+    private:
+        enum kind : byte {general_kind, symmetric_kind, alternating_kind};
+
+        // the orbit of a base point. Schreier[x] is the label l of a strong
+        // generator or its inverse that takes Labels[l ^ 1](x) to x, which
+        // is one step closer to the base point, or root or outside.
+        struct level {
+            uint32 Point;
+            std::vector<uint32> Labels;
+            std::vector<int32> Schreier;
+            std::vector<uint32> Orbit;
+        };
+
+        static constexpr int32 root = -2;
+        static constexpr int32 outside = -1;
+
+        size_t Degree;
+        std::vector<dense_permutation> Generators;
+        kind Kind;
+
+        // strong generators and shortcuts through the Schreier trees at
+        // even positions, each followed by its inverse.
+        std::vector<dense_permutation> Labels;
+        std::vector<level> Levels;
+
+        permutation_group(size_t n, std::vector<dense_permutation> generators, kind k) :
+            Degree{n}, Generators{std::move(generators)}, Kind{k}, Labels{}, Levels{} {}
+
+        // product replacement, which generates close to uniformly
+        // distributed random elements from the generators alone.
+        struct replacement {
+            std::vector<dense_permutation> State;
+            dense_permutation Accumulator;
+            std::mt19937_64 Random;
+
+            replacement(size_t n, const std::vector<dense_permutation>& generators, uint64 seed);
+            const dense_permutation& next();
+        };
+
+        bool giant(replacement& r) const;
+        void schreier_sims(replacement& r, uint32 confidence);
+
+        // g is replaced with u^-1 * g, where u is the coset representative
+        // at the given level that takes the base point to x.
+        void trace(const level& l, uint32 x, dense_permutation& g) const;
+
+        // returns the level at which g could not be sifted any further,
+        // or the number of levels if it was sifted all the way through.
+        size_t sift(dense_permutation& g) const;
+
+        void add(dense_permutation h, size_t at);
+
+        // computes the orbit and returns the depth of the Schreier tree.
+        uint32 orbit(level& l) const;
+
+        // sifting takes time proportional to the depth of the Schreier
+        // trees, so when a tree gets deep, the coset representative of the
+        // deepest point is added as another label, which about halves it.
+        void shallow(level& l);
+
+        static bool is_prime(size_t p);
+
+        // g extended to n points. Throws std::invalid_argument
+        // if g moves points past n.
+        static dense_permutation of_degree(const dense_permutation& g, size_t n);
+
+        // g * p, in place, for permutations of the same degree.
+        static void left_multiply(const dense_permutation& g, dense_permutation& p) {
+            const uint32* s = g.Image.data();
+            for (uint32& x : p.Image) x = s[x];
+        }
+    };
+
+    inline bool permutation_group::is_prime(size_t p) {
+        if (p < 2) return false;
+        for (size_t d = 2; d * d <= p; d++) if (p % d == 0) return false;
+        return true;
+    }
+
+    inline dense_permutation permutation_group::of_degree(const dense_permutation& g, size_t n) {
+        if (g.degree() > n) {
+            for (size_t i = n; i < g.degree(); i++) if (g.Image[i] != i) throw std::invalid_argument{"permutation is not of this degree"};
+            return dense_permutation{std::vector<uint32>(g.Image.begin(), g.Image.begin() + n)};
+        }
+        return g * dense_permutation(n);
+    }
+
+    inline permutation_group::replacement::replacement(size_t n, const std::vector<dense_permutation>& generators, uint64 seed) :
+        State{}, Accumulator(n), Random{seed} {
+        size_t size = std::max<size_t>(10, 2 * generators.size());
+        for (size_t i = 0; i < size; i++)
+            State.push_back(generators.empty() ? dense_permutation(n) : generators[i % generators.size()]);
+        for (int i = 0; i < 50; i++) next();
+    }
+
+    inline const dense_permutation& permutation_group::replacement::next() {
+        size_t s = State.size();
+        size_t i = Random() % s;
+        size_t j = Random() % (s - 1);
+        if (j >= i) j++;
+        dense_permutation& x = State[i];
+        const dense_permutation& y = State[j];
+        switch (Random() % 4) {
+            case 0: x = x * y; break;
+            case 1: x = y * x; break;
+            case 2: x = x * y.inverse(); break;
+            default: x = y.inverse() * x;
+        }
+        Accumulator = Accumulator * x;
+        return Accumulator;
+    }
+
+    inline permutation_group::permutation_group(size_t n, const std::vector<dense_permutation>& generators, uint64 seed, uint32 confidence) :
+        Degree{n}, Generators{}, Kind{general_kind}, Labels{}, Levels{} {
+        for (const dense_permutation& g : generators) if (!g.is_identity()) Generators.push_back(of_degree(g, n));
+        if (Generators.empty()) return;
+
+        replacement r{n, Generators, seed};
+        if (giant(r)) {
+            Kind = alternating_kind;
+            for (const dense_permutation& g : Generators) if (g.signature() == math::negative) Kind = symmetric_kind;
+            return;
+        }
+
+        schreier_sims(r, confidence);
+    }
+
+    template <typename elem>
+    permutation_group::permutation_group(size_t n, list<permutation<elem>> generators, uint64 seed, uint32 confidence) :
+        permutation_group{n, [&generators]() {
+            std::vector<dense_permutation> g{};
+            for (; !generators.empty(); generators = generators.rest()) g.push_back(generators.first().dense());
+            return g;
+        }(), seed, confidence} {}
+
+    inline permutation_group permutation_group::symmetric(size_t n) {
+        if (n < 2) return permutation_group(n);
+        std::vector<uint32> c(n);
+        for (uint32 i = 0; i < n; i++) c[i] = i;
+        return permutation_group{n, {
+            dense_permutation::from_cycles({{0, 1}}, n),
+            dense_permutation::from_cycles({c}, n)}, symmetric_kind};
+    }
+
+    // generated by (0 1 2) and an even cycle on either all n points
+    // or all but the first.
+    inline permutation_group permutation_group::alternating(size_t n) {
+        if (n < 3) return permutation_group(n);
+        std::vector<uint32> c{};
+        for (uint32 i = n % 2 == 0 ? 1 : 0; i < n; i++) c.push_back(i);
+        return permutation_group{n, {
+            dense_permutation::from_cycles({{0, 1, 2}}, n),
+            dense_permutation::from_cycles({c}, n)}, alternating_kind};
+    }
+
+    // A transitive group with an element that has a cycle of prime
+    // length p, n/2 < p < n - 2, contains the alternating group. When
+    // the group is a giant, a random element has such a cycle with
+    // probability about log 2 / log n.
+    inline bool permutation_group::giant(replacement& r) const {
+        if (Degree < 8) return false;
+
+        std::vector<bool> seen(Degree, false);
+        std::vector<uint32> orbit{0};
+        seen[0] = true;
+        for (size_t i = 0; i < orbit.size(); i++) for (const dense_permutation& g : Generators) {
+            uint32 x = g.Image[orbit[i]];
+            if (!seen[x]) {
+                seen[x] = true;
+                orbit.push_back(x);
+            }
+        }
+        if (orbit.size() != Degree) return false;
+
+        size_t tries = 20;
+        for (size_t n = Degree; n > 1; n /= 2) tries += 20;
+
+        std::vector<bool> visited(Degree);
+        for (size_t t = 0; t < tries; t++) {
+            const dense_permutation& g = r.next();
+            std::fill(visited.begin(), visited.end(), false);
+            for (uint32 i = 0; i < Degree; i++) {
+                if (visited[i]) continue;
+                size_t length = 0;
+                for (uint32 x = i; !visited[x]; x = g.Image[x]) {
+                    visited[x] = true;
+                    length++;
+                }
+                if (2 * length > Degree && length + 2 < Degree && is_prime(length)) return true;
+            }
+        }
+
+        return false;
+    }
+
+    inline void permutation_group::schreier_sims(replacement& r, uint32 confidence) {
+        for (const dense_permutation& g : Generators) {
+            dense_permutation h = g;
+            size_t at = sift(h);
+            if (!h.is_identity()) add(std::move(h), at);
+        }
+
+        uint32 in_a_row = 0;
+        while (in_a_row < confidence) {
+            dense_permutation h = r.next();
+            size_t at = sift(h);
+            if (h.is_identity()) in_a_row++;
+            else {
+                add(std::move(h), at);
+                in_a_row = 0;
+            }
+        }
+    }
+
+    inline void permutation_group::trace(const level& l, uint32 x, dense_permutation& g) const {
+        while (l.Schreier[x] != root) {
+            const dense_permutation& back = Labels[l.Schreier[x] ^ 1];
+            left_multiply(back, g);
+            x = back.Image[x];
+        }
+    }
+
+    inline size_t permutation_group::sift(dense_permutation& g) const {
+        for (size_t i = 0; i < Levels.size(); i++) {
+            uint32 x = g.Image[Levels[i].Point];
+            if (Levels[i].Schreier[x] == outside) return i;
+            trace(Levels[i], x, g);
+        }
+        return Levels.size();
+    }
+
+    // h fixes the base points before the given level, so it
+    // belongs to the stabilizers at that level and above.
+    inline void permutation_group::add(dense_permutation h, size_t at) {
+        if (at == Levels.size()) {
+            uint32 moved = 0;
+            while (h.Image[moved] == moved) moved++;
+            Levels.push_back(level{moved, {}, {}, {}});
+        }
+
+        uint32 label = static_cast<uint32>(Labels.size());
+        dense_permutation inverse = h.inverse();
+        Labels.push_back(std::move(h));
+        Labels.push_back(std::move(inverse));
+
+        for (size_t i = 0; i <= at; i++) {
+            Levels[i].Labels.push_back(label);
+            Levels[i].Labels.push_back(label + 1);
+            shallow(Levels[i]);
+        }
+    }
+
+    inline void permutation_group::shallow(level& l) {
+        uint32 limit = 2;
+        for (size_t s = Degree; s > 1; s /= 2) limit += 2;
+        for (uint32 tries = 0; orbit(l) > limit && tries < limit; tries++) {
+            dense_permutation u(Degree);
+            trace(l, l.Orbit.back(), u);
+            uint32 label = static_cast<uint32>(Labels.size());
+            dense_permutation inverse = u.inverse();
+            Labels.push_back(std::move(inverse));
+            Labels.push_back(std::move(u));
+            l.Labels.push_back(label);
+            l.Labels.push_back(label + 1);
+        }
+    }
+
+    inline uint32 permutation_group::orbit(level& l) const {
+        l.Schreier.assign(Degree, outside);
+        l.Orbit.clear();
+        l.Schreier[l.Point] = root;
+        l.Orbit.push_back(l.Point);
+        std::vector<uint32> depth(Degree, 0);
+        for (size_t i = 0; i < l.Orbit.size(); i++) for (uint32 label : l.Labels) {
+            uint32 x = Labels[label].Image[l.Orbit[i]];
+            if (l.Schreier[x] == outside) {
+                l.Schreier[x] = static_cast<int32>(label);
+                l.Orbit.push_back(x);
+                depth[x] = depth[l.Orbit[i]] + 1;
+            }
+        }
+        return depth[l.Orbit.back()];
+    }
+
+    inline std::vector<uint32> permutation_group::base() const {
+        std::vector<uint32> b{};
+        if (Kind == general_kind) for (const level& l : Levels) b.push_back(l.Point);
+        else for (uint32 i = 0; i + (Kind == symmetric_kind ? 1 : 2) < Degree; i++) b.push_back(i);
+        return b;
+    }
+
+    inline std::vector<size_t> permutation_group::orbit_sizes() const {
+        std::vector<size_t> s{};
+        if (Kind == general_kind) for (const level& l : Levels) s.push_back(l.Orbit.size());
+        else for (size_t i = Degree; i > (Kind == symmetric_kind ? 1 : 2); i--) s.push_back(i);
+        return s;
+    }
+
+    inline bool permutation_group::contains(const dense_permutation& g) const {
+        for (size_t i = Degree; i < g.degree(); i++) if (g.Image[i] != i) return false;
+        if (Kind == symmetric_kind) return true;
+        if (Kind == alternating_kind) return g.signature() == math::positive;
+
+        dense_permutation h = of_degree(g, Degree);
+        sift(h);
+        return h.is_identity();
+    }
+
+    // every element is a product of one coset representative from each level.
+    template <typename engine>
+    dense_permutation permutation_group::random(engine& e) const {
+        dense_permutation g(Degree);
+        if (Kind != general_kind) {
+            for (size_t i = Degree; i > 1; i--) std::swap(g.Image[i - 1], g.Image[std::uniform_int_distribution<size_t>{0, i - 1}(e)]);
+            if (Kind == alternating_kind && g.signature() == math::negative) std::swap(g.Image[0], g.Image[1]);
+            return g;
+        }
+
+        for (const level& l : Levels)
+            trace(l, l.Orbit[std::uniform_int_distribution<size_t>{0, l.Orbit.size() - 1}(e)], g);
+        return g;
+    }
+
+}
+
+#endif
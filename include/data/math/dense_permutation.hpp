@@ -0,0 +1,188 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef DATA_MATH_DENSE_PERMUTATION
+#define DATA_MATH_DENSE_PERMUTATION
+
+#include <algorithm>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+#include <data/types.hpp>
+#include <data/math/sign.hpp>
+
+namespace data::math {
+
+    // a permutation of 0, ..., n - 1, stored as the image of each
+    // point. Points at or past the degree are fixed, so permutations
+    // of different degrees can be composed and compared. Everything
+    // is O(n) in the degree.
+    struct dense_permutation {
+        std::vector<uint32> Image;
+
+        dense_permutation() : Image{} {}
+
+        // the identity on n points.
+        explicit dense_permutation(size_t n) : Image(n) {
+            for (size_t i = 0; i < n; i++) Image[i] = static_cast<uint32>(i);
+        }
+
+        // throws std::invalid_argument if the image is not a permutation.
+        explicit dense_permutation(std::vector<uint32> image) : Image{std::move(image)} {
+            if (!valid()) throw std::invalid_argument{"not a permutation"};
+        }
+
+        static dense_permutation identity(size_t n = 0) {
+            return dense_permutation(n);
+        }
+
+        // the product of the given cycles, which must be disjoint. The
+        // cycle {a, b, c} takes a to b, b to c and c to a.
+        static dense_permutation from_cycles(const std::vector<std::vector<uint32>>& cycles, size_t n = 0);
+
+        size_t degree() const {
+            return Image.size();
+        }
+
+        bool valid() const;
+
+        uint32 operator()(uint32 i) const {
+            return i < Image.size() ? Image[i] : i;
+        }
+
+        uint32 operator*(uint32 i) const {
+            return operator()(i);
+        }
+
+        // (p * q)(i) = p(q(i)).
+        dense_permutation operator*(const dense_permutation& q) const;
+
+        dense_permutation inverse() const;
+
+        bool is_identity() const;
+
+        // the cycles of length greater than one, each starting with its
+        // smallest point, in order of their smallest points.
+        std::vector<std::vector<uint32>> cycles() const;
+
+        math::sign signature() const;
+
+        // the degree is ignored, so the identity on 3 points is
+        // equal to the identity on 5 points.
+        bool operator==(const dense_permutation& q) const;
+
+        bool operator!=(const dense_permutation& q) const {
+            return !operator==(q);
+        }
+
+    private:
+        // the largest point that is moved, plus one.
+        size_t support() const {
+            size_t n = Image.size();
+            while (n > 0 && Image[n - 1] == n - 1) n--;
+            return n;
+        }
+    };
+
+    inline std::ostream& operator<<(std::ostream& o, const dense_permutation& p) {
+        o << "permutation{";
+        bool first = true;
+        for (const std::vector<uint32>& c : p.cycles()) {
+            if (!first) o << ", ";
+            first = false;
+            o << "(";
+            for (size_t i = 0; i < c.size(); i++) o << (i == 0 ? "" : " ") << c[i];
+            o << ")";
+        }
+        return o << "}";
+    }
+
+    inline dense_permutation dense_permutation::from_cycles(const std::vector<std::vector<uint32>>& cycles, size_t n) {
+        for (const std::vector<uint32>& c : cycles)
+            for (uint32 x : c) n = std::max<size_t>(n, size_t(x) + 1);
+
+        dense_permutation p(n);
+        std::vector<bool> seen(n, false);
+        for (const std::vector<uint32>& c : cycles) for (size_t i = 0; i < c.size(); i++) {
+            if (seen[c[i]]) throw std::invalid_argument{"cycles are not disjoint"};
+            seen[c[i]] = true;
+            p.Image[c[i]] = c[(i + 1) % c.size()];
+        }
+        return p;
+    }
+
+    inline bool dense_permutation::valid() const {
+        std::vector<bool> seen(Image.size(), false);
+        for (uint32 x : Image) {
+            if (x >= Image.size() || seen[x]) return false;
+            seen[x] = true;
+        }
+        return true;
+    }
+
+    inline dense_permutation dense_permutation::operator*(const dense_permutation& q) const {
+        size_t n = std::max(Image.size(), q.Image.size());
+        dense_permutation r{};
+        r.Image.resize(n);
+
+        // the common case, in which there is nothing to check in the loop.
+        if (Image.size() == n && q.Image.size() == n) {
+            const uint32* p = Image.data();
+            const uint32* s = q.Image.data();
+            uint32* out = r.Image.data();
+            for (size_t i = 0; i < n; i++) out[i] = p[s[i]];
+        } else for (size_t i = 0; i < n; i++) r.Image[i] = operator()(q(static_cast<uint32>(i)));
+
+        return r;
+    }
+
+    inline dense_permutation dense_permutation::inverse() const {
+        dense_permutation r{};
+        r.Image.resize(Image.size());
+        for (size_t i = 0; i < Image.size(); i++) r.Image[Image[i]] = static_cast<uint32>(i);
+        return r;
+    }
+
+    inline bool dense_permutation::is_identity() const {
+        return support() == 0;
+    }
+
+    inline std::vector<std::vector<uint32>> dense_permutation::cycles() const {
+        std::vector<std::vector<uint32>> r{};
+        std::vector<bool> seen(Image.size(), false);
+        for (uint32 i = 0; i < Image.size(); i++) {
+            if (seen[i] || Image[i] == i) continue;
+            std::vector<uint32> c{};
+            for (uint32 x = i; !seen[x]; x = Image[x]) {
+                seen[x] = true;
+                c.push_back(x);
+            }
+            r.push_back(std::move(c));
+        }
+        return r;
+    }
+
+    // a cycle of length k is a product of k - 1 transpositions.
+    inline math::sign dense_permutation::signature() const {
+        size_t transpositions = 0;
+        std::vector<bool> seen(Image.size(), false);
+        for (uint32 i = 0; i < Image.size(); i++) {
+            if (seen[i]) continue;
+            for (uint32 x = Image[i]; x != i; x = Image[x]) {
+                seen[x] = true;
+                transpositions++;
+            }
+        }
+        return transpositions % 2 == 0 ? math::positive : math::negative;
+    }
+
+    inline bool dense_permutation::operator==(const dense_permutation& q) const {
+        size_t n = support();
+        if (n != q.support()) return false;
+        return std::equal(Image.begin(), Image.begin() + n, q.Image.begin());
+    }
+
+}
+
+#endif
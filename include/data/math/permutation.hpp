@@ -5,14 +5,25 @@
 #ifndef DATA_MATH_PERMUTATION
 #define DATA_MATH_PERMUTATION
 
+#include <limits>
 #include <data/tools.hpp>
 #include <data/tools/cycle.hpp>
+#include <data/for_each.hpp>
 
 #include <data/math/arithmetic.hpp>
 #include <data/math/associative.hpp>
+#include <data/math/group.hpp>
+#include <data/math/sign.hpp>
+#include <data/math/dense_permutation.hpp>
 
 namespace data::math {
 
+    // permutations in cycle form. When elem is an integral type, 
+    // products and comparisons are done with dense_permutation. 
+    // Small non-negative points are used as indices directly; 
+    // otherwise the points that are moved are numbered in order 
+    // first, so that the time is never worse than n log n in the 
+    // number of points moved. 
     template <typename elem>
     struct permutation {
         struct cycle : tool::cycle<elem> {
@@ -25,7 +36,7 @@ namespace data::math {
             elem operator*(const elem e) const;
         
             permutation operator*(const cycle& c) const {
-                throw method::unimplemented{"cycle * cycle"};
+                return permutation(list<cycle>{*this}) * permutation(list<cycle>{c});
             }
             
             cycle inverse() const {
@@ -41,8 +52,8 @@ namespace data::math {
             }
             
             set<elem> elements() const {
-                auto x = set<elem>{tool::cycle<elem>::Cycle};
-                if (x.size() == 0) return set<elem>{};
+                set<elem> x{};
+                for (const elem& e : *this) x = x.insert(e);
                 return x;
             }
             
@@ -51,7 +62,7 @@ namespace data::math {
             cycle normalize() const;
         
             permutation operator*(const permutation& p) const {
-                throw method::unimplemented{"cycle * perm"};
+                return permutation(list<cycle>{*this}) * p;
             }
         };
         
@@ -60,6 +71,13 @@ namespace data::math {
         permutation() : Cycles{} {}
         permutation(std::initializer_list<cycle> x);
         
+        explicit permutation(const dense_permutation& p);
+        
+        // requires that elem be an integral type. Throws 
+        // std::invalid_argument on points that are negative 
+        // or that do not fit in a uint32. 
+        dense_permutation dense() const;
+        
         bool valid() const;
         
         math::sign signature() const;
@@ -100,6 +118,18 @@ namespace data::math {
         permutation(list<cycle> c) : Cycles{c} {}
         
         permutation operator*(const cycle& p) const;
+        
+        // the product of the cycles in the order they are given. 
+        static permutation multiply(list<cycle>);
+        
+        // the points moved by the cycles, in order, or nothing if the 
+        // points are small enough to be used as indices themselves. 
+        static std::vector<elem> points(list<cycle>);
+        
+        // the cycles in dense form, with points[i] standing for i. 
+        static dense_permutation dense_form(list<cycle>, const std::vector<elem>& points);
+        
+        static permutation cycle_form(const dense_permutation&, const std::vector<elem>& points);
     };
     
 }
@@ -128,35 +158,102 @@ namespace data::math {
     
     template <typename elem> 
     elem permutation<elem>::cycle::operator*(const elem e) const {
-        list<elem> c = tool::cycle<elem>::Cycle;
-        while (!c.empty()) {
-            elem a = c.first();
-            list<elem> c = c.rest();
-            if (e == a) return c.empty() ? tool::cycle<elem>::Cycle.first() : c.first();
-        }
+        for (size_t i = 0; i < tool::cycle<elem>::size(); i++)
+            if (e == (*this)[i]) return (*this)[i + 1];
         return e;
     }
     
     template <typename elem> 
     typename permutation<elem>::cycle
     permutation<elem>::cycle::normalize() const {
-        if (tool::cycle<elem>::size() == 0 || tool::cycle<elem>::size() == 1) return cycle{};
-        
-        elem first = tool::cycle<elem>::Cycle.first();
-        list<elem> rest = tool::cycle<elem>::Cycle.rest();
-        while (!rest.empty()) if (first != tool::cycle<elem>::Cycle.first()) return *this;
-        else rest = rest.rest();
+        if (tool::cycle<elem>::size() < 2) return cycle{};
         
-        return cycle{};
+        // the least rotation begins with the least element, so 
+        // the cycle is trivial if the last element is the same. 
+        cycle n{tool::cycle<elem>::normalize()};
+        if (n[0] == n[n.size() - 1]) return cycle{};
+        return n;
     }
     
     template <typename elem> 
     permutation<elem>::permutation(std::initializer_list<cycle> x) : Cycles{} {
-        permutation p{};
-        for (cycle c : x) p = p * c;
-        Cycles = p.Cycles;
+        list<cycle> cycles{};
+        for (cycle c : x) cycles = cycles << c;
+        Cycles = multiply(cycles).Cycles;
     } 
     
+    template <typename elem> 
+    permutation<elem>::permutation(const dense_permutation& p) : Cycles{cycle_form(p, {}).Cycles} {}
+    
+    template <typename elem> 
+    dense_permutation permutation<elem>::dense() const {
+        static_assert(std::is_integral<elem>::value, "dense permutations are of integers");
+        for (list<cycle> c = Cycles; !c.empty(); c = c.rest()) for (const elem& e : c.first()) {
+            if constexpr (std::is_signed<elem>::value) 
+                if (e < 0) throw std::invalid_argument{"dense permutations are of non-negative integers"};
+            if (static_cast<uint64>(e) > std::numeric_limits<uint32>::max()) 
+                throw std::invalid_argument{"dense permutations are of 32-bit integers"};
+        }
+        return dense_form(Cycles, {});
+    }
+    
+    template <typename elem> 
+    std::vector<elem> permutation<elem>::points(list<cycle> cycles) {
+        std::vector<elem> x{};
+        for (; !cycles.empty(); cycles = cycles.rest()) {
+            cycle c = cycles.first().normalize();
+            if (c.size() > 1) for (const elem& e : c) x.push_back(e);
+        }
+        
+        std::sort(x.begin(), x.end());
+        x.erase(std::unique(x.begin(), x.end()), x.end());
+        if (x.empty()) return x;
+        
+        // the points are used directly if that costs no 
+        // more than a few times as much as numbering them. 
+        if constexpr (std::is_signed<elem>::value) if (x.front() < 0) return x;
+        if (static_cast<uint64>(x.back()) < 4 * uint64(x.size()) + 64) return {};
+        return x;
+    }
+    
+    template <typename elem> 
+    dense_permutation permutation<elem>::dense_form(list<cycle> cycles, const std::vector<elem>& points) {
+        std::vector<std::vector<uint32>> d{};
+        for (; !cycles.empty(); cycles = cycles.rest()) {
+            cycle c = cycles.first().normalize();
+            if (c.size() < 2) continue;
+            d.push_back({});
+            for (const elem& e : c) d.back().push_back(points.empty() ? static_cast<uint32>(e) : 
+                static_cast<uint32>(std::lower_bound(points.begin(), points.end(), e) - points.begin()));
+        }
+        return dense_permutation::from_cycles(d);
+    }
+    
+    template <typename elem> 
+    permutation<elem> permutation<elem>::cycle_form(const dense_permutation& p, const std::vector<elem>& points) {
+        list<cycle> cycles{};
+        for (const std::vector<uint32>& c : p.cycles()) {
+            std::vector<elem> e{};
+            for (uint32 x : c) e.push_back(points.empty() ? elem(x) : points[x]);
+            cycles = cycles << cycle{e};
+        }
+        return permutation(cycles);
+    }
+    
+    template <typename elem> 
+    permutation<elem> permutation<elem>::multiply(list<cycle> cycles) {
+        if constexpr (std::is_integral<elem>::value) {
+            std::vector<elem> x = points(cycles);
+            dense_permutation p{};
+            for (; !cycles.empty(); cycles = cycles.rest()) p = p * dense_form(list<cycle>{cycles.first()}, x);
+            return cycle_form(p, x);
+        } else {
+            permutation p{};
+            for (; !cycles.empty(); cycles = cycles.rest()) p = p * cycles.first();
+            return p;
+        }
+    }
+    
     template <typename elem>     
     bool permutation<elem>::valid() const {
         set<elem> elements{};
@@ -166,9 +263,7 @@ namespace data::math {
             cycles = cycles.rest();
             if (!c.valid()) return false;
             
-            list<elem> e = c.Cycle;
-            while (!e.empty()) {
-                elem x = e.first();
+            for (const elem& x : c) {
                 if (elements.contains(x)) return false;
                 elements = elements.insert(x);
             }
@@ -176,6 +271,16 @@ namespace data::math {
         return true;
     }
     
+    template <typename elem> 
+    math::sign permutation<elem>::signature() const {
+        size_t transpositions = 0;
+        for (list<cycle> c = Cycles; !c.empty(); c = c.rest()) {
+            size_t s = c.first().normalize().size();
+            if (s > 1) transpositions += s - 1;
+        }
+        return transpositions % 2 == 0 ? math::positive : math::negative;
+    }
+    
     template <typename elem>    
     inline permutation<elem> 
     permutation<elem>::normalize() const {
@@ -199,6 +304,7 @@ namespace data::math {
             cycle c = apply.first();
             elem a = c * e;
             if (a != e) return a;
+            apply = apply.rest();
         }
         return e;
     }
@@ -206,6 +312,11 @@ namespace data::math {
     template <typename elem> 
     permutation<elem> 
     permutation<elem>::operator*(const permutation& p) const {
+        if constexpr (std::is_integral<elem>::value) {
+            std::vector<elem> x = points(Cycles << p.Cycles);
+            return cycle_form(dense_form(Cycles, x) * dense_form(p.Cycles, x), x);
+        }
+        
         permutation left{this->normalize()};
         if (left.Cycles.empty()) return p;
         
@@ -232,6 +343,11 @@ namespace data::math {
     
     template <typename elem> 
     bool permutation<elem>::operator==(const permutation& p) const {
+        if constexpr (std::is_integral<elem>::value) {
+            std::vector<elem> x = points(Cycles << p.Cycles);
+            return dense_form(Cycles, x) == dense_form(p.Cycles, x);
+        }
+        
         if (Cycles.size() != p.Cycles.size()) return false;
         if (Cycles.size() == 0) return true;
         return permutation{} == operator*(p.inverse());
@@ -245,8 +361,10 @@ namespace data::math {
     template <typename elem> 
     permutation<elem> 
     permutation<elem>::operator*(const cycle& c) const {
+        if constexpr (std::is_integral<elem>::value) return *this * permutation(list<cycle>{c});
+        
         list<cycle> cycles = Cycles;
-        if (!cycles.empty()) return permutation{c};
+        if (cycles.empty()) return permutation(list<cycle>{c});
         
         permutation p = cycles.first() * c;
         cycles = cycles.rest();
@@ -0,0 +1,184 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef DATA_PARALLEL
+#define DATA_PARALLEL
+
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include <data/fold.hpp>
+#include <data/math/arithmetic.hpp>
+#include <data/math/associative.hpp>
+#include <data/math/commutative.hpp>
+#include <data/tools/linked_tree.hpp>
+#include <data/tools/thread_pool.hpp>
+
+namespace data::meta {
+
+    template <typename X>
+    class is_complete {
+        template <typename U> static auto test(int) -> decltype((void)sizeof(U), yes());
+        template <typename> static no test(...);
+    public:
+        static constexpr bool value = std::is_same<decltype(test<X>(0)), yes>::value;
+    };
+
+    // plus and times on built-in integers are not declared in the
+    // math library, but they are associative and commutative.
+    template <typename f, typename x>
+    struct is_integer_arithmetic {
+        static constexpr bool value = std::is_integral<x>::value && (
+            std::is_same<f, data::plus<x>>::value || std::is_same<f, data::times<x>>::value ||
+            std::is_same<f, std::plus<x>>::value || std::is_same<f, std::multiplies<x>>::value);
+    };
+
+    // whether f has been declared associative over x with math::associative.
+    template <typename f, typename x>
+    struct is_associative {
+        static constexpr bool value =
+            is_complete<math::associative<f, x>>::value || is_integer_arithmetic<f, x>::value;
+    };
+
+    template <typename f, typename x>
+    struct is_commutative {
+        static constexpr bool value =
+            is_complete<math::commutative<f, x>>::value || is_integer_arithmetic<f, x>::value;
+    };
+
+}
+
+namespace data {
+
+    // The parallel reductions below combine the elements of a container
+    // with f in order, without an identity, and return x{} if the
+    // container is empty. The work is split between threads only if f
+    // has been declared associative. Otherwise they are left folds in
+    // one thread. If f is also commutative, partial results are
+    // combined as soon as they are ready rather than in order. The
+    // parts of a container are reduced in tool::thread_pool::shared().
+
+    template <typename f, typename I>
+    std::decay_t<decltype(*std::declval<I>())> sequential_reduce(f fun, I begin, I end) {
+        using x = std::decay_t<decltype(*begin)>;
+        if (begin == end) return x{};
+        x r = *begin;
+        for (++begin; begin != end; ++begin) r = fun(r, *begin);
+        return r;
+    }
+
+    template <typename f, typename I>
+    std::decay_t<decltype(*std::declval<I>())> parallel_reduce(f fun, I begin, I end,
+        uint32 threads = std::thread::hardware_concurrency(),
+        size_t min_split = 1 << 14);
+
+    template <typename f, typename X>
+    X parallel_reduce(f fun, const cross<X>& c,
+        uint32 threads = std::thread::hardware_concurrency(),
+        size_t min_split = 1 << 14) {
+        return parallel_reduce(fun, c.begin(), c.end(), threads, min_split);
+    }
+
+    template <typename f, typename X>
+    X parallel_reduce(f fun, const std::vector<X>& c,
+        uint32 threads = std::thread::hardware_concurrency(),
+        size_t min_split = 1 << 14) {
+        return parallel_reduce(fun, c.begin(), c.end(), threads, min_split);
+    }
+
+    // the tree is reduced in order. Both sides of a large subtree
+    // are done at the same time.
+    template <typename f, typename X, typename alloc>
+    X parallel_reduce(f fun, const tool::linked_tree<X, alloc>& t,
+        uint32 threads = std::thread::hardware_concurrency(),
+        size_t min_split = 1 << 14);
+
+    template <typename f, typename I>
+    std::decay_t<decltype(*std::declval<I>())> parallel_reduce(f fun, I begin, I end, uint32 threads, size_t min_split) {
+        using x = std::decay_t<decltype(*begin)>;
+        static_assert(std::is_base_of<std::random_access_iterator_tag,
+            typename std::iterator_traits<I>::iterator_category>::value, "parallel_reduce needs random access");
+
+        // every part has at least one element.
+        min_split = std::max<size_t>(min_split, 1);
+        size_t n = std::distance(begin, end);
+        if (!meta::is_associative<f, x>::value || threads < 2 || n < 2 * min_split)
+            return sequential_reduce(fun, begin, end);
+
+        size_t parts = std::min<size_t>(threads, n / min_split);
+
+        if constexpr (meta::is_commutative<f, x>::value) {
+            std::optional<x> total{};
+            std::mutex m{};
+            auto task = [fun, begin, n, parts, &total, &m](size_t p) mutable {
+                x r = sequential_reduce(fun, begin + n * p / parts, begin + n * (p + 1) / parts);
+                std::lock_guard<std::mutex> lock{m};
+                total = total ? fun(*total, r) : r;
+            };
+
+            tool::thread_pool& pool = tool::thread_pool::shared();
+            std::vector<tool::future<void>> tasks{};
+            for (size_t p = 1; p < parts; p++) tasks.push_back(pool.spawn([task, p]() mutable {
+                task(p);
+            }));
+            // every task refers to total, so they must all
+            // be done before an exception can be thrown.
+            std::exception_ptr error{};
+            try {
+                task(0);
+            } catch (...) {
+                error = std::current_exception();
+            }
+            for (auto& t : tasks) t.wait();
+            if (error) std::rethrow_exception(error);
+            for (auto& t : tasks) t.get();
+            return *total;
+        } else {
+            tool::thread_pool& pool = tool::thread_pool::shared();
+            std::vector<tool::future<x>> tasks{};
+            for (size_t p = 1; p < parts; p++)
+                tasks.push_back(pool.spawn([fun, begin, n, parts, p]() -> x {
+                    return sequential_reduce(fun, begin + n * p / parts, begin + n * (p + 1) / parts);
+                }));
+            // likewise, the tasks read from the range.
+            std::optional<x> r{};
+            std::exception_ptr error{};
+            try {
+                r = sequential_reduce(fun, begin, begin + n / parts);
+            } catch (...) {
+                error = std::current_exception();
+            }
+            for (auto& t : tasks) t.wait();
+            if (error) std::rethrow_exception(error);
+            for (auto& t : tasks) r = fun(*r, t.get());
+            return *r;
+        }
+    }
+
+    template <typename f, typename X, typename alloc>
+    X parallel_reduce(f fun, const tool::linked_tree<X, alloc>& t, uint32 threads, size_t min_split) {
+        if (!meta::is_associative<f, X>::value) {
+            auto in = t.in_order();
+            return sequential_reduce(fun, in.begin(), in.end());
+        }
+
+        // the same function is used by every thread, so each call
+        // works with its own copy of fun.
+        std::optional<X> r = t.parallel_fold([fun](const X& v, std::optional<X> l, std::optional<X> r) -> std::optional<X> {
+            f g = fun;
+            X m = l ? g(*l, v) : v;
+            return r ? g(m, *r) : m;
+        }, std::optional<X>{}, threads, min_split);
+        return r ? *r : X{};
+    }
+
+}
+
+#endif
@@ -0,0 +1,212 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef DATA_PIPELINE
+#define DATA_PIPELINE
+
+#include <iterator>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <data/fold.hpp>
+#include <data/function.hpp>
+#include <data/stack.hpp>
+
+// Lazy pipelines over sequences. for_each builds a new container every
+// time it is used, so a chain of steps allocates one container per
+// step. A view instead holds the sequence it was made from and does
+// its work as elements are asked for, so that a chain of map, filter,
+// take and zip is one pass over the original sequence with nothing
+// allocated. A view is itself a sequence, with empty, first and rest,
+// so views can be put on top of each other and given to data::fold.
+// They work on anything with those three methods, including
+// data::infinite. Use to<L> to put the elements in a container.
+namespace data::pipeline {
+
+    template <typename L>
+    using element = std::decay_t<decltype(std::declval<const L>().first())>;
+
+    // an input iterator that runs a sequence down to empty.
+    // The end iterator holds nothing, and it is equal to
+    // any iterator whose sequence is empty.
+    template <typename L>
+    struct iterator {
+        using value_type = element<L>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type*;
+        using reference = value_type;
+        using iterator_category = std::input_iterator_tag;
+
+        std::optional<L> Sequence;
+
+        value_type operator*() const {
+            return Sequence->first();
+        }
+
+        iterator& operator++() {
+            Sequence = Sequence->rest();
+            return *this;
+        }
+
+        bool done() const {
+            return !Sequence || Sequence->empty();
+        }
+
+        bool operator==(const iterator& i) const {
+            return done() && i.done();
+        }
+
+        bool operator!=(const iterator& i) const {
+            return !(*this == i);
+        }
+    };
+
+    // gives begin and end to a view.
+    template <typename V>
+    struct base {
+        iterator<V> begin() const {
+            return iterator<V>{static_cast<const V&>(*this)};
+        }
+
+        iterator<V> end() const {
+            return iterator<V>{};
+        }
+    };
+
+    template <typename f, typename L>
+    struct mapped : base<mapped<f, L>> {
+        assignable<f> Function;
+        L Source;
+
+        mapped(assignable<f> fun, const L& l) : Function{fun}, Source{l} {}
+
+        bool empty() const {
+            return Source.empty();
+        }
+
+        std::decay_t<std::invoke_result_t<const f&, element<L>>> first() const {
+            return Function(Source.first());
+        }
+
+        mapped rest() const {
+            return mapped{Function, Source.rest()};
+        }
+    };
+
+    // the source is always kept at an element that satisfies
+    // the predicate, so first does not need to search.
+    template <typename p, typename L>
+    struct filtered : base<filtered<p, L>> {
+        assignable<p> Predicate;
+        L Source;
+
+        filtered(assignable<p> pred, const L& l) : Predicate{pred}, Source{skip(pred, l)} {}
+
+        bool empty() const {
+            return Source.empty();
+        }
+
+        element<L> first() const {
+            return Source.first();
+        }
+
+        filtered rest() const {
+            return filtered{Predicate, Source.rest()};
+        }
+
+    private:
+        static L skip(const assignable<p>& pred, L l) {
+            while (!l.empty() && !pred(l.first())) l = l.rest();
+            return l;
+        }
+    };
+
+    template <typename L>
+    struct taken : base<taken<L>> {
+        size_t Count;
+        L Source;
+
+        taken(size_t n, const L& l) : Count{n}, Source{l} {}
+
+        bool empty() const {
+            return Count == 0 || Source.empty();
+        }
+
+        element<L> first() const {
+            return Source.first();
+        }
+
+        taken rest() const {
+            return taken{Count - 1, Source.rest()};
+        }
+    };
+
+    template <typename A, typename B>
+    struct zipped : base<zipped<A, B>> {
+        A Left;
+        B Right;
+
+        zipped(const A& a, const B& b) : Left{a}, Right{b} {}
+
+        bool empty() const {
+            return Left.empty() || Right.empty();
+        }
+
+        std::pair<element<A>, element<B>> first() const {
+            return {Left.first(), Right.first()};
+        }
+
+        zipped rest() const {
+            return zipped{Left.rest(), Right.rest()};
+        }
+    };
+
+    template <typename f, typename L>
+    inline mapped<f, L> map(f fun, const L& l) {
+        return mapped<f, L>{fun, l};
+    }
+
+    template <typename p, typename L>
+    inline filtered<p, L> filter(p pred, const L& l) {
+        return filtered<p, L>{pred, l};
+    }
+
+    template <typename L>
+    inline taken<L> take(size_t n, const L& l) {
+        return taken<L>{n, l};
+    }
+
+    template <typename A, typename B>
+    inline zipped<A, B> zip(const A& a, const B& b) {
+        return zipped<A, B>{a, b};
+    }
+
+    template <typename x, typename f, typename L>
+    inline x fold(f fun, x init, const L& l) {
+        return data::fold(fun, init, l);
+    }
+
+    // Put the elements of a finite view into a list, in order. Lists
+    // with append are built from the front. Stacks are built from
+    // the back, so the elements are held in a vector first.
+    template <typename out, typename L>
+    out to(L l) {
+        using x = element<L>;
+        if constexpr (meta::has_append_method<out, x>::value) {
+            out o{};
+            for (; !l.empty(); l = l.rest()) o = o.append(l.first());
+            return o;
+        } else {
+            std::vector<x> v{};
+            for (; !l.empty(); l = l.rest()) v.push_back(l.first());
+            out o{};
+            for (auto i = v.rbegin(); i != v.rend(); ++i) o = data::prepend(o, *i);
+            return o;
+        }
+    }
+
+}
+
+#endif
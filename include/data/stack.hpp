@@ -40,15 +40,13 @@ namespace data {
 namespace data::functional::stack {
     
     template <typename L>
-    L reverse(L list) {        
-        struct inner {
-            L operator()(L reversed, L list) {
-                if (data::empty(list)) return reversed;
-                return inner{}(reversed << first(list), rest(list));
-            }
-        };
-        
-        return inner{}(L{}, list);
+    L reverse(L list) {
+        L reversed{};
+        while (!data::empty(list)) {
+            reversed = reversed << first(list);
+            list = rest(list);
+        }
+        return reversed;
     }
     
     template <typename L>
@@ -81,22 +79,21 @@ namespace data::functional::stack {
         return p(t(l1.first(), l2.first()), inner(t, rest(l1), rest(l2), p));
     }
     
-    // Requires element to be ordered. 
-    // used in merge sort. 
-    template <typename X> X merge(const X& a, const X& b) {
+    // Requires element to be ordered. Ties go to a. 
+    template <typename X> X merge(X a, X b) {
         X r{};
         while (!empty(a) && !empty(b)) {
-            if (first(a) > first(b)) {
-                r = r + first(a);
+            if (first(b) < first(a)) {
+                r = r << first(b);
                 b = rest(b);
             } else {
-                r = r + first(b);
-                b = rest(b);
+                r = r << first(a);
+                a = rest(a);
             }
         }
         
-        if (empty(a)) r = prepend(r, b);
-        else if (empty(b)) r = prepend(r, a);
+        for (; !empty(a); a = rest(a)) r = r << first(a);
+        for (; !empty(b); b = rest(b)) r = r << first(b);
         return reverse(r);
     }
     
@@ -165,7 +162,7 @@ namespace data::functional::stack {
         bool contains(X x) const {
             if (x == First) return true;
             
-            return contains(Rest, x);
+            return Rest.contains(x);
         }
         
         bool operator==(const node& n) const {
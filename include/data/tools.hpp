@@ -23,12 +23,19 @@
 
 // A implementations of data structures. 
 #include <data/tools/linked_stack.hpp>
+#include <data/tools/chunked_stack.hpp>
 #include <data/tools/rb_map.hpp>
 #include <data/tools/functional_queue.hpp>
+#include <data/tools/real_time_queue.hpp>
+#include <data/tools/indexed_list.hpp>
 #include <data/tools/linked_tree.hpp>
 #include <data/tools/map_set.hpp>
+#include <data/tools/hamt_map.hpp>
+#include <data/tools/find_all.hpp>
 #include <data/tools/priority_queue.hpp>
+#include <data/tools/binary_heap.hpp>
 #include <data/tools/ordered_list.hpp>
+#include <data/tools/merge_sort.hpp>
 
 namespace data {
     
@@ -37,6 +44,10 @@ namespace data {
     // functional queue built using the list. 
     template <typename X> using list = tool::functional_queue<stack<X>>;
     
+    // a list whose operations take O(1) in the worst case rather than 
+    // amortized, for when old versions are used again. 
+    template <typename X> using rt_list = tool::real_time_queue<X>;
+    
     // tree. 
     template <typename X> using tree = tool::linked_tree<X>;
     
@@ -47,28 +58,27 @@ namespace data {
     // set implemented as a map. 
     template <typename X> using set = tool::map_set<map<X, tool::unit>>;
     
+    // unordered map and set implemented as hash tries. 
+    template <typename K, typename V> using hash_map = tool::hamt_map<K, V>;
+    template <typename X> using hash_set = tool::hamt_set<X>;
+    
     // priority queue. wrapper of Milewski's implementation of Okasaki.
     template <typename X> using priority_queue = tool::priority_queue<X, stack<X>>;
     
-    // ordered_list. wrapper of Milewski's implementation of Okasaki.
+    // ordered_list. a sorted sequence on a balanced tree.
     template <typename X> using ordered_list = tool::ordered_list<X>;
     
-    // get all values from a map with the given keys. 
+    // get all values from a map with the given keys, in the order 
+    // of the keys. Keys that are not in the map are skipped. 
     template <typename key, typename value, typename map>
     list<value> get_all(map m, list<key> k) {
-        struct inner {
-            map M;
-                    
-            inner(map m) : M{m} {}
-                    
-            list<value> operator()(key k, list<value> l) {
-                value v = M[k];
-                if (v == value{}) return l;
-                return l + v;
-            }
-        };
-                
-        return reduce(inner{m}, k);
+        std::vector<key> keys{};
+        keys.reserve(k.size());
+        for (; !k.empty(); k = k.rest()) keys.push_back(k.first());
+        
+        list<value> l{};
+        for (const value* v : tool::find_all(m, keys.begin(), keys.end())) if (v != nullptr) l = l << *v;
+        return l;
     }
 
 }
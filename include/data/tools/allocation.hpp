@@ -0,0 +1,342 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef DATA_TOOLS_ALLOCATION
+#define DATA_TOOLS_ALLOCATION
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Allocation policies for the nodes of persistent data structures.
+// A policy provides a pointer type and a function make which
+// constructs a node and returns a pointer to it.
+//
+//   shared  -- std::make_shared. This is the default.
+//   pooled  -- std::allocate_shared with blocks taken from a
+//              per-thread pool. Reference counts are atomic, so
+//              structures may be shared between threads.
+//   local   -- blocks from the same pool with a non-atomic
+//              reference count. A structure built with this policy
+//              must only ever be touched by one thread.
+namespace data::tool::allocation {
+
+    // blocks of a given size are kept on a free list which
+    // belongs to the current thread, so allocation and
+    // deallocation do not need a lock. Blocks are carved out
+    // of slabs which are never returned to the system, since
+    // a node may be freed in a thread other than the one that
+    // made it.
+    //
+    // Blocks that nobody is using are shared between threads
+    // through the orphans, which are kept in batches. A thread
+    // whose free list grows past two slabs' worth, as happens
+    // to a thread that frees what another thread allocates,
+    // gives all but one slab's worth to the orphans, and a
+    // thread that runs out takes a batch from the orphans
+    // before it carves a new slab. When a thread exits, its
+    // free list is given to the orphans too.
+    template <size_t size, size_t align>
+    class pool {
+        union block {
+            block* Next;
+            alignas(align) unsigned char Bytes[size];
+        };
+
+        static constexpr size_t slab_bytes = 64 * 1024;
+        static constexpr size_t blocks_per_slab =
+            slab_bytes / sizeof(block) > 16 ? slab_bytes / sizeof(block) : 16;
+
+        struct free_list {
+            block* Head;
+            size_t Count;
+            bool Exited;
+        };
+
+        struct batch {
+            block* Head;
+            size_t Count;
+        };
+
+        // trivially destructible, so that it can still be used
+        // by destructors of other thread_local objects that run
+        // after exit.
+        static free_list& local() {
+            thread_local free_list x{nullptr, 0, false};
+            return x;
+        }
+
+        static std::mutex& orphans_mutex() {
+            static std::mutex m;
+            return m;
+        }
+
+        // never destroyed, since threads may still exit
+        // after static objects have been destroyed.
+        static std::vector<batch>& orphans() {
+            static std::vector<batch>* o = new std::vector<batch>{};
+            return *o;
+        }
+
+        static std::atomic<size_t>& slab_count() {
+            static std::atomic<size_t> n{0};
+            return n;
+        }
+
+        static void give_to_orphans(block* head, size_t count) {
+            if (head == nullptr) return;
+            std::lock_guard<std::mutex> lock(orphans_mutex());
+            orphans().push_back(batch{head, count});
+        }
+
+        struct exit {
+            ~exit() {
+                free_list& l = local();
+                l.Exited = true;
+                give_to_orphans(l.Head, l.Count);
+                l.Head = nullptr;
+                l.Count = 0;
+            }
+        };
+
+        static void refill(free_list& l) {
+            {
+                std::lock_guard<std::mutex> lock(orphans_mutex());
+                if (!orphans().empty()) {
+                    l.Head = orphans().back().Head;
+                    l.Count = orphans().back().Count;
+                    orphans().pop_back();
+                    return;
+                }
+            }
+
+            block* slab = static_cast<block*>(::operator new(sizeof(block) * blocks_per_slab));
+            for (size_t i = 0; i + 1 < blocks_per_slab; i++) slab[i].Next = &slab[i + 1];
+            slab[blocks_per_slab - 1].Next = nullptr;
+            l.Head = slab;
+            l.Count = blocks_per_slab;
+            slab_count()++;
+        }
+
+        // keep the blocks that were freed most recently, which
+        // are the most likely to be in cache, and give the rest
+        // away. Walking to the cut takes one step for every
+        // block that has been freed since the last time.
+        static void trim(free_list& l) {
+            block* last = l.Head;
+            for (size_t i = 1; i < blocks_per_slab; i++) last = last->Next;
+            give_to_orphans(last->Next, l.Count - blocks_per_slab);
+            last->Next = nullptr;
+            l.Count = blocks_per_slab;
+        }
+
+        // the free list of this thread, which is given to the
+        // orphans when the thread exits. Both allocate and
+        // deallocate go through here, since a thread may only
+        // ever free blocks that other threads made.
+        static free_list& registered() {
+            thread_local exit e;
+            (void)e;
+            return local();
+        }
+
+    public:
+        static void* allocate() {
+            free_list& l = registered();
+            if (l.Head == nullptr) refill(l);
+            block* b = l.Head;
+            l.Head = b->Next;
+            l.Count--;
+            return b;
+        }
+
+        static void deallocate(void* p) {
+            block* b = static_cast<block*>(p);
+            free_list& l = local();
+            if (l.Exited) {
+                b->Next = nullptr;
+                give_to_orphans(b, 1);
+                return;
+            }
+            registered();
+            b->Next = l.Head;
+            l.Head = b;
+            if (++l.Count > 2 * blocks_per_slab) trim(l);
+        }
+
+        // how many slabs have been carved for blocks of this size.
+        static size_t slabs() {
+            return slab_count().load();
+        }
+    };
+
+    // a standard allocator over the pools. Only single objects
+    // come from the pool; arrays go to the default allocator.
+    template <typename X>
+    struct pool_allocator {
+        using value_type = X;
+
+        pool_allocator() noexcept = default;
+
+        template <typename Y>
+        pool_allocator(const pool_allocator<Y>&) noexcept {}
+
+        X* allocate(size_t n) {
+            if (n == 1) return static_cast<X*>(pool<sizeof(X), alignof(X)>::allocate());
+            return std::allocator<X>{}.allocate(n);
+        }
+
+        void deallocate(X* p, size_t n) noexcept {
+            if (n == 1) pool<sizeof(X), alignof(X)>::deallocate(p);
+            else std::allocator<X>{}.deallocate(p, n);
+        }
+
+        template <typename Y>
+        bool operator==(const pool_allocator<Y>&) const noexcept {
+            return true;
+        }
+
+        template <typename Y>
+        bool operator!=(const pool_allocator<Y>&) const noexcept {
+            return false;
+        }
+    };
+
+    // a reference-counted pointer whose count is not atomic.
+    // The count and the object share one pooled block.
+    template <typename X>
+    class local_ptr {
+        struct control {
+            size_t Count;
+            std::remove_const_t<X> Value;
+
+            template <typename ... A>
+            control(A&& ... a) : Count{1}, Value(std::forward<A>(a)...) {}
+        };
+
+        control* Control;
+
+        explicit local_ptr(control* c) noexcept : Control{c} {}
+
+        void release() noexcept {
+            if (Control != nullptr && --Control->Count == 0) {
+                Control->~control();
+                pool<sizeof(control), alignof(control)>::deallocate(Control);
+            }
+        }
+
+    public:
+        local_ptr() noexcept : Control{nullptr} {}
+        local_ptr(std::nullptr_t) noexcept : Control{nullptr} {}
+
+        local_ptr(const local_ptr& p) noexcept : Control{p.Control} {
+            if (Control != nullptr) Control->Count++;
+        }
+
+        local_ptr(local_ptr&& p) noexcept : Control{p.Control} {
+            p.Control = nullptr;
+        }
+
+        ~local_ptr() {
+            release();
+        }
+
+        local_ptr& operator=(const local_ptr& p) noexcept {
+            local_ptr x{p};
+            std::swap(Control, x.Control);
+            return *this;
+        }
+
+        local_ptr& operator=(local_ptr&& p) noexcept {
+            local_ptr x{std::move(p)};
+            std::swap(Control, x.Control);
+            return *this;
+        }
+
+        template <typename ... A>
+        static local_ptr make(A&& ... a) {
+            void* m = pool<sizeof(control), alignof(control)>::allocate();
+            control* c;
+            try {
+                c = new (m) control(std::forward<A>(a)...);
+            } catch (...) {
+                pool<sizeof(control), alignof(control)>::deallocate(m);
+                throw;
+            }
+            return local_ptr{c};
+        }
+
+        X* get() const noexcept {
+            return Control == nullptr ? nullptr : &Control->Value;
+        }
+
+        X& operator*() const noexcept {
+            return Control->Value;
+        }
+
+        X* operator->() const noexcept {
+            return &Control->Value;
+        }
+
+        explicit operator bool() const noexcept {
+            return Control != nullptr;
+        }
+
+        long use_count() const noexcept {
+            return Control == nullptr ? 0 : static_cast<long>(Control->Count);
+        }
+
+        bool operator==(const local_ptr& p) const noexcept {
+            return Control == p.Control;
+        }
+
+        bool operator!=(const local_ptr& p) const noexcept {
+            return Control != p.Control;
+        }
+
+        bool operator==(std::nullptr_t) const noexcept {
+            return Control == nullptr;
+        }
+
+        bool operator!=(std::nullptr_t) const noexcept {
+            return Control != nullptr;
+        }
+    };
+
+    struct shared {
+        template <typename X> using pointer = std::shared_ptr<X>;
+
+        template <typename X, typename ... A>
+        static pointer<X> make(A&& ... a) {
+            return std::make_shared<std::remove_const_t<X>>(std::forward<A>(a)...);
+        }
+    };
+
+    struct pooled {
+        template <typename X> using pointer = std::shared_ptr<X>;
+
+        template <typename X, typename ... A>
+        static pointer<X> make(A&& ... a) {
+            using node = std::remove_const_t<X>;
+            return std::allocate_shared<node>(pool_allocator<node>{}, std::forward<A>(a)...);
+        }
+    };
+
+    struct local {
+        template <typename X> using pointer = local_ptr<X>;
+
+        template <typename X, typename ... A>
+        static pointer<X> make(A&& ... a) {
+            return local_ptr<X>::make(std::forward<A>(a)...);
+        }
+    };
+
+}
+
+#endif
@@ -0,0 +1,222 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef DATA_TOOLS_BINARY_HEAP
+#define DATA_TOOLS_BINARY_HEAP
+
+#include <stdexcept>
+#include <vector>
+#include <data/types.hpp>
+
+namespace data::tool {
+
+    // a mutable binary heap kept in one array. Unlike the other
+    // heaps here, it is changed in place, so it must have a
+    // single owner. In exchange, it does not allocate except to
+    // grow, and it supports decrease-key.
+    //
+    // insert returns a handle which remains valid until its
+    // element is removed, so that an element can be found again
+    // in order to change its priority or to remove it.
+    //
+    // Elements are ordered with <=, so the first is the least.
+    template <typename elem>
+    class binary_heap {
+    public:
+        using handle = size_t;
+
+    private:
+        struct entry {
+            elem Value;
+            handle Handle;
+        };
+
+        std::vector<entry> Entries;
+
+        // the position of each handle in Entries. A free handle
+        // holds the next free handle instead.
+        std::vector<size_t> Positions;
+        handle Free;
+
+        static constexpr handle none = static_cast<handle>(-1);
+
+        handle claim();
+        void place(size_t i, entry&& e);
+        void sift_up(size_t i);
+        void sift_down(size_t i);
+
+    public:
+        binary_heap() : Entries{}, Positions{}, Free{none} {}
+
+        // Floyd's method, which takes O(n). Handles are given
+        // out in the order of the sequence, starting from zero.
+        template <typename it>
+        binary_heap(it begin, it end);
+
+        bool empty() const;
+        size_t size() const;
+
+        const elem& first() const;
+        handle first_handle() const;
+
+        handle insert(const elem& x);
+
+        // remove the first element.
+        void pop();
+
+        bool contains(handle h) const;
+        const elem& operator[](handle h) const;
+
+        // x must not come after the current value.
+        void decrease(handle h, const elem& x);
+
+        // x may have any priority.
+        void update(handle h, const elem& x);
+
+        void remove(handle h);
+    };
+
+    template <typename elem>
+    template <typename it>
+    binary_heap<elem>::binary_heap(it begin, it end) : Entries{}, Positions{}, Free{none} {
+        for (it i = begin; i != end; ++i) {
+            Positions.push_back(Entries.size());
+            Entries.push_back(entry{*i, Entries.size()});
+        }
+
+        for (size_t i = Entries.size() / 2; i > 0; i--) sift_down(i - 1);
+    }
+
+    template <typename elem>
+    inline bool binary_heap<elem>::empty() const {
+        return Entries.empty();
+    }
+
+    template <typename elem>
+    inline size_t binary_heap<elem>::size() const {
+        return Entries.size();
+    }
+
+    template <typename elem>
+    inline const elem& binary_heap<elem>::first() const {
+        return Entries.front().Value;
+    }
+
+    template <typename elem>
+    inline typename binary_heap<elem>::handle binary_heap<elem>::first_handle() const {
+        return Entries.front().Handle;
+    }
+
+    template <typename elem>
+    inline typename binary_heap<elem>::handle binary_heap<elem>::claim() {
+        if (Free == none) {
+            Positions.push_back(none);
+            return Positions.size() - 1;
+        }
+
+        handle h = Free;
+        Free = Positions[h];
+        return h;
+    }
+
+    template <typename elem>
+    inline void binary_heap<elem>::place(size_t i, entry&& e) {
+        Positions[e.Handle] = i;
+        Entries[i] = std::move(e);
+    }
+
+    // the entry being moved is held aside and the entries it
+    // passes are shifted into the hole, which saves half of
+    // the writes of a sequence of swaps.
+    template <typename elem>
+    void binary_heap<elem>::sift_up(size_t i) {
+        entry e = std::move(Entries[i]);
+        while (i > 0) {
+            size_t parent = (i - 1) / 2;
+            if (Entries[parent].Value <= e.Value) break;
+            place(i, std::move(Entries[parent]));
+            i = parent;
+        }
+        place(i, std::move(e));
+    }
+
+    template <typename elem>
+    void binary_heap<elem>::sift_down(size_t i) {
+        size_t n = Entries.size();
+        entry e = std::move(Entries[i]);
+        while (true) {
+            size_t child = 2 * i + 1;
+            if (child >= n) break;
+            if (child + 1 < n && !(Entries[child].Value <= Entries[child + 1].Value)) child++;
+            if (e.Value <= Entries[child].Value) break;
+            place(i, std::move(Entries[child]));
+            i = child;
+        }
+        place(i, std::move(e));
+    }
+
+    template <typename elem>
+    typename binary_heap<elem>::handle binary_heap<elem>::insert(const elem& x) {
+        handle h = claim();
+        Entries.push_back(entry{x, h});
+        Positions[h] = Entries.size() - 1;
+        sift_up(Entries.size() - 1);
+        return h;
+    }
+
+    template <typename elem>
+    inline void binary_heap<elem>::pop() {
+        remove(first_handle());
+    }
+
+    template <typename elem>
+    inline bool binary_heap<elem>::contains(handle h) const {
+        return h < Positions.size() && Positions[h] < Entries.size() && Entries[Positions[h]].Handle == h;
+    }
+
+    template <typename elem>
+    const elem& binary_heap<elem>::operator[](handle h) const {
+        if (!contains(h)) throw std::out_of_range{"binary heap handle"};
+        return Entries[Positions[h]].Value;
+    }
+
+    template <typename elem>
+    void binary_heap<elem>::decrease(handle h, const elem& x) {
+        if (!contains(h)) throw std::out_of_range{"binary heap handle"};
+        size_t i = Positions[h];
+        Entries[i].Value = x;
+        sift_up(i);
+    }
+
+    template <typename elem>
+    void binary_heap<elem>::update(handle h, const elem& x) {
+        if (!contains(h)) throw std::out_of_range{"binary heap handle"};
+        size_t i = Positions[h];
+        Entries[i].Value = x;
+        sift_up(i);
+        sift_down(Positions[h]);
+    }
+
+    // the last entry is moved into the hole and then sifted in
+    // whichever direction it needs to go.
+    template <typename elem>
+    void binary_heap<elem>::remove(handle h) {
+        if (!contains(h)) throw std::out_of_range{"binary heap handle"};
+        size_t i = Positions[h];
+        size_t last = Entries.size() - 1;
+        if (i != last) {
+            handle moved = Entries[last].Handle;
+            place(i, std::move(Entries[last]));
+            Entries.pop_back();
+            sift_up(i);
+            sift_down(Positions[moved]);
+        } else Entries.pop_back();
+
+        Positions[h] = Free;
+        Free = h;
+    }
+
+}
+
+#endif
@@ -0,0 +1,228 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef DATA_TOOLS_BOUNDED_CHANNEL
+#define DATA_TOOLS_BOUNDED_CHANNEL
+
+#include <atomic>
+#include <chrono>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <utility>
+#include <data/tools/sleepers.hpp>
+
+namespace data::tool {
+
+    // the ring behind bounded_channel.
+    template <class item> struct bounded_ring : sleepers<bounded_ring<item>> {
+        using value_type = item;
+
+        struct slot {
+            std::atomic<size_t> Sequence;
+            alignas(item) unsigned char Data[sizeof(item)];
+
+            item* value() {
+                return std::launder(reinterpret_cast<item*>(Data));
+            }
+        };
+
+        const size_t Mask;
+        std::unique_ptr<slot[]> Slots;
+
+        // the counters are on separate cache lines, since
+        // they are written by different threads.
+        alignas(64) std::atomic<size_t> Back;
+        alignas(64) std::atomic<size_t> Front;
+
+        static size_t round_up(uint32 n) {
+            size_t s = 2;
+            while (s < n) s <<= 1;
+            return s;
+        }
+
+        explicit bounded_ring(uint32 size) : sleepers<bounded_ring>{}, Mask{round_up(size) - 1}, Slots{new slot[Mask + 1]}, Back{0}, Front{0} {
+            for (size_t i = 0; i <= Mask; i++) Slots[i].Sequence.store(i, std::memory_order_relaxed);
+        }
+
+        // holes do not have items in them.
+        ~bounded_ring() {
+            for (size_t f = Front.load(); f != Back.load(); f++) {
+                slot &s = Slots[f & Mask];
+                if (s.Sequence.load() == f + 1) s.value()->~item();
+            }
+        }
+
+        template <typename X> bool push(X &&x);
+        bool pop(item &out);
+
+        // a slot that has been claimed at back but will
+        // not be filled is made ready for the next lap.
+        void hole(size_t back) {
+            Slots[back & Mask].Sequence.store(back + Mask + 1, std::memory_order_release);
+        }
+
+        // called when the slot at front is ahead of it. If Front has not
+        // moved, the slot is a hole, since a slot is only got after Front
+        // moves past it, so move past the hole. Otherwise, catch up.
+        void skip(size_t &front) {
+            if (Front.compare_exchange_weak(front, front + 1, std::memory_order_relaxed)) front++;
+        }
+
+        // put as many items as there is room for and return where
+        // they stopped, or get up to max items and return how many.
+        template <typename it> it push_n(it begin, it end);
+        template <typename out> size_t pop_n(out o, size_t max);
+    };
+
+    template <class item>
+    template <typename X>
+    bool bounded_ring<item>::push(X &&x) {
+        size_t back = Back.load(std::memory_order_relaxed);
+        slot *s;
+        while (true) {
+            s = &Slots[back & Mask];
+            size_t seq = s->Sequence.load(std::memory_order_acquire);
+            intptr_t diff = intptr_t(seq) - intptr_t(back);
+            if (diff == 0) {
+                if (Back.compare_exchange_weak(back, back + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) return false;
+            else back = Back.load(std::memory_order_relaxed);
+        }
+
+        try {
+            new (s->Data) item(std::forward<X>(x));
+        } catch (...) {
+            hole(back);
+            throw;
+        }
+        s->Sequence.store(back + 1, std::memory_order_release);
+        return true;
+    }
+
+    template <class item>
+    bool bounded_ring<item>::pop(item &out) {
+        size_t front = Front.load(std::memory_order_relaxed);
+        slot *s;
+        while (true) {
+            s = &Slots[front & Mask];
+            size_t seq = s->Sequence.load(std::memory_order_acquire);
+            intptr_t diff = intptr_t(seq) - intptr_t(front + 1);
+            if (diff == 0) {
+                if (Front.compare_exchange_weak(front, front + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) return false;
+            else skip(front);
+        }
+
+        item *v = s->value();
+        try {
+            out = std::move(*v);
+        } catch (...) {
+            v->~item();
+            s->Sequence.store(front + Mask + 1, std::memory_order_release);
+            throw;
+        }
+        v->~item();
+        s->Sequence.store(front + Mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    // a free slot stays free until the thread that claims it
+    // fills it, so once the run of free slots that starts at
+    // Back is counted, all of it can be claimed at once.
+    template <class item>
+    template <typename it>
+    it bounded_ring<item>::push_n(it begin, it end) {
+        size_t want = std::distance(begin, end);
+        size_t back = Back.load(std::memory_order_relaxed);
+        size_t n;
+        while (true) {
+            n = 0;
+            while (n < want && n <= Mask &&
+                Slots[(back + n) & Mask].Sequence.load(std::memory_order_acquire) == back + n) n++;
+            if (n == 0) {
+                intptr_t diff = intptr_t(Slots[back & Mask].Sequence.load(std::memory_order_acquire)) - intptr_t(back);
+                if (diff < 0) return begin;
+                back = Back.load(std::memory_order_relaxed);
+            } else if (Back.compare_exchange_weak(back, back + n, std::memory_order_relaxed)) break;
+        }
+
+        for (size_t i = 0; i < n; i++, ++begin) {
+            slot &s = Slots[(back + i) & Mask];
+            try {
+                new (s.Data) item(*begin);
+            } catch (...) {
+                // the items before this one have been put.
+                for (size_t j = i; j < n; j++) hole(back + j);
+                throw;
+            }
+            s.Sequence.store(back + i + 1, std::memory_order_release);
+        }
+        return begin;
+    }
+
+    template <class item>
+    template <typename out>
+    size_t bounded_ring<item>::pop_n(out o, size_t max) {
+        size_t front = Front.load(std::memory_order_relaxed);
+        size_t n;
+        while (true) {
+            n = 0;
+            while (n < max && n <= Mask &&
+                Slots[(front + n) & Mask].Sequence.load(std::memory_order_acquire) == front + n + 1) n++;
+            if (n == 0) {
+                intptr_t diff = intptr_t(Slots[front & Mask].Sequence.load(std::memory_order_acquire)) - intptr_t(front + 1);
+                if (diff < 0) return 0;
+                skip(front);
+            } else if (Front.compare_exchange_weak(front, front + n, std::memory_order_relaxed)) break;
+        }
+
+        for (size_t i = 0; i < n; i++) {
+            slot &s = Slots[(front + i) & Mask];
+            item *v = s.value();
+            try {
+                *o++ = std::move(*v);
+            } catch (...) {
+                for (size_t j = i; j < n; j++) {
+                    slot &r = Slots[(front + j) & Mask];
+                    r.value()->~item();
+                    r.Sequence.store(front + j + Mask + 1, std::memory_order_release);
+                }
+                throw;
+            }
+            v->~item();
+            s.Sequence.store(front + i + Mask + 1, std::memory_order_release);
+        }
+        return n;
+    }
+
+    // a channel with room for a fixed number of items, which works like
+    // channel but does not take a lock or allocate to pass an item.
+    //
+    // The items are kept in a ring of slots, as in Dmitry Vyukov's bounded
+    // MPMC queue. Each slot has a sequence number that tells whether it is
+    // ready to be written or read on the current lap around the ring, so
+    // threads that put only contend with each other over one counter, and
+    // threads that get over another. A thread that finds the channel full
+    // or empty tries again a few times and then sleeps until it is woken,
+    // as described in sleepers.hpp.
+    //
+    // put_n and get_n claim a run of slots at once, so a batch costs one
+    // update of the shared counter and at most one wakeup.
+    //
+    // A slot is claimed before the item is copied or moved into it. If that
+    // throws, the slot is left as a hole, which is ready for the next lap,
+    // and threads that get step over it. If moving an item out throws, the
+    // item is destroyed and its slot freed, since the threads that get have
+    // already gone past it, so it is lost, along with any other items that
+    // get_n had claimed.
+    template <class item> class bounded_channel : public ring_channel<bounded_ring<item>> {
+    public:
+        // the size is rounded up to a power of two.
+        explicit bounded_channel(uint32 size) : ring_channel<bounded_ring<item>>{std::make_shared<bounded_ring<item>>(size)} {}
+    };
+
+}
+
+#endif
@@ -3,30 +3,60 @@
 #ifndef DATA_TOOLS_CHANNEL
 #define DATA_TOOLS_CHANNEL
 
+#include <chrono>
 #include <list>
 #include <mutex>
 #include <condition_variable>
-#include <data/types.hpp>
+#include <stdexcept>
+#include <data/tools/sleepers.hpp>
 
 namespace data::tool {
     // a golang-like communication channel between different threads.
+    // A channel of size n holds at most n items, and put waits while it
+    // is full. A channel of size 0 has no limit. See bounded_channel for
+    // a faster channel with a fixed size.
+    //
+    // put_n and get_n pass a whole batch of items while taking the lock
+    // once. To put items without copying them, use put with an rvalue
+    // or put_n with std::move_iterator.
     template <class item> class channel {
         struct inner {
             std::list<item> Queue;
-            std::mutex M;
+            mutable std::mutex M;
             std::condition_variable Receive;
             std::condition_variable Send;
             uint32 Size; 
             bool Closed;
+            std::vector<signal*> Listeners;
             
             inner() : Size{0}, Closed{false} { }
             inner(uint32 n) : Size{n}, Closed{false} {}
             
+            // n items have been put, or the channel has been closed if n is 0.
+            void notify(size_t n) {
+                if (n == 1) Receive.notify_one();
+                else Receive.notify_all();
+                for (signal *s : Listeners) s->notify();
+            }
+            
+            void listen(signal &s) {
+                std::unique_lock<std::mutex> lock{M};
+                Listeners.push_back(&s);
+            }
+            
+            void ignore(signal &s) {
+                std::unique_lock<std::mutex> lock{M};
+                Listeners.erase(std::find(Listeners.begin(), Listeners.end(), &s));
+            }
+            
             
             void close();
             bool closed() const;
-            void put(const item &i);
+            template <typename X> void put(X &&x);
+            template <typename it> void put_n(it begin, it end);
             bool get(item &out, bool wait = true);
+            template <typename out> size_t get_n(out o, size_t max, bool wait = true);
+            bool get_until(item &out, std::chrono::steady_clock::time_point deadline);
         };
         
     public:
@@ -48,6 +78,16 @@ namespace data::tool {
                 Inner->put(i);
             }
             
+            void put(item &&i) {
+                Inner->put(std::move(i));
+            }
+            
+            // waits for room as needed. If the channel is closed partway
+            // through, the items before that point will have been put.
+            template <typename it> void put_n(it begin, it end) {
+                Inner->put_n(begin, end);
+            }
+            
             friend class channel;
         };
         
@@ -56,10 +96,38 @@ namespace data::tool {
             from() : Inner{} {}
             from(ptr<inner> i) : Inner{i} {}
         public:
+            using value_type = item;
+            
+            bool closed() const {
+                return Inner->closed();
+            }
+            
             bool get(item &out, bool wait = true) {
                 return Inner->get(out, wait);
             }
             
+            // waits for at least one item as get does and then takes up
+            // to max items without waiting. Returns the number got.
+            template <typename out> size_t get_n(out o, size_t max, bool wait = true) {
+                return Inner->get_n(o, max, wait);
+            }
+            
+            // false if nothing could be got before the timeout.
+            template <typename rep, typename period>
+            bool try_get_for(item &out, const std::chrono::duration<rep, period> &timeout) {
+                return Inner->get_until(out, std::chrono::steady_clock::now() + timeout);
+            }
+            
+            // s is notified whenever an item is put or the channel is
+            // closed, until ignore is called. This is used by select.
+            void listen(signal &s) {
+                Inner->listen(s);
+            }
+            
+            void ignore(signal &s) {
+                Inner->ignore(s);
+            }
+            
             friend class channel;
         };
         
@@ -90,10 +158,109 @@ namespace data::tool {
             To.put(i);
         }
         
+        void put(item &&i) {
+            To.put(std::move(i));
+        }
+        
+        template <typename it> void put_n(it begin, it end) {
+            To.put_n(begin, end);
+        }
+        
         bool get(item &out, bool wait = true) {
             return From.get(out, wait);
         }
+        
+        template <typename out> size_t get_n(out o, size_t max, bool wait = true) {
+            return From.get_n(o, max, wait);
+        }
+        
+        template <typename rep, typename period>
+        bool try_get_for(item &out, const std::chrono::duration<rep, period> &timeout) {
+            return From.try_get_for(out, timeout);
+        }
     };
+    
+    template <class item> 
+    void channel<item>::inner::close() {
+        std::unique_lock<std::mutex> lock{M};
+        Closed = true;
+        Send.notify_all();
+        notify(0);
+    }
+
+    template <class item> 
+    bool channel<item>::inner::closed() const {
+        std::unique_lock<std::mutex> lock{M};
+        return Closed;
+    }
+
+    template <class item> 
+    template <typename X>
+    void channel<item>::inner::put(X &&x) {
+        std::unique_lock<std::mutex> lock{M};
+        while (!Closed && Size != 0 && Queue.size() >= Size) Send.wait(lock);
+        if (Closed) throw std::logic_error("put to closed channel");
+        Queue.push_back(std::forward<X>(x));
+        notify(1);
+    }
+    
+    // the lock is only let go of while waiting for room. 
+    template <class item> 
+    template <typename it>
+    void channel<item>::inner::put_n(it begin, it end) {
+        std::unique_lock<std::mutex> lock{M};
+        while (begin != end) {
+            while (!Closed && Size != 0 && Queue.size() >= Size) Send.wait(lock);
+            if (Closed) throw std::logic_error("put to closed channel");
+            size_t n = 0;
+            for (; begin != end && (Size == 0 || Queue.size() < Size); ++begin, ++n) Queue.push_back(*begin);
+            notify(n);
+        }
+    }
+    
+    // items that were put before the channel was closed can still be got. 
+    template <class item> 
+    bool channel<item>::inner::get(item &out, bool wait) {
+        std::unique_lock<std::mutex> lock{M};
+        while (Queue.empty()) {
+            if (!wait || Closed) return false;
+            Receive.wait(lock);
+        }
+        out = std::move(Queue.front());
+        Queue.pop_front();
+        Send.notify_one();
+        return true;
+    }
+    
+    template <class item> 
+    template <typename out>
+    size_t channel<item>::inner::get_n(out o, size_t max, bool wait) {
+        if (max == 0) return 0;
+        std::unique_lock<std::mutex> lock{M};
+        while (Queue.empty()) {
+            if (!wait || Closed) return 0;
+            Receive.wait(lock);
+        }
+        size_t n = 0;
+        for (; n < max && !Queue.empty(); n++) {
+            *o++ = std::move(Queue.front());
+            Queue.pop_front();
+        }
+        if (n == 1) Send.notify_one();
+        else Send.notify_all();
+        return n;
+    }
+    
+    template <class item> 
+    bool channel<item>::inner::get_until(item &out, std::chrono::steady_clock::time_point deadline) {
+        std::unique_lock<std::mutex> lock{M};
+        if (!Receive.wait_until(lock, deadline, [this]() { return Closed || !Queue.empty(); })) return false;
+        if (Queue.empty()) return false;
+        out = std::move(Queue.front());
+        Queue.pop_front();
+        Send.notify_one();
+        return true;
+    }
 
 }
 
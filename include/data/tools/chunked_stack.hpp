@@ -0,0 +1,345 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef DATA_TOOLS_CHUNKED_STACK
+#define DATA_TOOLS_CHUNKED_STACK
+
+#include <atomic>
+#include <new>
+#include <ostream>
+#include <data/list.hpp>
+#include <data/functional/stack.hpp>
+#include <data/tools/allocation.hpp>
+
+namespace data::tool {
+
+    // an unrolled persistent stack which keeps up to K elements
+    // in each node, so that a scan touches one node per K
+    // elements rather than one per element.
+    //
+    // A chunked_stack is a node and the number of its elements
+    // which belong to this stack. A node records how many of
+    // its slots have been claimed. Pushing onto a stack which
+    // owns every claimed slot of an unfilled node claims the
+    // next slot without copying anything. Otherwise, a new node
+    // is made. Slots are claimed atomically, so stacks may be
+    // shared between threads as with linked_stack.
+    template <typename elem, size_t K = 16, typename alloc = allocation::shared>
+    class chunked_stack {
+        static_assert(K > 0, "chunks must hold at least one element");
+
+        struct chunk;
+        using next = typename alloc::template pointer<chunk>;
+
+        next Chunk;
+        uint32 Count;
+
+        chunked_stack(next n, uint32 count);
+
+    public:
+        chunked_stack();
+        chunked_stack(const elem& e, const chunked_stack& l);
+        chunked_stack(const elem& e);
+
+        template<typename ... P>
+        chunked_stack(const elem& a, const elem& b, P... p);
+
+        chunked_stack(const chunked_stack&) = default;
+        chunked_stack(chunked_stack&&);
+        chunked_stack& operator=(const chunked_stack&);
+        chunked_stack& operator=(chunked_stack&&);
+
+        // nodes which are not shared are destroyed in a loop.
+        ~chunked_stack();
+
+        // if the list is empty, then this function
+        // will dereference a nullptr. It is your
+        // responsibility to check.
+        const elem& first() const;
+
+        bool empty() const;
+
+        chunked_stack rest() const;
+
+        bool valid() const;
+
+        bool contains(const elem& x) const;
+
+        size_t size() const;
+
+        chunked_stack operator<<(const elem& x) const;
+        chunked_stack& operator<<=(const elem& x);
+
+        chunked_stack prepend(const elem& x) const;
+        chunked_stack prepend(chunked_stack l) const;
+
+        template <typename X, typename Y, typename ... P>
+        chunked_stack prepend(X x, Y y, P ... p) const;
+
+        chunked_stack operator^(chunked_stack l) const;
+
+        // skips whole chunks, so this takes O(n / K).
+        chunked_stack from(uint32 n) const;
+
+        const elem& operator[](uint32 n) const;
+
+        bool operator==(const chunked_stack& x) const;
+        bool operator!=(const chunked_stack& x) const;
+
+        // holds a pointer to the current element, so that a step 
+        // within a chunk is a decrement and a comparison. 
+        class const_iterator {
+            const chunk* Chunk;
+            const elem* Current;
+            
+            const_iterator(const chunk* c, uint32 count) : 
+                Chunk{c}, Current{c == nullptr ? nullptr : &c->at(count - 1)} {}
+            friend class chunked_stack;
+            
+        public:
+            using value_type = elem;
+            using difference_type = int;
+            using pointer = const elem*;
+            using reference = const elem&;
+            using iterator_category = std::forward_iterator_tag;
+            
+            const_iterator() : Chunk{nullptr}, Current{nullptr} {}
+            
+            const elem& operator*() const {
+                return *Current;
+            }
+            
+            const_iterator& operator++() {
+                if (Current != &Chunk->at(0)) --Current;
+                else *this = const_iterator{Chunk->Rest.Chunk.get(), Chunk->Rest.Count};
+                return *this;
+            }
+            
+            const_iterator operator++(int) {
+                const_iterator i = *this;
+                ++(*this);
+                return i;
+            }
+            
+            bool operator==(const const_iterator& i) const {
+                return Current == i.Current;
+            }
+            
+            bool operator!=(const const_iterator& i) const {
+                return Current != i.Current;
+            }
+        };
+        
+        using iterator = const_iterator;
+
+        const_iterator begin() const;
+        const_iterator end() const;
+    };
+    
+    template <typename elem, size_t K, typename alloc>
+    struct chunked_stack<elem, K, alloc>::chunk {
+        std::atomic<uint32> Claimed;
+        size_t Below;
+        chunked_stack Rest;
+        alignas(elem) unsigned char Slots[K * sizeof(elem)];
+
+        chunk(const elem& e, const chunked_stack& r) : Claimed{1}, Below{r.size()}, Rest{r} {
+            new (slot(0)) elem(e);
+        }
+
+        ~chunk() {
+            for (uint32 i = 0, n = Claimed.load(std::memory_order_relaxed); i < n; i++) slot(i)->~elem();
+        }
+
+        elem* slot(uint32 i) {
+            return reinterpret_cast<elem*>(Slots) + i;
+        }
+
+        const elem& at(uint32 i) const {
+            return reinterpret_cast<const elem*>(Slots)[i];
+        }
+    };
+    
+    template <typename elem, size_t K, typename alloc>
+    inline std::ostream& operator<<(std::ostream& o, const chunked_stack<elem, K, alloc>& x) {
+        return functional::stack::write(o << "stack", x);
+    }
+
+    template <typename elem, size_t K, typename alloc>
+    inline chunked_stack<elem, K, alloc>::chunked_stack(next n, uint32 count) : Chunk{n}, Count{count} {}
+
+    template <typename elem, size_t K, typename alloc>
+    inline chunked_stack<elem, K, alloc>::chunked_stack() : Chunk{nullptr}, Count{0} {}
+
+    template <typename elem, size_t K, typename alloc>
+    inline chunked_stack<elem, K, alloc>::chunked_stack(const elem& e, const chunked_stack& l) : chunked_stack{l.prepend(e)} {}
+
+    template <typename elem, size_t K, typename alloc>
+    inline chunked_stack<elem, K, alloc>::chunked_stack(const elem& e) : chunked_stack{e, chunked_stack{}} {}
+
+    template <typename elem, size_t K, typename alloc>
+    template <typename ... P>
+    inline chunked_stack<elem, K, alloc>::chunked_stack(const elem& a, const elem& b, P... p) :
+        chunked_stack{a, chunked_stack{b, chunked_stack{p...}}} {}
+
+    template <typename elem, size_t K, typename alloc>
+    inline chunked_stack<elem, K, alloc>::chunked_stack(chunked_stack&& l) : Chunk{std::move(l.Chunk)}, Count{l.Count} {
+        l.Count = 0;
+    }
+
+    template <typename elem, size_t K, typename alloc>
+    inline chunked_stack<elem, K, alloc>& chunked_stack<elem, K, alloc>::operator=(const chunked_stack& l) {
+        chunked_stack x{l};
+        std::swap(Chunk, x.Chunk);
+        std::swap(Count, x.Count);
+        return *this;
+    }
+
+    template <typename elem, size_t K, typename alloc>
+    inline chunked_stack<elem, K, alloc>& chunked_stack<elem, K, alloc>::operator=(chunked_stack&& l) {
+        std::swap(Chunk, l.Chunk);
+        std::swap(Count, l.Count);
+        return *this;
+    }
+
+    template <typename elem, size_t K, typename alloc>
+    chunked_stack<elem, K, alloc>::~chunked_stack() {
+        while (Chunk != nullptr && Chunk.use_count() == 1) {
+            next n = std::move(Chunk->Rest.Chunk);
+            Chunk = std::move(n);
+        }
+    }
+
+    template <typename elem, size_t K, typename alloc>
+    inline const elem& chunked_stack<elem, K, alloc>::first() const {
+        return Chunk->at(Count - 1);
+    }
+
+    template <typename elem, size_t K, typename alloc>
+    inline bool chunked_stack<elem, K, alloc>::empty() const {
+        return Chunk == nullptr;
+    }
+
+    template <typename elem, size_t K, typename alloc>
+    inline chunked_stack<elem, K, alloc> chunked_stack<elem, K, alloc>::rest() const {
+        if (empty()) return {};
+        if (Count > 1) return chunked_stack{Chunk, Count - 1};
+        return Chunk->Rest;
+    }
+
+    template <typename elem, size_t K, typename alloc>
+    bool chunked_stack<elem, K, alloc>::valid() const {
+        for (const elem& x : *this) if (!data::valid(x)) return false;
+        return true;
+    }
+
+    template <typename elem, size_t K, typename alloc>
+    bool chunked_stack<elem, K, alloc>::contains(const elem& x) const {
+        for (const elem& y : *this) if (y == x) return true;
+        return false;
+    }
+
+    template <typename elem, size_t K, typename alloc>
+    inline size_t chunked_stack<elem, K, alloc>::size() const {
+        if (empty()) return 0;
+        return Chunk->Below + Count;
+    }
+
+    // if no other stack has claimed the next slot in our chunk,
+    // we take it. If the copy throws, the slot is given back.
+    template <typename elem, size_t K, typename alloc>
+    chunked_stack<elem, K, alloc> chunked_stack<elem, K, alloc>::prepend(const elem& x) const {
+        if (Chunk != nullptr && Count < K) {
+            uint32 claimed = Count;
+            if (Chunk->Claimed.compare_exchange_strong(claimed, Count + 1, std::memory_order_acq_rel)) {
+                try {
+                    new (Chunk->slot(Count)) elem(x);
+                } catch (...) {
+                    Chunk->Claimed.store(Count, std::memory_order_release);
+                    throw;
+                }
+                return chunked_stack{Chunk, Count + 1};
+            }
+        }
+
+        return chunked_stack{alloc::template make<chunk>(x, *this), 1};
+    }
+
+    template <typename elem, size_t K, typename alloc>
+    inline chunked_stack<elem, K, alloc> chunked_stack<elem, K, alloc>::operator<<(const elem& x) const {
+        return prepend(x);
+    }
+
+    template <typename elem, size_t K, typename alloc>
+    inline chunked_stack<elem, K, alloc>& chunked_stack<elem, K, alloc>::operator<<=(const elem& x) {
+        return operator=(prepend(x));
+    }
+
+    template <typename elem, size_t K, typename alloc>
+    chunked_stack<elem, K, alloc> chunked_stack<elem, K, alloc>::prepend(chunked_stack l) const {
+        chunked_stack x = *this;
+        for (const elem& e : l) x = x << e;
+        return x;
+    }
+
+    template <typename elem, size_t K, typename alloc>
+    template <typename X, typename Y, typename ... P>
+    inline chunked_stack<elem, K, alloc> chunked_stack<elem, K, alloc>::prepend(X x, Y y, P ... p) const {
+        return prepend(x).prepend(y, p...);
+    }
+
+    template <typename elem, size_t K, typename alloc>
+    inline chunked_stack<elem, K, alloc> chunked_stack<elem, K, alloc>::operator^(chunked_stack l) const {
+        return prepend(l);
+    }
+
+    template <typename elem, size_t K, typename alloc>
+    chunked_stack<elem, K, alloc> chunked_stack<elem, K, alloc>::from(uint32 n) const {
+        if (n >= size()) return {};
+        const chunked_stack* x = this;
+        while (n >= x->Count) {
+            n -= x->Count;
+            x = &x->Chunk->Rest;
+        }
+        return chunked_stack{x->Chunk, x->Count - n};
+    }
+
+    template <typename elem, size_t K, typename alloc>
+    const elem& chunked_stack<elem, K, alloc>::operator[](uint32 n) const {
+        const chunked_stack* x = this;
+        while (n >= x->Count) {
+            n -= x->Count;
+            x = &x->Chunk->Rest;
+        }
+        return x->Chunk->at(x->Count - n - 1);
+    }
+
+    // stops early if the two stacks reach the same position in
+    // the same chunk.
+    template <typename elem, size_t K, typename alloc>
+    bool chunked_stack<elem, K, alloc>::operator==(const chunked_stack& x) const {
+        if (size() != x.size()) return false;
+        const_iterator b = x.begin();
+        for (const_iterator a = begin(); a != b; ++a, ++b) if (*a != *b) return false;
+        return true;
+    }
+
+    template <typename elem, size_t K, typename alloc>
+    inline bool chunked_stack<elem, K, alloc>::operator!=(const chunked_stack& x) const {
+        return !(*this == x);
+    }
+
+    template <typename elem, size_t K, typename alloc>
+    inline typename chunked_stack<elem, K, alloc>::const_iterator chunked_stack<elem, K, alloc>::begin() const {
+        return const_iterator{Chunk.get(), Count};
+    }
+
+    template <typename elem, size_t K, typename alloc>
+    inline typename chunked_stack<elem, K, alloc>::const_iterator chunked_stack<elem, K, alloc>::end() const {
+        return const_iterator{};
+    }
+
+}
+
+#endif
@@ -5,104 +5,260 @@
 #ifndef DATA_TOOLS_CYCLE
 #define DATA_TOOLS_CYCLE
 
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <vector>
 #include <data/tools.hpp>
-    
+
 namespace data::tool {
-    
+
+    // A sequence in which the last element is followed by the first.
+    //
+    // The elements are stored once in an array that is shared by every
+    // rotation of the cycle, along with the offset of the head, so
+    // rotations take O(1) and allocate nothing. When a cycle is made,
+    // its least rotation is found in one pass, and a hash of the least
+    // rotation is kept, so that cycles that differ are told apart in O(1).
     template <typename X>
     struct cycle {
-        list<X> Cycle;
-        
+
         bool valid() const {
-            return data::valid(Cycle);
-        }
-            
-        cycle() : Cycle{} {}
-        
-        explicit cycle(list<X> l) : Cycle{l} {}
-        
-        cycle(std::initializer_list<X> x) : Cycle{} {
-            for (X e : x) Cycle = Cycle << e;
-        }
-        
-        cycle& operator=(const cycle& c) {
-            Cycle = c.Cycle;
-            return *this;
-        }
-        
+            for (const X& x : *this) if (!data::valid(x)) return false;
+            return true;
+        }
+
+        cycle() : Elements{}, Offset{0}, Least{0}, Hash{0} {}
+
+        explicit cycle(std::vector<X> v) : cycle{} {
+            if (v.empty()) return;
+            Elements = std::make_shared<const std::vector<X>>(std::move(v));
+            Least = least_rotation(*Elements);
+            Hash = hash_from(*Elements, Least);
+        }
+
+        explicit cycle(list<X> l) : cycle{[&l]() {
+            std::vector<X> v{};
+            for (; !l.empty(); l = l.rest()) v.push_back(l.first());
+            return v;
+        }()} {}
+
+        cycle(std::initializer_list<X> x) : cycle{std::vector<X>(x)} {}
+
         size_t size() const {
-            return Cycle.size();
+            return Elements == nullptr ? 0 : Elements->size();
         }
-        
-        const X& head() const {
-            return Cycle.first();
+
+        bool empty() const {
+            return size() == 0;
         }
-        
-        cycle insert(const X& x) const {
-            return cycle{Cycle.insert(x)};
+
+        const X& head() const {
+            return operator[](0);
         }
-        
-        cycle reverse() const {
-            return cycle{data::reverse(Cycle)};
+
+        // the element n places after the head.
+        const X& operator[](size_t n) const {
+            return (*Elements)[(Offset + n) % Elements->size()];
         }
-        
+
+        cycle insert(const X& x) const;
+
+        cycle reverse() const;
+
         cycle rotate_left() const {
-            return cycle{functional::list::rotate_left(Cycle)};
+            return rotate_left(1);
         }
-        
+
         cycle rotate_right() const {
-            return cycle{functional::list::rotate_right(Cycle)};
+            return rotate_right(1);
         }
-        
+
         cycle rotate_left(uint32 n) const {
-            return cycle{functional::list::rotate_left(Cycle, n)};
+            if (empty()) return *this;
+            return cycle{Elements, (Offset + n) % size(), Least, Hash};
         }
-        
+
         cycle rotate_right(uint32 n) const {
-            return cycle{functional::list::rotate_right(Cycle, n)};
+            if (empty()) return *this;
+            return rotate_left(size() - n % size());
+        }
+
+        // the rotation that comes first in lexicographic order,
+        // which, if the elements are all different, is the
+        // one that begins with the least element.
+        cycle normalize() const {
+            return cycle{Elements, Least, Least, Hash};
         }
-        
+
+        // remove the head.
         cycle remove() const {
-            size_t s = size();
-            if (s == 0) return cycle{}; 
-            return {Cycle.rest()};
-        }
-        
-        cycle remove(uint32 n) const {
-            if (n == 0) return *this;
-            size_t s = size();
-            if (s > n) return cycle{}; 
-            return remove(n - 1).remove();
-        }
-        
+            return remove(1);
+        }
+
+        // remove n elements starting from the head.
+        cycle remove(uint32 n) const;
+
+        // the same for every rotation.
+        size_t hash() const {
+            return Hash;
+        }
+
         bool operator==(const cycle&) const;
-        
+
         bool operator!=(const cycle& c) const {
             return !operator==(c);
         }
+
+        // iterates once around the cycle starting from the head.
+        struct const_iterator {
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = X;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const X*;
+            using reference = const X&;
+
+            const cycle* Cycle;
+            size_t Index;
+
+            const X& operator*() const {
+                return (*Cycle)[Index];
+            }
+
+            const_iterator& operator++() {
+                Index++;
+                return *this;
+            }
+
+            const_iterator operator++(int) {
+                const_iterator i = *this;
+                Index++;
+                return i;
+            }
+
+            bool operator==(const const_iterator& i) const {
+                return Cycle == i.Cycle && Index == i.Index;
+            }
+
+            bool operator!=(const const_iterator& i) const {
+                return !operator==(i);
+            }
+        };
+
+        const_iterator begin() const {
+            return const_iterator{this, 0};
+        }
+
+        const_iterator end() const {
+            return const_iterator{this, size()};
+        }
+
+    private:
+        ptr<const std::vector<X>> Elements;
+
+        // the index of the head.
+        size_t Offset;
+
+        // the index of the head of the least rotation.
+        size_t Least;
+
+        size_t Hash;
+
+        cycle(ptr<const std::vector<X>> e, size_t offset, size_t least, size_t hash) :
+            Elements{e}, Offset{offset}, Least{least}, Hash{hash} {}
+
+        std::vector<X> from_head() const {
+            return std::vector<X>(begin(), end());
+        }
+
+        static size_t least_rotation(const std::vector<X>& v);
+        static size_t hash_from(const std::vector<X>& v, size_t least);
+
+        template <typename U> static auto hashable(int) -> decltype((void)std::hash<U>{}(std::declval<const U&>()), meta::yes());
+        template <typename> static meta::no hashable(...);
     };
-    
-    template <typename X> 
-    std::ostream& operator<<(std::ostream& o, const cycle<X> n) {
-        return o << "cycle" << n.Cycle;
+
+    template <typename X>
+    std::ostream& operator<<(std::ostream& o, const cycle<X>& n) {
+        o << "cycle{";
+        for (auto i = n.begin(); i != n.end(); ++i) o << (i == n.begin() ? "" : ", ") << *i;
+        return o << "}";
+    }
+
+    // if there is only one least element, that is where the least rotation
+    // starts. Otherwise it is found with Booth's algorithm.
+    template <typename X>
+    size_t cycle<X>::least_rotation(const std::vector<X>& v) {
+        size_t n = v.size();
+        size_t least = 0;
+        bool unique = true;
+        for (size_t i = 1; i < n; i++) {
+            if (v[i] < v[least]) {
+                least = i;
+                unique = true;
+            } else if (!(v[least] < v[i])) unique = false;
+        }
+        if (unique) return least;
+
+        std::vector<int64> f(2 * n, -1);
+        size_t k = 0;
+        for (size_t j = 1; j < 2 * n; j++) {
+            const X& x = v[j % n];
+            int64 i = f[j - k - 1];
+            while (i != -1 && x != v[(k + i + 1) % n]) {
+                if (x < v[(k + i + 1) % n]) k = j - i - 1;
+                i = f[i];
+            }
+            if (i == -1 && x != v[k % n]) {
+                if (x < v[k % n]) k = j;
+                f[j - k] = -1;
+            } else f[j - k] = i + 1;
+        }
+        return k % n;
+    }
+
+    template <typename X>
+    size_t cycle<X>::hash_from(const std::vector<X>& v, size_t least) {
+        size_t h = v.size();
+        if constexpr (std::is_same<decltype(hashable<X>(0)), meta::yes>::value)
+            for (size_t i = 0; i < v.size(); i++)
+                h ^= std::hash<X>{}(v[(least + i) % v.size()]) + 0x9e3779b97f4a7c15 + (h << 6) + (h >> 2);
+        return h;
+    }
+
+    // x goes at the end, just before the head.
+    template <typename X>
+    cycle<X> cycle<X>::insert(const X& x) const {
+        std::vector<X> v = from_head();
+        v.push_back(x);
+        return cycle{v};
     }
-    
+
+    template <typename X>
+    cycle<X> cycle<X>::reverse() const {
+        std::vector<X> v = from_head();
+        std::reverse(v.begin(), v.end());
+        return cycle{v};
+    }
+
+    template <typename X>
+    cycle<X> cycle<X>::remove(uint32 n) const {
+        if (n == 0) return *this;
+        if (n >= size()) return cycle{};
+        std::vector<X> v{};
+        for (size_t i = n; i < size(); i++) v.push_back(operator[](i));
+        return cycle{v};
+    }
+
     template <typename X>
     bool cycle<X>::operator==(const cycle& c) const {
         size_t s = size();
-        if (s != c.size()) return false;
-        
-        if (s == 0) return true;
-        
-        cycle x = c;
-        for (int i = 0; i < s; i++) {
-            if (Cycle == x.Cycle) return true;
-            x = x.rotate_left();
-        }
-        
-        return false;
+        if (s != c.size() || Hash != c.Hash) return false;
+        if (s == 0 || Elements == c.Elements) return true;
+        for (size_t i = 0; i < s; i++)
+            if ((*Elements)[(Least + i) % s] != (*c.Elements)[(c.Least + i) % s]) return false;
+        return true;
     }
 }
 
 #endif
-
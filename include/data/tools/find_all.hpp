@@ -0,0 +1,76 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef DATA_TOOLS_FIND_ALL
+#define DATA_TOOLS_FIND_ALL
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <data/tools/rb_map.hpp>
+#include <data/tools/hamt_map.hpp>
+#include <data/tools/merge_sort.hpp>
+#include <data/tools/thread_pool.hpp>
+
+// look up many keys in a map at once. The result has a pointer
+// to the value of each key in the order that the keys were given,
+// or nullptr for keys that are not in the map. Batches of more
+// than min_split keys are divided between threads of the shared
+// thread_pool. These are kept apart from the maps so that using
+// a map does not bring in the thread pool.
+namespace data::tool {
+
+    // the keys are sorted and found in one walk of the tree,
+    // which takes O(m log(n/m + 1)) for m keys.
+    template <typename K, typename V, typename I>
+    std::vector<const V*> find_all(const rb_map<K, V>& m, I begin, I end,
+        uint32 threads = std::thread::hardware_concurrency(),
+        size_t min_split = 1 << 12) {
+        // each key is paired with its position in the input.
+        using query = std::pair<K, size_t>;
+        std::vector<query> q{};
+        for (I i = begin; i != end; ++i) q.push_back(query{*i, q.size()});
+
+        std::vector<const V*> r(q.size(), nullptr);
+        if (q.empty() || m.empty()) return r;
+
+        size_t parts = threads < 2 ? 1 : std::max<size_t>(1, std::min<size_t>(threads, q.size() / std::max<size_t>(min_split, 1)));
+        if (parts < 2) std::sort(q.begin(), q.end());
+        else {
+            std::vector<query> buffer = q;
+            sorting::parallel_merge_sort(q.begin(), q.end(), buffer.begin(), parts, min_split);
+        }
+
+        size_t n = q.size();
+        thread_pool::shared().parallel_for(0, parts, [&m, &q, &r, n, parts](size_t p) {
+            m.find_sorted(q.cbegin() + n * p / parts, q.cbegin() + n * (p + 1) / parts, [](const query& x) -> const K& {
+                return x.first;
+            }, [&r](const query& x, const V& v) {
+                r[x.second] = &v;
+            });
+        }, 1);
+        return r;
+    }
+
+    // there is no order to exploit in a hash trie, so
+    // the keys are only divided between threads.
+    template <typename K, typename V, typename hash, typename I>
+    std::vector<const V*> find_all(const hamt_map<K, V, hash>& m, I begin, I end,
+        uint32 threads = std::thread::hardware_concurrency(),
+        size_t min_split = 1 << 12) {
+        std::vector<K> keys(begin, end);
+        std::vector<const V*> r(keys.size(), nullptr);
+        size_t n = keys.size();
+        size_t parts = threads < 2 ? 1 : std::max<size_t>(1, std::min<size_t>(threads, n / std::max<size_t>(min_split, 1)));
+
+        thread_pool::shared().parallel_for(0, parts, [&m, &keys, &r, n, parts](size_t p) {
+            for (size_t i = n * p / parts; i < n * (p + 1) / parts; i++) r[i] = m.find(keys[i]);
+        }, 1);
+        return r;
+    }
+
+}
+
+#endif
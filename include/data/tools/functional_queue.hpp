@@ -10,6 +10,47 @@
     
 namespace data::tool {
     
+    // iterates over a queue by taking rest(), so that nothing 
+    // is built beyond what the queue itself would build. 
+    template <typename queue, typename element>
+    class queue_iterator {
+        queue Queue;
+        
+    public:
+        using value_type = element;
+        using difference_type = int;
+        using pointer = const element*;
+        using reference = const element&;
+        using iterator_category = std::forward_iterator_tag;
+        
+        queue_iterator() : Queue{} {}
+        queue_iterator(const queue& q) : Queue{q} {}
+        
+        const element& operator*() const {
+            return Queue.first();
+        }
+        
+        queue_iterator& operator++() {
+            Queue = Queue.rest();
+            return *this;
+        }
+        
+        queue_iterator operator++(int) {
+            queue_iterator i = *this;
+            ++(*this);
+            return i;
+        }
+        
+        // only iterators over the same queue can be compared. 
+        bool operator==(const queue_iterator& i) const {
+            return Queue.size() == i.Queue.size();
+        }
+        
+        bool operator!=(const queue_iterator& i) const {
+            return !(*this == i);
+        }
+    };
+    
     // functional queue based on Milewski's implementation of Okasaki. 
     // it is built out of any stack. 
     template <typename stack, 
@@ -54,14 +95,14 @@ namespace data::tool {
         template <typename A, typename ... M>
         static functional_queue make(const A x, M... m);
         
-        using const_iterator = typename stack::const_iterator;
+        using const_iterator = queue_iterator<functional_queue, element>;
         
-        const const_iterator begin() const {
-            return values().begin();
+        const_iterator begin() const {
+            return const_iterator{*this};
         }
         
-        const const_iterator end() const {
-            return values().end();
+        const_iterator end() const {
+            return const_iterator{};
         }
         
     private:
@@ -190,9 +231,12 @@ namespace data::tool {
     bool functional_queue<stack, element>::operator==(const functional_queue& q) const {
         if (this == &q) return true;
         if (size() != q.size()) return false;
-        if (size() == 0) return true;
-        if (first() != q.first()) return false;
-        return rest() == q.rest();
+        const_iterator b = q.begin();
+        for (const element& x : *this) {
+            if (x != *b) return false;
+            ++b;
+        }
+        return true;
     }
     
     template <typename stack, typename element>
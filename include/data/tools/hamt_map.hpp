@@ -0,0 +1,917 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef DATA_TOOLS_HAMT_MAP
+#define DATA_TOOLS_HAMT_MAP
+
+#include <atomic>
+#include <functional>
+#include <new>
+#include <vector>
+#include <data/map.hpp>
+#include <data/tools/linked_stack.hpp>
+#include <data/tools/map_set.hpp>
+
+namespace data::tool {
+
+    // a persistent hash array mapped trie. Lookup, insert and
+    // remove take O(log_32 n), which is at most 13 steps, and
+    // keys are compared only once they are found by their hash.
+    // Entries are not kept in any order.
+    //
+    // This is the form of the trie called CHAMP. Each node has
+    // one bitmap for the entries it holds directly and another
+    // for its children, and a child always holds at least two
+    // entries. Thus a given set of entries has only one form,
+    // which lets == skip subtrees which are shared.
+    //
+    // Nodes are allocated with their entries and children in
+    // one block and counted atomically, so maps may be shared
+    // between threads as with rb_map.
+    //
+    // hash is any function object which hashes keys to a size_t.
+    // Its result is mixed before it is used, so a weak hash such
+    // as the identity is fine.
+    template <typename K, typename V, typename hash = std::hash<K>>
+    class hamt_map {
+    public:
+        using entry = data::entry<K, V>;
+        class transient;
+
+    private:
+        struct node;
+
+        node* Root;
+        size_t Size;
+
+        hamt_map(node* root, size_t size) : Root{root}, Size{size} {}
+
+        static uint64 hash_of(const K& k);
+
+    public:
+        hamt_map() : Root{nullptr}, Size{0} {}
+        hamt_map(const K& k, const V& v) : hamt_map{hamt_map{}.insert(k, v)} {}
+        hamt_map(std::initializer_list<std::pair<K, V>> init);
+
+        hamt_map(const hamt_map&);
+        hamt_map(hamt_map&&);
+        hamt_map& operator=(const hamt_map&);
+        hamt_map& operator=(hamt_map&&);
+        ~hamt_map();
+
+        // build a map from a range of entries with a transient.
+        template <typename I>
+        static hamt_map from(I begin, I end);
+
+        bool empty() const;
+        size_t size() const;
+        bool valid() const;
+
+        // nullptr if k is not in the map.
+        const V* find(const K& k) const;
+
+        // a default value if k is not in the map.
+        const V& operator[](const K& k) const;
+
+        bool contains(const K& k) const;
+        bool contains(const entry& e) const;
+
+        hamt_map insert(const K& k, const V& v) const;
+        hamt_map insert(const entry& e) const;
+        hamt_map operator<<(const entry& e) const;
+
+        hamt_map remove(const K& k) const;
+        hamt_map remove(const entry& e) const;
+
+        // all entries of both maps. Where both maps have a key,
+        // the value from m is kept.
+        hamt_map insert(const hamt_map& m) const;
+
+        // entries whose keys are also in m.
+        hamt_map intersect(const hamt_map& m) const;
+
+        // entries whose keys are not in m.
+        hamt_map remove(const hamt_map& m) const;
+
+        linked_stack<K> keys() const;
+        linked_stack<entry> values() const;
+
+        bool operator==(const hamt_map& m) const;
+        bool operator!=(const hamt_map& m) const;
+
+        // the trie is at most 13 levels deep, so the path to the
+        // current entry is kept in the iterator.
+        class const_iterator {
+            struct frame {
+                const node* Node;
+                uint32 Index;
+            };
+
+            frame Path[14];
+            uint32 Depth;
+            const entry* Current;
+
+            explicit const_iterator(const node* root);
+            void advance();
+            friend class hamt_map;
+
+        public:
+            using value_type = entry;
+            using difference_type = int;
+            using pointer = const entry*;
+            using reference = const entry&;
+            using iterator_category = std::forward_iterator_tag;
+
+            const_iterator() : Depth{0}, Current{nullptr} {}
+
+            const entry& operator*() const {
+                return *Current;
+            }
+
+            const entry* operator->() const {
+                return Current;
+            }
+
+            const_iterator& operator++() {
+                advance();
+                return *this;
+            }
+
+            const_iterator operator++(int) {
+                const_iterator i = *this;
+                advance();
+                return i;
+            }
+
+            bool operator==(const const_iterator& i) const {
+                return Current == i.Current;
+            }
+
+            bool operator!=(const const_iterator& i) const {
+                return Current != i.Current;
+            }
+        };
+
+        const_iterator begin() const;
+        const_iterator end() const;
+    };
+
+    // a map which is changed in place. Nodes are changed in place
+    // whenever nothing else refers to them, so that a batch of
+    // changes copies each node at most once. A transient may be
+    // made from a hamt_map and turned back into one in O(1); the
+    // nodes that they share are copied before they are changed.
+    template <typename K, typename V, typename hash>
+    class hamt_map<K, V, hash>::transient {
+        node* Root;
+        size_t Size;
+
+    public:
+        transient() : Root{nullptr}, Size{0} {}
+        explicit transient(const hamt_map& m);
+        transient(const transient&) = delete;
+        transient& operator=(const transient&) = delete;
+        ~transient();
+
+        size_t size() const;
+        const V* find(const K& k) const;
+        bool contains(const K& k) const;
+
+        transient& insert(const K& k, const V& v);
+        transient& insert(const entry& e);
+        transient& remove(const K& k);
+
+        // the current contents as a persistent map. The
+        // transient may still be used afterwards.
+        hamt_map persistent() const;
+    };
+
+    // a set implemented as a hamt_map. 
+    template <typename K, typename hash = std::hash<K>>
+    using hamt_set = map_set<hamt_map<K, unit, hash>>;
+
+    template <typename K, typename V, typename hash>
+    inline std::ostream& operator<<(std::ostream& o, const hamt_map<K, V, hash>& x) {
+        return functional::stack::write(o << "map", x.values());
+    }
+
+    template <typename K, typename V, typename hash>
+    struct hamt_map<K, V, hash>::node {
+        std::atomic<uint32> Count;
+
+        // for a collision node, DataMap is the number of entries
+        // and NodeMap is zero.
+        uint32 DataMap;
+        uint32 NodeMap;
+        bool Collision;
+
+        static constexpr uint32 bits = 5;
+
+        static uint32 popcount(uint32 x) {
+        #if defined(__GNUC__) || defined(__clang__)
+            return static_cast<uint32>(__builtin_popcount(x));
+        #else
+            uint32 n = 0;
+            for (; x != 0; x &= x - 1) n++;
+            return n;
+        #endif
+        }
+
+        static uint32 bit(uint64 h, uint32 shift) {
+            return uint32{1} << ((h >> shift) & 31);
+        }
+
+        static constexpr size_t round_up(size_t n, size_t a) {
+            return (n + a - 1) / a * a;
+        }
+
+        static size_t entries_offset() {
+            return round_up(sizeof(node), alignof(entry));
+        }
+
+        static size_t children_offset(uint32 entries) {
+            return round_up(entries_offset() + entries * sizeof(entry), alignof(node*));
+        }
+
+        uint32 entries() const {
+            return Collision ? DataMap : popcount(DataMap);
+        }
+
+        uint32 children() const {
+            return popcount(NodeMap);
+        }
+
+        uint32 entry_index(uint32 b) const {
+            return popcount(DataMap & (b - 1));
+        }
+
+        uint32 child_index(uint32 b) const {
+            return popcount(NodeMap & (b - 1));
+        }
+
+        entry* data() {
+            return reinterpret_cast<entry*>(reinterpret_cast<char*>(this) + entries_offset());
+        }
+
+        const entry* data() const {
+            return reinterpret_cast<const entry*>(reinterpret_cast<const char*>(this) + entries_offset());
+        }
+
+        node** nodes() {
+            return reinterpret_cast<node**>(reinterpret_cast<char*>(this) + children_offset(entries()));
+        }
+
+        node* const* nodes() const {
+            return reinterpret_cast<node* const*>(reinterpret_cast<const char*>(this) + children_offset(entries()));
+        }
+
+        bool unique() const {
+            return Count.load(std::memory_order_acquire) == 1;
+        }
+
+        // a single entry with no children, which a parent takes
+        // in place of the node.
+        bool singleton() const {
+            return NodeMap == 0 && entries() == 1;
+        }
+
+        static node* acquire(node* n) {
+            if (n != nullptr) n->Count.fetch_add(1, std::memory_order_relaxed);
+            return n;
+        }
+
+        // the trie is no more than 13 deep, so this recursion is
+        // bounded.
+        static void release(node* n) {
+            if (n == nullptr || n->Count.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+            uint32 e = n->entries();
+            uint32 c = n->children();
+            for (uint32 i = 0; i < e; i++) n->data()[i].~entry();
+            for (uint32 i = 0; i < c; i++) release(n->nodes()[i]);
+            n->~node();
+            ::operator delete(static_cast<void*>(n));
+        }
+
+        node(uint32 data_map, uint32 node_map, bool collision) :
+            Count{1}, DataMap{data_map}, NodeMap{node_map}, Collision{collision} {}
+
+        // entry_at(i) gives the i'th entry and child_at(i) the
+        // i'th child, which is acquired by the new node.
+        template <typename E, typename C>
+        static node* make(uint32 data_map, uint32 node_map, bool collision, E entry_at, C child_at) {
+            uint32 e = collision ? data_map : popcount(data_map);
+            uint32 c = popcount(node_map);
+            void* m = ::operator new(children_offset(e) + c * sizeof(node*));
+            node* n = new (m) node{data_map, node_map, collision};
+            uint32 i = 0;
+            try {
+                for (; i < e; i++) new (n->data() + i) entry(entry_at(i));
+            } catch (...) {
+                while (i > 0) n->data()[--i].~entry();
+                n->~node();
+                ::operator delete(m);
+                throw;
+            }
+            for (uint32 j = 0; j < c; j++) n->nodes()[j] = acquire(child_at(j));
+            return n;
+        }
+
+        static node* none(uint32) {
+            return nullptr;
+        }
+
+        static node* single(const entry& x, uint64 h) {
+            return make(bit(h, 0), 0, false, [&x](uint32) -> const entry& {
+                return x;
+            }, none);
+        }
+
+        static bool same(const entry& a, const entry& b) {
+            return a.Key == b.Key && a.Value == b.Value;
+        }
+
+        static const V* find(const node* n, const K& k, uint64 h);
+
+        // a subtree holding two entries whose hashes agree below
+        // shift.
+        static node* pair(const entry& a, uint64 ha, const entry& b, uint64 hb, uint32 shift);
+
+        // these make a changed copy of n.
+        node* with_value(uint32 i, const entry& x) const;
+        node* with_entry(uint32 b, const entry& x) const;
+        node* without_entry(uint32 b) const;
+        node* with_child(uint32 b, node* x) const;
+        node* entry_to_child(uint32 b, node* x) const;
+        node* child_to_entry(uint32 b, const entry& x) const;
+        node* with_collision(const entry& x) const;
+        node* without_collision(uint32 i) const;
+
+        // persistent changes, which return nullptr if nothing
+        // changes.
+        static node* inserted(const node* n, const entry& x, uint64 h, uint32 shift, bool& added);
+        static node* removed(const node* n, const K& k, uint64 h, uint32 shift);
+
+        // changes which take a reference to n and return one to
+        // the node which replaces it. Nodes which are unique are
+        // changed in place.
+        static node* insert_in_place(node* n, const entry& x, uint64 h, uint32 shift, bool& added);
+        static node* remove_in_place(node* n, const K& k, uint64 h, uint32 shift, bool& removed);
+
+        static bool equal(const node* a, const node* b);
+    };
+
+    template <typename K, typename V, typename hash>
+    inline uint64 hamt_map<K, V, hash>::hash_of(const K& k) {
+        uint64 h = static_cast<uint64>(hash{}(k));
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    template <typename K, typename V, typename hash>
+    typename hamt_map<K, V, hash>::node *hamt_map<K, V, hash>::node::pair(
+        const entry& a, uint64 ha, const entry& b, uint64 hb, uint32 shift) {
+        if (shift >= 64) return make(2, 0, true, [&a, &b](uint32 i) -> const entry& {
+            return i == 0 ? a : b;
+        }, none);
+
+        uint32 ba = bit(ha, shift);
+        uint32 bb = bit(hb, shift);
+        if (ba == bb) {
+            node* child = pair(a, ha, b, hb, shift + bits);
+            node* n = make(0, ba, false, [&a](uint32) -> const entry& {
+                return a;
+            }, [child](uint32) -> node* {
+                return child;
+            });
+            release(child);
+            return n;
+        }
+
+        return make(ba | bb, 0, false, [&a, &b, ba, bb](uint32 i) -> const entry& {
+            return (i == 0) == (ba < bb) ? a : b;
+        }, none);
+    }
+
+    template <typename K, typename V, typename hash>
+    typename hamt_map<K, V, hash>::node *hamt_map<K, V, hash>::node::with_value(uint32 i, const entry& x) const {
+        return make(DataMap, NodeMap, Collision, [this, i, &x](uint32 j) -> const entry& {
+            return j == i ? x : data()[j];
+        }, [this](uint32 j) -> node* {
+            return nodes()[j];
+        });
+    }
+
+    template <typename K, typename V, typename hash>
+    typename hamt_map<K, V, hash>::node *hamt_map<K, V, hash>::node::with_entry(uint32 b, const entry& x) const {
+        uint32 i = entry_index(b);
+        return make(DataMap | b, NodeMap, false, [this, i, &x](uint32 j) -> const entry& {
+            return j < i ? data()[j] : j == i ? x : data()[j - 1];
+        }, [this](uint32 j) -> node* {
+            return nodes()[j];
+        });
+    }
+
+    template <typename K, typename V, typename hash>
+    typename hamt_map<K, V, hash>::node *hamt_map<K, V, hash>::node::without_entry(uint32 b) const {
+        uint32 i = entry_index(b);
+        return make(DataMap & ~b, NodeMap, false, [this, i](uint32 j) -> const entry& {
+            return data()[j < i ? j : j + 1];
+        }, [this](uint32 j) -> node* {
+            return nodes()[j];
+        });
+    }
+
+    template <typename K, typename V, typename hash>
+    typename hamt_map<K, V, hash>::node *hamt_map<K, V, hash>::node::with_child(uint32 b, node* x) const {
+        uint32 i = child_index(b);
+        return make(DataMap, NodeMap, false, [this](uint32 j) -> const entry& {
+            return data()[j];
+        }, [this, i, x](uint32 j) -> node* {
+            return j == i ? x : nodes()[j];
+        });
+    }
+
+    template <typename K, typename V, typename hash>
+    typename hamt_map<K, V, hash>::node *hamt_map<K, V, hash>::node::entry_to_child(uint32 b, node* x) const {
+        uint32 i = entry_index(b);
+        uint32 k = child_index(b);
+        return make(DataMap & ~b, NodeMap | b, false, [this, i](uint32 j) -> const entry& {
+            return data()[j < i ? j : j + 1];
+        }, [this, k, x](uint32 j) -> node* {
+            return j < k ? nodes()[j] : j == k ? x : nodes()[j - 1];
+        });
+    }
+
+    template <typename K, typename V, typename hash>
+    typename hamt_map<K, V, hash>::node *hamt_map<K, V, hash>::node::child_to_entry(uint32 b, const entry& x) const {
+        uint32 i = entry_index(b);
+        uint32 k = child_index(b);
+        return make(DataMap | b, NodeMap & ~b, false, [this, i, &x](uint32 j) -> const entry& {
+            return j < i ? data()[j] : j == i ? x : data()[j - 1];
+        }, [this, k](uint32 j) -> node* {
+            return nodes()[j < k ? j : j + 1];
+        });
+    }
+
+    template <typename K, typename V, typename hash>
+    typename hamt_map<K, V, hash>::node *hamt_map<K, V, hash>::node::with_collision(const entry& x) const {
+        uint32 e = DataMap;
+        return make(e + 1, 0, true, [this, e, &x](uint32 j) -> const entry& {
+            return j < e ? data()[j] : x;
+        }, none);
+    }
+
+    template <typename K, typename V, typename hash>
+    typename hamt_map<K, V, hash>::node *hamt_map<K, V, hash>::node::without_collision(uint32 i) const {
+        return make(DataMap - 1, 0, true, [this, i](uint32 j) -> const entry& {
+            return data()[j < i ? j : j + 1];
+        }, none);
+    }
+
+    template <typename K, typename V, typename hash>
+    typename hamt_map<K, V, hash>::node *hamt_map<K, V, hash>::node::inserted(
+        const node* n, const entry& x, uint64 h, uint32 shift, bool& added) {
+        if (n->Collision) {
+            for (uint32 i = 0; i < n->DataMap; i++) if (n->data()[i].Key == x.Key) {
+                if (n->data()[i].Value == x.Value) return nullptr;
+                return n->with_value(i, x);
+            }
+            added = true;
+            return n->with_collision(x);
+        }
+
+        uint32 b = bit(h, shift);
+        if (n->DataMap & b) {
+            uint32 i = n->entry_index(b);
+            const entry& y = n->data()[i];
+            if (y.Key == x.Key) {
+                if (y.Value == x.Value) return nullptr;
+                return n->with_value(i, x);
+            }
+
+            added = true;
+            node* child = pair(y, hash_of(y.Key), x, h, shift + bits);
+            node* r = n->entry_to_child(b, child);
+            release(child);
+            return r;
+        }
+
+        if (n->NodeMap & b) {
+            node* child = inserted(n->nodes()[n->child_index(b)], x, h, shift + bits, added);
+            if (child == nullptr) return nullptr;
+            node* r = n->with_child(b, child);
+            release(child);
+            return r;
+        }
+
+        added = true;
+        return n->with_entry(b, x);
+    }
+
+    template <typename K, typename V, typename hash>
+    typename hamt_map<K, V, hash>::node *hamt_map<K, V, hash>::node::removed(
+        const node* n, const K& k, uint64 h, uint32 shift) {
+        if (n->Collision) {
+            for (uint32 i = 0; i < n->DataMap; i++)
+                if (n->data()[i].Key == k) return n->without_collision(i);
+            return nullptr;
+        }
+
+        uint32 b = bit(h, shift);
+        if (n->DataMap & b) {
+            if (n->data()[n->entry_index(b)].Key != k) return nullptr;
+            return n->without_entry(b);
+        }
+
+        if (n->NodeMap & b) {
+            node* child = removed(n->nodes()[n->child_index(b)], k, h, shift + bits);
+            if (child == nullptr) return nullptr;
+            node* r = child->singleton() ? n->child_to_entry(b, child->data()[0]) : n->with_child(b, child);
+            release(child);
+            return r;
+        }
+
+        return nullptr;
+    }
+
+    template <typename K, typename V, typename hash>
+    typename hamt_map<K, V, hash>::node *hamt_map<K, V, hash>::node::insert_in_place(
+        node* n, const entry& x, uint64 h, uint32 shift, bool& added) {
+        if (!n->unique()) {
+            node* r = inserted(n, x, h, shift, added);
+            if (r == nullptr) return n;
+            release(n);
+            return r;
+        }
+
+        if (!n->Collision) {
+            uint32 b = bit(h, shift);
+            if (n->DataMap & b) {
+                entry& y = n->data()[n->entry_index(b)];
+                if (y.Key == x.Key) {
+                    y.Value = x.Value;
+                    return n;
+                }
+            } else if (n->NodeMap & b) {
+                node*& child = n->nodes()[n->child_index(b)];
+                child = insert_in_place(child, x, h, shift + bits, added);
+                return n;
+            }
+        } else for (uint32 i = 0; i < n->DataMap; i++) if (n->data()[i].Key == x.Key) {
+            n->data()[i].Value = x.Value;
+            return n;
+        }
+
+        // the shape of the node changes, so it is copied.
+        node* r = inserted(n, x, h, shift, added);
+        release(n);
+        return r;
+    }
+
+    template <typename K, typename V, typename hash>
+    typename hamt_map<K, V, hash>::node *hamt_map<K, V, hash>::node::remove_in_place(
+        node* n, const K& k, uint64 h, uint32 shift, bool& removed_any) {
+        if (n->unique() && !n->Collision) {
+            uint32 b = bit(h, shift);
+            if (n->NodeMap & b) {
+                node*& child = n->nodes()[n->child_index(b)];
+                child = remove_in_place(child, k, h, shift + bits, removed_any);
+                if (!child->singleton()) return n;
+                node* r = n->child_to_entry(b, child->data()[0]);
+                release(n);
+                return r;
+            }
+        }
+
+        node* r = removed(n, k, h, shift);
+        if (r == nullptr) return n;
+        removed_any = true;
+        release(n);
+        return r;
+    }
+
+    // since the form of the trie is determined by its entries,
+    // two tries are equal if they have the same form, except that
+    // entries which collide may be in any order.
+    template <typename K, typename V, typename hash>
+    bool hamt_map<K, V, hash>::node::equal(const node* a, const node* b) {
+        if (a == b) return true;
+        if (a == nullptr || b == nullptr) return false;
+        if (a->Collision != b->Collision || a->DataMap != b->DataMap || a->NodeMap != b->NodeMap) return false;
+
+        uint32 e = a->entries();
+        if (a->Collision) {
+            for (uint32 i = 0; i < e; i++) {
+                bool found = false;
+                for (uint32 j = 0; j < e; j++) if (same(a->data()[i], b->data()[j])) {
+                    found = true;
+                    break;
+                }
+                if (!found) return false;
+            }
+            return true;
+        }
+
+        for (uint32 i = 0; i < e; i++) if (!same(a->data()[i], b->data()[i])) return false;
+        for (uint32 i = 0, c = a->children(); i < c; i++) if (!equal(a->nodes()[i], b->nodes()[i])) return false;
+        return true;
+    }
+
+    template <typename K, typename V, typename hash>
+    hamt_map<K, V, hash>::hamt_map(std::initializer_list<std::pair<K, V>> init) : hamt_map{} {
+        transient t{};
+        for (const auto& p : init) t.insert(p.first, p.second);
+        *this = t.persistent();
+    }
+
+    template <typename K, typename V, typename hash>
+    inline hamt_map<K, V, hash>::hamt_map(const hamt_map& m) : Root{node::acquire(m.Root)}, Size{m.Size} {}
+
+    template <typename K, typename V, typename hash>
+    inline hamt_map<K, V, hash>::hamt_map(hamt_map&& m) : Root{m.Root}, Size{m.Size} {
+        m.Root = nullptr;
+        m.Size = 0;
+    }
+
+    template <typename K, typename V, typename hash>
+    inline hamt_map<K, V, hash>& hamt_map<K, V, hash>::operator=(const hamt_map& m) {
+        hamt_map x{m};
+        std::swap(Root, x.Root);
+        std::swap(Size, x.Size);
+        return *this;
+    }
+
+    template <typename K, typename V, typename hash>
+    inline hamt_map<K, V, hash>& hamt_map<K, V, hash>::operator=(hamt_map&& m) {
+        std::swap(Root, m.Root);
+        std::swap(Size, m.Size);
+        return *this;
+    }
+
+    template <typename K, typename V, typename hash>
+    inline hamt_map<K, V, hash>::~hamt_map() {
+        node::release(Root);
+    }
+
+    template <typename K, typename V, typename hash>
+    template <typename I>
+    hamt_map<K, V, hash> hamt_map<K, V, hash>::from(I begin, I end) {
+        transient t{};
+        for (I i = begin; i != end; ++i) t.insert(*i);
+        return t.persistent();
+    }
+
+    template <typename K, typename V, typename hash>
+    inline bool hamt_map<K, V, hash>::empty() const {
+        return Size == 0;
+    }
+
+    template <typename K, typename V, typename hash>
+    inline size_t hamt_map<K, V, hash>::size() const {
+        return Size;
+    }
+
+    template <typename K, typename V, typename hash>
+    bool hamt_map<K, V, hash>::valid() const {
+        for (const entry& e : *this) if (!e.valid()) return false;
+        return true;
+    }
+
+    template <typename K, typename V, typename hash>
+    inline const V* hamt_map<K, V, hash>::find(const K& k) const {
+        return node::find(Root, k, hash_of(k));
+    }
+
+    template <typename K, typename V, typename hash>
+    const V* hamt_map<K, V, hash>::node::find(const node* n, const K& k, uint64 h) {
+        for (uint32 shift = 0; n != nullptr; shift += node::bits) {
+            if (n->Collision) {
+                for (uint32 i = 0; i < n->DataMap; i++) if (n->data()[i].Key == k) return &n->data()[i].Value;
+                return nullptr;
+            }
+
+            uint32 b = node::bit(h, shift);
+            if (n->DataMap & b) {
+                const entry& e = n->data()[n->entry_index(b)];
+                return e.Key == k ? &e.Value : nullptr;
+            }
+
+            if (!(n->NodeMap & b)) return nullptr;
+            n = n->nodes()[n->child_index(b)];
+        }
+        return nullptr;
+    }
+
+    template <typename K, typename V, typename hash>
+    inline const V& hamt_map<K, V, hash>::operator[](const K& k) const {
+        static V Default{};
+        const V* v = find(k);
+        return v == nullptr ? Default : *v;
+    }
+
+    template <typename K, typename V, typename hash>
+    inline bool hamt_map<K, V, hash>::contains(const K& k) const {
+        return find(k) != nullptr;
+    }
+
+    template <typename K, typename V, typename hash>
+    inline bool hamt_map<K, V, hash>::contains(const entry& e) const {
+        const V* v = find(e.Key);
+        return v != nullptr && *v == e.Value;
+    }
+
+    template <typename K, typename V, typename hash>
+    hamt_map<K, V, hash> hamt_map<K, V, hash>::insert(const K& k, const V& v) const {
+        entry x{k, v};
+        uint64 h = hash_of(k);
+        if (Root == nullptr) return hamt_map{node::single(x, h), 1};
+        bool added = false;
+        node* r = node::inserted(Root, x, h, 0, added);
+        if (r == nullptr) return *this;
+        return hamt_map{r, added ? Size + 1 : Size};
+    }
+
+    template <typename K, typename V, typename hash>
+    inline hamt_map<K, V, hash> hamt_map<K, V, hash>::insert(const entry& e) const {
+        return insert(e.Key, e.Value);
+    }
+
+    template <typename K, typename V, typename hash>
+    inline hamt_map<K, V, hash> hamt_map<K, V, hash>::operator<<(const entry& e) const {
+        return insert(e.Key, e.Value);
+    }
+
+    template <typename K, typename V, typename hash>
+    hamt_map<K, V, hash> hamt_map<K, V, hash>::remove(const K& k) const {
+        if (Root == nullptr) return *this;
+        node* r = node::removed(Root, k, hash_of(k), 0);
+        if (r == nullptr) return *this;
+        if (Size == 1) {
+            node::release(r);
+            return hamt_map{};
+        }
+        return hamt_map{r, Size - 1};
+    }
+
+    template <typename K, typename V, typename hash>
+    inline hamt_map<K, V, hash> hamt_map<K, V, hash>::remove(const entry& e) const {
+        return contains(e) ? remove(e.Key) : *this;
+    }
+
+    template <typename K, typename V, typename hash>
+    hamt_map<K, V, hash> hamt_map<K, V, hash>::insert(const hamt_map& m) const {
+        if (m.Size > Size) {
+            transient t{m};
+            for (const entry& e : *this) if (!m.contains(e.Key)) t.insert(e);
+            return t.persistent();
+        }
+
+        transient t{*this};
+        for (const entry& e : m) t.insert(e);
+        return t.persistent();
+    }
+
+    template <typename K, typename V, typename hash>
+    hamt_map<K, V, hash> hamt_map<K, V, hash>::intersect(const hamt_map& m) const {
+        transient t{*this};
+        for (const entry& e : *this) if (!m.contains(e.Key)) t.remove(e.Key);
+        return t.persistent();
+    }
+
+    template <typename K, typename V, typename hash>
+    hamt_map<K, V, hash> hamt_map<K, V, hash>::remove(const hamt_map& m) const {
+        transient t{*this};
+        for (const entry& e : m) t.remove(e.Key);
+        return t.persistent();
+    }
+
+    template <typename K, typename V, typename hash>
+    linked_stack<K> hamt_map<K, V, hash>::keys() const {
+        linked_stack<K> x{};
+        for (const entry& e : *this) x = x << e.Key;
+        return x;
+    }
+
+    template <typename K, typename V, typename hash>
+    linked_stack<typename hamt_map<K, V, hash>::entry> hamt_map<K, V, hash>::values() const {
+        linked_stack<entry> x{};
+        for (const entry& e : *this) x = x << e;
+        return x;
+    }
+
+    template <typename K, typename V, typename hash>
+    inline bool hamt_map<K, V, hash>::operator==(const hamt_map& m) const {
+        return Size == m.Size && node::equal(Root, m.Root);
+    }
+
+    template <typename K, typename V, typename hash>
+    inline bool hamt_map<K, V, hash>::operator!=(const hamt_map& m) const {
+        return !operator==(m);
+    }
+
+    template <typename K, typename V, typename hash>
+    inline typename hamt_map<K, V, hash>::const_iterator hamt_map<K, V, hash>::begin() const {
+        return const_iterator{Root};
+    }
+
+    template <typename K, typename V, typename hash>
+    inline typename hamt_map<K, V, hash>::const_iterator hamt_map<K, V, hash>::end() const {
+        return const_iterator{};
+    }
+
+    template <typename K, typename V, typename hash>
+    hamt_map<K, V, hash>::const_iterator::const_iterator(const node* root) : Depth{0}, Current{nullptr} {
+        if (root == nullptr) return;
+        Path[0] = frame{root, 0};
+        Depth = 1;
+        advance();
+    }
+
+    // a node's entries come before the entries of its children.
+    template <typename K, typename V, typename hash>
+    void hamt_map<K, V, hash>::const_iterator::advance() {
+        while (Depth > 0) {
+            frame& f = Path[Depth - 1];
+            uint32 e = f.Node->entries();
+            if (f.Index < e) {
+                Current = f.Node->data() + f.Index++;
+                return;
+            }
+
+            uint32 c = f.Index - e;
+            if (c < f.Node->children()) {
+                f.Index++;
+                Path[Depth++] = frame{f.Node->nodes()[c], 0};
+            } else Depth--;
+        }
+        Current = nullptr;
+    }
+
+    template <typename K, typename V, typename hash>
+    inline hamt_map<K, V, hash>::transient::transient(const hamt_map& m) : Root{node::acquire(m.Root)}, Size{m.Size} {}
+
+    template <typename K, typename V, typename hash>
+    inline hamt_map<K, V, hash>::transient::~transient() {
+        node::release(Root);
+    }
+
+    template <typename K, typename V, typename hash>
+    inline size_t hamt_map<K, V, hash>::transient::size() const {
+        return Size;
+    }
+
+    template <typename K, typename V, typename hash>
+    inline const V* hamt_map<K, V, hash>::transient::find(const K& k) const {
+        return node::find(Root, k, hash_of(k));
+    }
+
+    template <typename K, typename V, typename hash>
+    inline bool hamt_map<K, V, hash>::transient::contains(const K& k) const {
+        return find(k) != nullptr;
+    }
+
+    template <typename K, typename V, typename hash>
+    typename hamt_map<K, V, hash>::transient& hamt_map<K, V, hash>::transient::insert(const K& k, const V& v) {
+        entry x{k, v};
+        uint64 h = hash_of(k);
+        if (Root == nullptr) {
+            Root = node::single(x, h);
+            Size = 1;
+            return *this;
+        }
+
+        bool added = false;
+        Root = node::insert_in_place(Root, x, h, 0, added);
+        if (added) Size++;
+        return *this;
+    }
+
+    template <typename K, typename V, typename hash>
+    inline typename hamt_map<K, V, hash>::transient& hamt_map<K, V, hash>::transient::insert(const entry& e) {
+        return insert(e.Key, e.Value);
+    }
+
+    template <typename K, typename V, typename hash>
+    typename hamt_map<K, V, hash>::transient& hamt_map<K, V, hash>::transient::remove(const K& k) {
+        if (Root == nullptr) return *this;
+        bool removed = false;
+        Root = node::remove_in_place(Root, k, hash_of(k), 0, removed);
+        if (!removed) return *this;
+        if (--Size == 0) {
+            node::release(Root);
+            Root = nullptr;
+        }
+        return *this;
+    }
+
+    template <typename K, typename V, typename hash>
+    inline hamt_map<K, V, hash> hamt_map<K, V, hash>::transient::persistent() const {
+        return hamt_map{node::acquire(Root), Size};
+    }
+
+}
+
+#endif
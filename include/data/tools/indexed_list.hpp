@@ -0,0 +1,468 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef DATA_TOOLS_INDEXED_LIST
+#define DATA_TOOLS_INDEXED_LIST
+
+#include <algorithm>
+#include <stdexcept>
+#include <ostream>
+#include <data/list.hpp>
+#include <data/functional/stack.hpp>
+
+namespace data::tool {
+
+    // a persistent sequence with O(log n) index, update, insert,
+    // split and concatenation. It is an AVL tree in which every
+    // node knows the size of its subtree, so that a position can
+    // be found by comparing against the sizes of left subtrees.
+    // Everything is built out of join, which puts together two
+    // trees and an element between them in time proportional to
+    // the difference of their heights.
+    //
+    // << appends, as with data::list.
+    template <typename elem>
+    class indexed_list {
+        struct node;
+
+        ptr<const node> Root;
+
+        explicit indexed_list(ptr<const node> n) : Root{n} {}
+
+        uint32 height() const;
+
+        static indexed_list make(const indexed_list& l, const elem& x, const indexed_list& r);
+        static indexed_list rotate_left(const indexed_list& t);
+        static indexed_list rotate_right(const indexed_list& t);
+        static indexed_list join_right(const indexed_list& l, const elem& x, const indexed_list& r);
+        static indexed_list join_left(const indexed_list& l, const elem& x, const indexed_list& r);
+
+        template <typename I>
+        static indexed_list build(I& it, size_t n);
+
+    public:
+        indexed_list() : Root{nullptr} {}
+        indexed_list(const elem& x) : indexed_list{make(indexed_list{}, x, indexed_list{})} {}
+
+        // a stack constructor, as required by interface::stack.
+        indexed_list(const elem& x, const indexed_list& l) : indexed_list{join(indexed_list{}, x, l)} {}
+
+        template <typename X, typename Y, typename ... P>
+        indexed_list(X x, Y y, P... p) : indexed_list{indexed_list{}.append(x, y, p...)} {}
+
+        // O(n) from a range of elements.
+        template <typename I>
+        static indexed_list from(I begin, I end);
+
+        bool empty() const;
+        size_t size() const;
+        bool valid() const;
+
+        const elem& first() const;
+        const elem& last() const;
+        indexed_list rest() const;
+
+        const elem& operator[](size_t i) const;
+
+        // replace the element at position i.
+        indexed_list update(size_t i, const elem& x) const;
+
+        // insert before position i.
+        indexed_list insert(size_t i, const elem& x) const;
+
+        indexed_list remove(size_t i) const;
+
+        indexed_list prepend(const elem& x) const;
+        indexed_list append(const elem& x) const;
+        indexed_list append(const indexed_list& l) const;
+
+        template <typename X, typename Y, typename ... P>
+        indexed_list append(X x, Y y, P... p) const;
+
+        indexed_list operator<<(const elem& x) const;
+        indexed_list operator<<(const indexed_list& l) const;
+
+        // the first n elements and the rest.
+        std::pair<indexed_list, indexed_list> split(size_t n) const;
+        indexed_list take(size_t n) const;
+        indexed_list drop(size_t n) const;
+
+        // all elements of l, then x, then all elements of r.
+        static indexed_list join(const indexed_list& l, const elem& x, const indexed_list& r);
+        static indexed_list concat(const indexed_list& l, const indexed_list& r);
+
+        // the index of the first element that does not satisfy p,
+        // given that p is true of a prefix of the list.
+        template <typename P>
+        size_t partition_point(P p) const;
+
+        bool operator==(const indexed_list& l) const;
+        bool operator!=(const indexed_list& l) const;
+
+        // an in-order iterator with a fixed stack of nodes. The
+        // height of an AVL tree is less than 1.45 log2(n + 2).
+        class const_iterator {
+            static constexpr int MaxDepth = 96;
+            const node* Path[MaxDepth];
+            int Depth;
+
+            void push_left(const node* n);
+            friend class indexed_list;
+
+        public:
+            using value_type = elem;
+            using difference_type = int;
+            using pointer = const elem*;
+            using reference = const elem&;
+            using iterator_category = std::forward_iterator_tag;
+
+            const_iterator() : Depth{0} {}
+            const_iterator(const const_iterator& i);
+            const_iterator& operator=(const const_iterator& i);
+
+            const elem& operator*() const;
+            const_iterator& operator++();
+            const_iterator operator++(int);
+
+            bool operator==(const const_iterator& i) const;
+            bool operator!=(const const_iterator& i) const;
+        };
+
+        using iterator = const_iterator;
+
+        const_iterator begin() const;
+        const_iterator end() const;
+    };
+
+    template <typename elem>
+    struct indexed_list<elem>::node {
+        uint32 Height;
+        size_t Size;
+        indexed_list Left;
+        elem Value;
+        indexed_list Right;
+
+        node(const indexed_list& l, const elem& x, const indexed_list& r) :
+            Height{1 + std::max(l.height(), r.height())},
+            Size{1 + l.size() + r.size()}, Left{l}, Value{x}, Right{r} {}
+    };
+
+    template <typename elem>
+    inline std::ostream& operator<<(std::ostream& o, const indexed_list<elem>& x) {
+        return functional::stack::write(o << "list", x);
+    }
+
+    template <typename elem>
+    inline uint32 indexed_list<elem>::height() const {
+        return Root == nullptr ? 0 : Root->Height;
+    }
+
+    template <typename elem>
+    inline indexed_list<elem> indexed_list<elem>::make(const indexed_list& l, const elem& x, const indexed_list& r) {
+        return indexed_list{std::make_shared<const node>(l, x, r)};
+    }
+
+    template <typename elem>
+    inline indexed_list<elem> indexed_list<elem>::rotate_left(const indexed_list& t) {
+        const indexed_list& r = t.Root->Right;
+        return make(make(t.Root->Left, t.Root->Value, r.Root->Left), r.Root->Value, r.Root->Right);
+    }
+
+    template <typename elem>
+    inline indexed_list<elem> indexed_list<elem>::rotate_right(const indexed_list& t) {
+        const indexed_list& l = t.Root->Left;
+        return make(l.Root->Left, l.Root->Value, make(l.Root->Right, t.Root->Value, t.Root->Right));
+    }
+
+    // l is taller than r by more than one.
+    template <typename elem>
+    indexed_list<elem> indexed_list<elem>::join_right(const indexed_list& l, const elem& x, const indexed_list& r) {
+        const indexed_list& ll = l.Root->Left;
+        const indexed_list& lr = l.Root->Right;
+        if (lr.height() <= r.height() + 1) {
+            indexed_list t = make(lr, x, r);
+            if (t.height() <= ll.height() + 1) return make(ll, l.Root->Value, t);
+            return rotate_left(make(ll, l.Root->Value, rotate_right(t)));
+        }
+
+        indexed_list t = join_right(lr, x, r);
+        indexed_list u = make(ll, l.Root->Value, t);
+        if (t.height() <= ll.height() + 1) return u;
+        return rotate_left(u);
+    }
+
+    // r is taller than l by more than one.
+    template <typename elem>
+    indexed_list<elem> indexed_list<elem>::join_left(const indexed_list& l, const elem& x, const indexed_list& r) {
+        const indexed_list& rl = r.Root->Left;
+        const indexed_list& rr = r.Root->Right;
+        if (rl.height() <= l.height() + 1) {
+            indexed_list t = make(l, x, rl);
+            if (t.height() <= rr.height() + 1) return make(t, r.Root->Value, rr);
+            return rotate_right(make(rotate_left(t), r.Root->Value, rr));
+        }
+
+        indexed_list t = join_left(l, x, rl);
+        indexed_list u = make(t, r.Root->Value, rr);
+        if (t.height() <= rr.height() + 1) return u;
+        return rotate_right(u);
+    }
+
+    template <typename elem>
+    indexed_list<elem> indexed_list<elem>::join(const indexed_list& l, const elem& x, const indexed_list& r) {
+        if (l.height() > r.height() + 1) return join_right(l, x, r);
+        if (r.height() > l.height() + 1) return join_left(l, x, r);
+        return make(l, x, r);
+    }
+
+    template <typename elem>
+    indexed_list<elem> indexed_list<elem>::concat(const indexed_list& l, const indexed_list& r) {
+        if (l.empty()) return r;
+        if (r.empty()) return l;
+        return join(l.take(l.size() - 1), l.last(), r);
+    }
+
+    template <typename elem>
+    template <typename I>
+    indexed_list<elem> indexed_list<elem>::build(I& it, size_t n) {
+        if (n == 0) return indexed_list{};
+        size_t half = (n - 1) / 2;
+        indexed_list l = build(it, half);
+        elem x = *it;
+        ++it;
+        indexed_list r = build(it, n - 1 - half);
+        return make(l, x, r);
+    }
+
+    template <typename elem>
+    template <typename I>
+    inline indexed_list<elem> indexed_list<elem>::from(I begin, I end) {
+        return build(begin, std::distance(begin, end));
+    }
+
+    template <typename elem>
+    inline bool indexed_list<elem>::empty() const {
+        return Root == nullptr;
+    }
+
+    template <typename elem>
+    inline size_t indexed_list<elem>::size() const {
+        return Root == nullptr ? 0 : Root->Size;
+    }
+
+    template <typename elem>
+    bool indexed_list<elem>::valid() const {
+        for (const elem& x : *this) if (!data::valid(x)) return false;
+        return true;
+    }
+
+    template <typename elem>
+    inline const elem& indexed_list<elem>::first() const {
+        const node* n = Root.get();
+        while (n->Left.Root != nullptr) n = n->Left.Root.get();
+        return n->Value;
+    }
+
+    template <typename elem>
+    inline const elem& indexed_list<elem>::last() const {
+        const node* n = Root.get();
+        while (n->Right.Root != nullptr) n = n->Right.Root.get();
+        return n->Value;
+    }
+
+    template <typename elem>
+    inline indexed_list<elem> indexed_list<elem>::rest() const {
+        return drop(1);
+    }
+
+    template <typename elem>
+    const elem& indexed_list<elem>::operator[](size_t i) const {
+        if (i >= size()) throw std::out_of_range{"indexed_list index"};
+        const node* n = Root.get();
+        while (true) {
+            size_t left = n->Left.size();
+            if (i < left) n = n->Left.Root.get();
+            else if (i == left) return n->Value;
+            else {
+                i -= left + 1;
+                n = n->Right.Root.get();
+            }
+        }
+    }
+
+    template <typename elem>
+    indexed_list<elem> indexed_list<elem>::update(size_t i, const elem& x) const {
+        if (i >= size()) throw std::out_of_range{"indexed_list index"};
+        size_t left = Root->Left.size();
+        if (i < left) return make(Root->Left.update(i, x), Root->Value, Root->Right);
+        if (i == left) return make(Root->Left, x, Root->Right);
+        return make(Root->Left, Root->Value, Root->Right.update(i - left - 1, x));
+    }
+
+    template <typename elem>
+    indexed_list<elem> indexed_list<elem>::insert(size_t i, const elem& x) const {
+        if (i > size()) throw std::out_of_range{"indexed_list index"};
+        auto s = split(i);
+        return join(s.first, x, s.second);
+    }
+
+    template <typename elem>
+    indexed_list<elem> indexed_list<elem>::remove(size_t i) const {
+        if (i >= size()) throw std::out_of_range{"indexed_list index"};
+        auto s = split(i);
+        return concat(s.first, s.second.drop(1));
+    }
+
+    template <typename elem>
+    inline indexed_list<elem> indexed_list<elem>::prepend(const elem& x) const {
+        return join(indexed_list{}, x, *this);
+    }
+
+    template <typename elem>
+    inline indexed_list<elem> indexed_list<elem>::append(const elem& x) const {
+        return join(*this, x, indexed_list{});
+    }
+
+    template <typename elem>
+    inline indexed_list<elem> indexed_list<elem>::append(const indexed_list& l) const {
+        return concat(*this, l);
+    }
+
+    template <typename elem>
+    template <typename X, typename Y, typename ... P>
+    inline indexed_list<elem> indexed_list<elem>::append(X x, Y y, P... p) const {
+        return append(x).append(y, p...);
+    }
+
+    template <typename elem>
+    inline indexed_list<elem> indexed_list<elem>::operator<<(const elem& x) const {
+        return append(x);
+    }
+
+    template <typename elem>
+    inline indexed_list<elem> indexed_list<elem>::operator<<(const indexed_list& l) const {
+        return append(l);
+    }
+
+    template <typename elem>
+    std::pair<indexed_list<elem>, indexed_list<elem>> indexed_list<elem>::split(size_t n) const {
+        if (Root == nullptr) return {indexed_list{}, indexed_list{}};
+        size_t left = Root->Left.size();
+        if (n <= left) {
+            if (n == 0) return {indexed_list{}, *this};
+            auto s = Root->Left.split(n);
+            return {s.first, join(s.second, Root->Value, Root->Right)};
+        }
+
+        if (n >= size()) return {*this, indexed_list{}};
+        auto s = Root->Right.split(n - left - 1);
+        return {join(Root->Left, Root->Value, s.first), s.second};
+    }
+
+    template <typename elem>
+    inline indexed_list<elem> indexed_list<elem>::take(size_t n) const {
+        return split(n).first;
+    }
+
+    template <typename elem>
+    inline indexed_list<elem> indexed_list<elem>::drop(size_t n) const {
+        return split(n).second;
+    }
+
+    template <typename elem>
+    template <typename P>
+    size_t indexed_list<elem>::partition_point(P p) const {
+        size_t i = 0;
+        const node* n = Root.get();
+        while (n != nullptr) {
+            if (p(n->Value)) {
+                i += n->Left.size() + 1;
+                n = n->Right.Root.get();
+            } else n = n->Left.Root.get();
+        }
+        return i;
+    }
+
+    template <typename elem>
+    bool indexed_list<elem>::operator==(const indexed_list& l) const {
+        if (Root == l.Root) return true;
+        if (size() != l.size()) return false;
+        const_iterator b = l.begin();
+        for (const elem& x : *this) {
+            if (x != *b) return false;
+            ++b;
+        }
+        return true;
+    }
+
+    template <typename elem>
+    inline bool indexed_list<elem>::operator!=(const indexed_list& l) const {
+        return !(*this == l);
+    }
+
+    template <typename elem>
+    inline void indexed_list<elem>::const_iterator::push_left(const node* n) {
+        while (n != nullptr) {
+            Path[Depth++] = n;
+            n = n->Left.Root.get();
+        }
+    }
+
+    template <typename elem>
+    inline indexed_list<elem>::const_iterator::const_iterator(const const_iterator& i) : Depth{i.Depth} {
+        for (int d = 0; d < Depth; d++) Path[d] = i.Path[d];
+    }
+
+    template <typename elem>
+    inline typename indexed_list<elem>::const_iterator& indexed_list<elem>::const_iterator::operator=(const const_iterator& i) {
+        Depth = i.Depth;
+        for (int d = 0; d < Depth; d++) Path[d] = i.Path[d];
+        return *this;
+    }
+
+    template <typename elem>
+    inline const elem& indexed_list<elem>::const_iterator::operator*() const {
+        return Path[Depth - 1]->Value;
+    }
+
+    template <typename elem>
+    inline typename indexed_list<elem>::const_iterator& indexed_list<elem>::const_iterator::operator++() {
+        const node* n = Path[--Depth];
+        push_left(n->Right.Root.get());
+        return *this;
+    }
+
+    template <typename elem>
+    inline typename indexed_list<elem>::const_iterator indexed_list<elem>::const_iterator::operator++(int) {
+        const_iterator i = *this;
+        ++(*this);
+        return i;
+    }
+
+    template <typename elem>
+    inline bool indexed_list<elem>::const_iterator::operator==(const const_iterator& i) const {
+        if (Depth != i.Depth) return false;
+        return Depth == 0 || Path[Depth - 1] == i.Path[Depth - 1];
+    }
+
+    template <typename elem>
+    inline bool indexed_list<elem>::const_iterator::operator!=(const const_iterator& i) const {
+        return !(*this == i);
+    }
+
+    template <typename elem>
+    inline typename indexed_list<elem>::const_iterator indexed_list<elem>::begin() const {
+        const_iterator i{};
+        i.push_left(Root.get());
+        return i;
+    }
+
+    template <typename elem>
+    inline typename indexed_list<elem>::const_iterator indexed_list<elem>::end() const {
+        return const_iterator{};
+    }
+
+}
+
+#endif
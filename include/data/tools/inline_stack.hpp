@@ -0,0 +1,55 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef DATA_TOOLS_INLINE_STACK
+#define DATA_TOOLS_INLINE_STACK
+
+#include <vector>
+#include <data/types.hpp>
+
+namespace data::tool {
+
+    // a mutable stack which keeps its first N elements inline
+    // and moves the rest to the heap, so that a traversal which
+    // does not go deeper than N does not allocate. It is meant
+    // for small trivially copyable things such as pointers.
+    template <typename X, size_t N = 32>
+    class inline_stack {
+        X Inline[N];
+        std::vector<X> Overflow;
+        size_t Size;
+
+    public:
+        inline_stack() : Overflow{}, Size{0} {}
+
+        bool empty() const {
+            return Size == 0;
+        }
+
+        size_t size() const {
+            return Size;
+        }
+
+        void push(const X& x) {
+            if (Size < N) Inline[Size] = x;
+            else Overflow.push_back(x);
+            Size++;
+        }
+
+        const X& top() const {
+            return Size <= N ? Inline[Size - 1] : Overflow.back();
+        }
+
+        X pop() {
+            Size--;
+            if (Size < N) return Inline[Size];
+            X x = Overflow.back();
+            Overflow.pop_back();
+            return x;
+        }
+    };
+
+}
+
+#endif
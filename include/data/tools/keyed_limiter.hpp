@@ -0,0 +1,120 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef DATA_TOOLS_KEYED_LIMITER
+#define DATA_TOOLS_KEYED_LIMITER
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <data/tools/token_bucket.hpp>
+
+namespace data::tool {
+
+    // a token_bucket for every key, such as a client id, each with
+    // the same rate. A bucket is made the first time its key is seen.
+    //
+    // The buckets are divided between shards by hash, and each shard
+    // has its own lock, so threads that use different keys seldom
+    // wait for each other. Taking a token only takes the shared side
+    // of the lock, since the buckets themselves are lock-free; the
+    // exclusive side is only taken to add or remove buckets.
+    template <typename key, typename hash = std::hash<key>>
+    class keyed_limiter {
+    public:
+        using clock = token_bucket::clock;
+        using duration = token_bucket::duration;
+
+        // the number of shards is rounded up to a power of two.
+        keyed_limiter(uint64 count, duration period, uint64 burst = 1, uint32 shards = 64) :
+            Prototype{count, period, burst}, Mask{round_up(shards) - 1}, Shards{new shard[Mask + 1]} {}
+
+        bool try_acquire(const key &k, uint64 n = 1) {
+            return try_acquire(k, n, clock::now());
+        }
+
+        bool try_acquire(const key &k, uint64 n, clock::time_point now) {
+            return with(k, [n, now](token_bucket &b) {
+                return b.try_acquire(n, now);
+            });
+        }
+
+        duration reserve(const key &k, uint64 n = 1) {
+            return reserve(k, n, clock::now());
+        }
+
+        duration reserve(const key &k, uint64 n, clock::time_point now) {
+            return with(k, [n, now](token_bucket &b) {
+                return b.reserve(n, now);
+            });
+        }
+
+        void acquire(const key &k, uint64 n = 1) {
+            duration wait = reserve(k, n);
+            if (wait.count() > 0) std::this_thread::sleep_for(wait);
+        }
+
+        // the number of keys that have buckets.
+        size_t size() const {
+            size_t n = 0;
+            for (uint32 i = 0; i <= Mask; i++) {
+                std::shared_lock<std::shared_mutex> lock{Shards[i].Mutex};
+                n += Shards[i].Buckets.size();
+            }
+            return n;
+        }
+
+        // remove the buckets that are full, which are no different
+        // from new ones, so that keys that have gone quiet do not
+        // take up memory. Returns how many were removed.
+        size_t prune(clock::time_point now = clock::now()) {
+            size_t removed = 0;
+            uint64 burst = Prototype.burst();
+            for (uint32 i = 0; i <= Mask; i++) {
+                std::unique_lock<std::shared_mutex> lock{Shards[i].Mutex};
+                auto &m = Shards[i].Buckets;
+                for (auto b = m.begin(); b != m.end();)
+                    if (b->second.available(now) == burst) {
+                        b = m.erase(b);
+                        removed++;
+                    } else ++b;
+            }
+            return removed;
+        }
+
+    private:
+        struct alignas(64) shard {
+            mutable std::shared_mutex Mutex;
+            std::unordered_map<key, token_bucket, hash> Buckets;
+        };
+
+        const token_bucket Prototype;
+        const uint32 Mask;
+        std::unique_ptr<shard[]> Shards;
+
+        static uint32 round_up(uint32 n) {
+            uint32 s = 1;
+            while (s < n) s <<= 1;
+            return s;
+        }
+
+        template <typename f>
+        auto with(const key &k, f fun) -> decltype(fun(std::declval<token_bucket&>())) {
+            shard &s = Shards[hash{}(k) & Mask];
+            {
+                std::shared_lock<std::shared_mutex> lock{s.Mutex};
+                auto b = s.Buckets.find(k);
+                if (b != s.Buckets.end()) return fun(b->second);
+            }
+
+            std::unique_lock<std::shared_mutex> lock{s.Mutex};
+            return fun(s.Buckets.try_emplace(k, Prototype).first->second);
+        }
+    };
+
+}
+
+#endif
@@ -0,0 +1,61 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef DATA_TOOLS_LAZY
+#define DATA_TOOLS_LAZY
+
+#include <functional>
+#include <optional>
+#include <data/tools/once.hpp>
+
+namespace data::tool {
+
+    // a suspended computation which is evaluated at most once.
+    // The result is memoized, so forcing a lazy value a second
+    // time costs nothing. Forcing is thread safe. If the thunk
+    // throws, nothing is kept and the next force tries again.
+    template <typename X>
+    class lazy {
+        mutable once Once;
+        mutable std::function<X()> Thunk;
+        mutable std::optional<X> Value;
+
+    public:
+        explicit lazy(std::function<X()> f) : Once{}, Thunk{f}, Value{} {}
+
+        // a value which has already been evaluated.
+        explicit lazy(const X& x) : Once{}, Thunk{}, Value{} {
+            Once([this, &x]() {
+                Value.emplace(x);
+            });
+        }
+
+        lazy(const lazy&) = delete;
+        lazy& operator=(const lazy&) = delete;
+
+        const X& force() const {
+            Once([this]() {
+                Value.emplace(Thunk());
+                // release whatever the thunk captured.
+                Thunk = nullptr;
+            });
+            return *Value;
+        }
+        
+        bool evaluated() const {
+            return Once.finished();
+        }
+
+        const X& operator*() const {
+            return force();
+        }
+
+        const X* operator->() const {
+            return &force();
+        }
+    };
+
+}
+
+#endif
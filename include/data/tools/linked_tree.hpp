@@ -5,16 +5,25 @@
 #ifndef DATA_TREE_LINKED
 #define DATA_TREE_LINKED
 
+#include <algorithm>
+#include <exception>
+#include <iterator>
+#include <optional>
+#include <thread>
+#include <vector>
 #include <data/tree.hpp>
 #include <data/tools/linked_stack.hpp>
+#include <data/tools/inline_stack.hpp>
+#include <data/tools/thread_pool.hpp>
     
 namespace data::tool {
 
-    template <typename value>
+    // alloc is an allocation policy from data/tools/allocation.hpp. 
+    template <typename value, typename alloc = allocation::shared>
     struct linked_tree {
         
         using node = functional::tree::node<value, linked_tree>;
-        using next = ptr<node>;
+        using next = typename alloc::template pointer<node>;
         
         next Node;
         size_t Size;
@@ -29,181 +38,387 @@ namespace data::tool {
         bool contains(const value& v) const;
         size_t size() const;
         
-        bool valid() const {
-            return data::valid(root()) && left().valid() && right().valid();
-        }
+        bool valid() const;
         
         linked_tree();
         linked_tree(const value& v, linked_tree l, linked_tree r);
         linked_tree(const value& v);
         linked_tree(const linked_tree& t);
+        linked_tree(linked_tree&& t);
         
         linked_tree& operator=(const linked_tree& t);
+        linked_tree& operator=(linked_tree&& t);
+        
+        // nodes which are not shared are destroyed in a loop. 
+        ~linked_tree();
         
+        // a balanced tree whose values, in order, are the given 
+        // range. Takes O(n). 
+        template <typename it>
+        static linked_tree balanced(it begin, it end);
+        
+        // contains, valid, == and iteration do not recurse, so 
+        // they work on trees of any depth. 
         template <typename X> 
-        bool operator==(const data::tool::linked_tree<X>& x) const {
-            if (Node == x.Node) return true;
-            if (Node == nullptr || x.Node == nullptr) return false;
-            if (root() != x.root()) return false;
-            if (left() != x.left()) return false;
-            return right() == x.right();
-        }
+        bool operator==(const data::tool::linked_tree<X, alloc>& x) const;
         
         template <typename X> 
-        bool operator!=(const data::tool::linked_tree<X>& x) const {
+        bool operator!=(const data::tool::linked_tree<X, alloc>& x) const {
             return ! (*this == x);
         }
         
-        template <typename val>
-        struct tree_iterator {
-            linked_stack<linked_tree> Branches;
-            linked_tree Current;
-            tree_iterator() : Branches{}, Current{} {}
-            tree_iterator(linked_tree t) : Branches{}, Current{t} {}
+        enum class order {pre, in, post};
+        
+        // iterators keep the nodes they have yet to return to on an 
+        // inline_stack, so they do not allocate unless the tree is 
+        // deeper than 32. 
+        template <order o>
+        class tree_iterator {
+            // Right says whether the node was reached as the right 
+            // child of the one beneath it. Post-order needs this 
+            // because both children may be the same shared node. 
+            struct frame {
+                const node* Node;
+                bool Right;
+            };
+            
+            inline_stack<frame> Pending;
+            const node* Current;
+            
+            explicit tree_iterator(const node* n) : Pending{}, Current{nullptr} {
+                if (n == nullptr) return;
+                if constexpr (o == order::pre) Current = n;
+                else {
+                    descend(n, false);
+                    Current = Pending.top().Node;
+                }
+            }
+            
+            // push n and then its first descendent in this order. 
+            void descend(const node* n, bool right) {
+                while (n != nullptr) {
+                    Pending.push(frame{n, right});
+                    if constexpr (o == order::in) n = n->Left.Node.get();
+                    else {
+                        right = n->Left.Node == nullptr;
+                        n = right ? n->Right.Node.get() : n->Left.Node.get();
+                    }
+                }
+            }
+            
+            friend struct linked_tree;
+            
+        public:
+            using value_type = value;
+            using difference_type = int;
+            using pointer = const value*;
+            using reference = const value&;
+            using iterator_category = std::forward_iterator_tag;
+            
+            tree_iterator() : Pending{}, Current{nullptr} {}
+            
+            const value& operator*() const {
+                return Current->Value;
+            }
+            
+            // in pre-order, Pending holds right subtrees which have 
+            // yet to be visited. Otherwise, it holds the path from 
+            // the root to the current node, which is on top. 
+            tree_iterator& operator++() {
+                if constexpr (o == order::pre) {
+                    const node* l = Current->Left.Node.get();
+                    const node* r = Current->Right.Node.get();
+                    if (l != nullptr) {
+                        if (r != nullptr) Pending.push(frame{r, true});
+                        Current = l;
+                    } else if (r != nullptr) Current = r;
+                    else Current = Pending.empty() ? nullptr : Pending.pop().Node;
+                    return *this;
+                } else if constexpr (o == order::in) {
+                    Pending.pop();
+                    descend(Current->Right.Node.get(), true);
+                } else if (!Pending.pop().Right && !Pending.empty()) 
+                    descend(Pending.top().Node->Right.Node.get(), true);
+                
+                Current = Pending.empty() ? nullptr : Pending.top().Node;
+                return *this;
+            }
+            
+            tree_iterator operator++(int) {
+                tree_iterator i = *this;
+                ++(*this);
+                return i;
+            }
             
-            val operator*() const;
+            bool operator==(const tree_iterator& i) const {
+                return Current == i.Current;
+            }
             
-            tree_iterator& operator++();
-            bool operator==(tree_iterator) const;
-            bool operator!=(tree_iterator) const;
-        private:
-            tree_iterator(linked_stack<linked_tree> b, linked_tree c) : Branches{b}, Current{c} {}
+            bool operator!=(const tree_iterator& i) const {
+                return Current != i.Current;
+            }
         };
         
-        using iterator = tree_iterator<value>;
-        using const_iterator = tree_iterator<const value>;
+        // a view of the tree in a given order. 
+        template <order o>
+        struct traversal {
+            linked_tree Tree;
+            
+            tree_iterator<o> begin() const {
+                return tree_iterator<o>{Tree.Node.get()};
+            }
+            
+            tree_iterator<o> end() const {
+                return tree_iterator<o>{};
+            }
+        };
         
-        linked_stack<value> values() const;
+        traversal<order::pre> pre_order() const;
+        traversal<order::in> in_order() const;
+        traversal<order::post> post_order() const;
         
-        iterator begin();
-        iterator end();
+        // iteration is pre-order by default. 
+        using iterator = tree_iterator<order::pre>;
+        using const_iterator = tree_iterator<order::pre>;
+        
+        linked_stack<value> values() const;
         
         const_iterator begin() const;
         const_iterator end() const;
         
+        // f(root, left, right) is applied from the bottom up, 
+        // with e in place of empty subtrees. 
+        template <typename X, typename F>
+        X fold(F f, X e) const;
+        
+        // a fold in which both sides of a large subtree are done 
+        // at the same time, using up to the given number of 
+        // threads. Subtrees with fewer than min_split nodes on 
+        // either side are folded in one thread. 
+        template <typename X, typename F>
+        X parallel_fold(F f, X e, 
+            uint32 threads = std::thread::hardware_concurrency(), 
+            size_t min_split = 1 << 12) const;
+        
         std::ostream& write(std::ostream& o) const;
+    private:
+        template <typename it>
+        static linked_tree build(it& begin, size_t n);
     };
 
-    template <typename X> 
-    inline std::ostream& operator<<(std::ostream& o, const linked_tree<X>& x) {
+    template <typename X, typename alloc> 
+    inline std::ostream& operator<<(std::ostream& o, const linked_tree<X, alloc>& x) {
         return x.write(o << "tree");
     }
     
-    template <typename value>
-    inline bool linked_tree<value>::empty() const {
+    template <typename value, typename alloc>
+    inline bool linked_tree<value, alloc>::empty() const {
         return Node == nullptr;
     }
     
-    template <typename value>
-    inline const value& linked_tree<value>::root() const {
+    template <typename value, typename alloc>
+    inline const value& linked_tree<value, alloc>::root() const {
         return Node->Value;
     }
     
-    template <typename value>
-    inline linked_tree<value> linked_tree<value>::left() const {
+    template <typename value, typename alloc>
+    inline linked_tree<value, alloc> linked_tree<value, alloc>::left() const {
         return Node == nullptr ? linked_tree{} : Node->Left;
     } 
     
-    template <typename value>
-    inline linked_tree<value> linked_tree<value>::right() const {
+    template <typename value, typename alloc>
+    inline linked_tree<value, alloc> linked_tree<value, alloc>::right() const {
         return Node == nullptr ? linked_tree{} : Node->Right;
     }
     
-    template <typename value>
-    bool linked_tree<value>::contains(const value& v) const {
-        if (Node == nullptr) return false;
-        if (Node->Value == v) return true;
-        if (Node->Left.contains(v)) return true;
-        return Node->Right.contains(v);
+    template <typename value, typename alloc>
+    bool linked_tree<value, alloc>::contains(const value& v) const {
+        for (const value& x : *this) if (x == v) return true;
+        return false;
+    }
+    
+    template <typename value, typename alloc>
+    bool linked_tree<value, alloc>::valid() const {
+        for (const value& x : *this) if (!data::valid(x)) return false;
+        return true;
     }
     
-    template <typename value>
-    inline size_t linked_tree<value>::size() const {
+    template <typename value, typename alloc>
+    inline size_t linked_tree<value, alloc>::size() const {
         return Size;
     }
     
-    template <typename value>
-    inline linked_tree<value>::linked_tree() : Node{nullptr}, Size{0} {}
+    template <typename value, typename alloc>
+    inline linked_tree<value, alloc>::linked_tree() : Node{nullptr}, Size{0} {}
     
-    template <typename value>
-    inline linked_tree<value>::linked_tree(const value& v, linked_tree l, linked_tree r) : 
-        Node{std::make_shared<node>(v, l, r)}, Size{1 + l.size() + r.size()} {}
+    template <typename value, typename alloc>
+    inline linked_tree<value, alloc>::linked_tree(const value& v, linked_tree l, linked_tree r) : 
+        Node{alloc::template make<node>(v, l, r)}, Size{1 + l.size() + r.size()} {}
     
-    template <typename value>
-    inline linked_tree<value>::linked_tree(const value& v) : linked_tree{v, linked_tree{}, linked_tree{}} {}
+    template <typename value, typename alloc>
+    inline linked_tree<value, alloc>::linked_tree(const value& v) : linked_tree{v, linked_tree{}, linked_tree{}} {}
     
-    template <typename value>
-    inline linked_stack<value> linked_tree<value>::values() const {
-        linked_stack<value> vals{};
-        for (auto x = begin(); x != end(); ++x) vals = vals << *x;
-        return data::reverse(vals);
+    template <typename value, typename alloc>
+    inline linked_tree<value, alloc>::linked_tree(const linked_tree& t) : Node{t.Node}, Size{t.Size} {}
+    
+    template <typename value, typename alloc>
+    inline linked_tree<value, alloc>::linked_tree(linked_tree&& t) : Node{std::move(t.Node)}, Size{t.Size} {
+        t.Size = 0;
     }
     
-    template <typename value>
-    inline typename linked_tree<value>::iterator linked_tree<value>::begin() {
-        return iterator{*this};
-    } 
+    template <typename value, typename alloc>
+    inline linked_tree<value, alloc>& linked_tree<value, alloc>::operator=(const linked_tree& t) {
+        linked_tree x{t};
+        std::swap(Node, x.Node);
+        std::swap(Size, x.Size);
+        return *this;
+    }
     
-    template <typename value>
-    inline typename linked_tree<value>::iterator linked_tree<value>::end() {
-        return iterator{};
+    template <typename value, typename alloc>
+    inline linked_tree<value, alloc>& linked_tree<value, alloc>::operator=(linked_tree&& t) {
+        std::swap(Node, t.Node);
+        std::swap(Size, t.Size);
+        return *this;
     }
     
-    template <typename value>
-    inline typename linked_tree<value>::const_iterator linked_tree<value>::begin() const {
-        return const_iterator{*this};
-    } 
+    // a unique node with a unique left child is rotated so that 
+    // the child becomes its parent. When there is no left child 
+    // left, the node is removed. Thus no stack is needed. 
+    template <typename value, typename alloc>
+    linked_tree<value, alloc>::~linked_tree() {
+        next n = std::move(Node);
+        while (n != nullptr && n.use_count() == 1) {
+            if (n->Left.Node == nullptr) {
+                next r = std::move(n->Right.Node);
+                n = std::move(r);
+            } else if (n->Left.Node.use_count() != 1) n->Left.Node = nullptr;
+            else {
+                next l = std::move(n->Left.Node);
+                n->Left.Node = std::move(l->Right.Node);
+                l->Right.Node = std::move(n);
+                n = std::move(l);
+            }
+        }
+    }
     
-    template <typename value>
-    inline typename linked_tree<value>::const_iterator linked_tree<value>::end() const {
-        return const_iterator{};
+    template <typename value, typename alloc>
+    template <typename it>
+    linked_tree<value, alloc> linked_tree<value, alloc>::build(it& begin, size_t n) {
+        if (n == 0) return {};
+        linked_tree l = build(begin, (n - 1) / 2);
+        const value& v = *begin;
+        ++begin;
+        return linked_tree{v, l, build(begin, n / 2)};
     }
     
-    template <typename value>
-    inline linked_tree<value>::linked_tree(const linked_tree& t) {
-        Node = t.Node;
-        Size = t.Size;
+    template <typename value, typename alloc>
+    template <typename it>
+    inline linked_tree<value, alloc> linked_tree<value, alloc>::balanced(it begin, it end) {
+        return build(begin, static_cast<size_t>(std::distance(begin, end)));
     }
     
-    template <typename value>
-    inline linked_tree<value>& linked_tree<value>::operator=(const linked_tree& t) {
-        Node = t.Node;
-        Size = t.Size;
-        return *this;
+    // subtrees which are shared are not looked into. 
+    template <typename value, typename alloc>
+    template <typename X> 
+    bool linked_tree<value, alloc>::operator==(const data::tool::linked_tree<X, alloc>& x) const {
+        if (Size != x.Size) return false;
+        using other = typename data::tool::linked_tree<X, alloc>::node;
+        inline_stack<std::pair<const node*, const other*>> pending{};
+        pending.push({Node.get(), x.Node.get()});
+        while (!pending.empty()) {
+            auto p = pending.pop();
+            if (static_cast<const void*>(p.first) == static_cast<const void*>(p.second)) continue;
+            if (p.first == nullptr || p.second == nullptr) return false;
+            if (p.first->Value != p.second->Value) return false;
+            if (p.first->Left.Size != p.second->Left.Size) return false;
+            pending.push({p.first->Right.Node.get(), p.second->Right.Node.get()});
+            pending.push({p.first->Left.Node.get(), p.second->Left.Node.get()});
+        }
+        return true;
     }
     
-    template <typename value>
-    template <typename val>
-    inline val linked_tree<value>::tree_iterator<val>::operator*() const {
-        return Current.root();
+    template <typename value, typename alloc>
+    linked_stack<value> linked_tree<value, alloc>::values() const {
+        std::vector<const value*> v{};
+        v.reserve(Size);
+        for (const value& x : *this) v.push_back(&x);
+        linked_stack<value> vals{};
+        for (auto i = v.rbegin(); i != v.rend(); ++i) vals = vals << **i;
+        return vals;
     }
     
-    template <typename value>
-    template <typename val>
-    inline bool linked_tree<value>::tree_iterator<val>::operator==(tree_iterator i) const {
-        return Current == i.Current && Branches == i.Branches;
+    template <typename value, typename alloc>
+    inline typename linked_tree<value, alloc>::template traversal<linked_tree<value, alloc>::order::pre> 
+    linked_tree<value, alloc>::pre_order() const {
+        return {*this};
     }
     
-    template <typename value>
-    template <typename val>
-    inline bool linked_tree<value>::tree_iterator<val>::operator!=(tree_iterator i) const {
-        return !(*this == i);
+    template <typename value, typename alloc>
+    inline typename linked_tree<value, alloc>::template traversal<linked_tree<value, alloc>::order::in> 
+    linked_tree<value, alloc>::in_order() const {
+        return {*this};
     }
     
-    template <typename value>
-    template <typename val>
-    typename linked_tree<value>::template tree_iterator<val>& linked_tree<value>::tree_iterator<val>::operator++() {
-        if (Current.left().size() != 0) {
-            if (Current.right().size() != 0) *this = tree_iterator{Branches << Current.right(), Current.left()};
-            else *this = tree_iterator{Branches, Current.left()};
-        } else if (Current.right().size() != 0) *this = tree_iterator{Branches, Current.right()};
-        else if (Branches.size() != 0) *this = tree_iterator{Branches.rest(), Branches.first()};
-        else *this = tree_iterator{};
-        return *this;
+    template <typename value, typename alloc>
+    inline typename linked_tree<value, alloc>::template traversal<linked_tree<value, alloc>::order::post> 
+    linked_tree<value, alloc>::post_order() const {
+        return {*this};
+    }
+    
+    template <typename value, typename alloc>
+    inline typename linked_tree<value, alloc>::const_iterator linked_tree<value, alloc>::begin() const {
+        return const_iterator{Node.get()};
+    } 
+    
+    template <typename value, typename alloc>
+    inline typename linked_tree<value, alloc>::const_iterator linked_tree<value, alloc>::end() const {
+        return const_iterator{};
+    }
+    
+    // each node is reached after both of its children, so their 
+    // results are on top of the stack. 
+    template <typename value, typename alloc>
+    template <typename X, typename F>
+    X linked_tree<value, alloc>::fold(F f, X e) const {
+        std::vector<X> results{};
+        for (auto i = post_order().begin(); i != tree_iterator<order::post>{}; ++i) {
+            const node* n = i.Current;
+            X r = n->Right.Node == nullptr ? e : std::move(results.back());
+            if (n->Right.Node != nullptr) results.pop_back();
+            X l = n->Left.Node == nullptr ? e : std::move(results.back());
+            if (n->Left.Node != nullptr) results.pop_back();
+            results.push_back(f(n->Value, std::move(l), std::move(r)));
+        }
+        return results.empty() ? e : std::move(results.back());
+    }
+    
+    template <typename value, typename alloc>
+    template <typename X, typename F>
+    X linked_tree<value, alloc>::parallel_fold(F f, X e, uint32 threads, size_t min_split) const {
+        if (threads < 2 || Node == nullptr || std::min(Node->Left.Size, Node->Right.Size) < min_split) 
+            return fold(f, e);
+        
+        uint32 half = threads / 2;
+        future<X> l = thread_pool::shared().spawn([this, &f, &e, half, min_split]() -> X {
+            return Node->Left.parallel_fold(f, e, half, min_split);
+        });
+        
+        // the left side refers to f and e, so it must be 
+        // done before an exception can be thrown. 
+        std::optional<X> r{};
+        std::exception_ptr error{};
+        try {
+            r = Node->Right.parallel_fold(f, e, threads - half, min_split);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        l.wait();
+        if (error) std::rethrow_exception(error);
+        return f(Node->Value, l.get(), std::move(*r));
     }
     
-    template <typename value>
-    std::ostream& linked_tree<value>::write(std::ostream& o) const {
+    template <typename value, typename alloc>
+    std::ostream& linked_tree<value, alloc>::write(std::ostream& o) const {
         if (Size == 0) return o << "{}";
         if (Size == 1) return o << "{" << root() << "}";
         return right().write(left().write(o << "{" << root() << ", ") << ", ") << "}";
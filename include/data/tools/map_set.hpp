@@ -16,11 +16,11 @@ namespace data::tool {
         unit(bool b) : Valid{b} {}
         unit() : Valid{false} {}
         
-        bool operator==(unit x) {
+        bool operator==(unit x) const {
             return Valid == x.Valid;
         }
         
-        bool operator!=(unit x) {
+        bool operator!=(unit x) const {
             return Valid != x.Valid;
         }
     };
@@ -60,18 +60,16 @@ namespace data::tool {
         }
         
         map_set insert(list<key> keys) const {
-            if (keys.empty()) return *this;
-            return insert(keys.first()).insert(keys.rest());
+            map_set x = *this;
+            while (!keys.empty()) {
+                x = x.insert(keys.first());
+                keys = keys.rest();
+            }
+            return x;
         }
         
-        map_set insert(map_set m) const {
-            auto v = m.values();
-            auto q = *this;
-            while (!v.empty()) {
-                q = q.insert(v.first());
-                v = v.rest();
-            }
-            return q;
+        map_set insert(const map_set& m) const {
+            return map_set{Map.insert(m.Map)};
         }
         
         map_set operator<<(const key& k) const {
@@ -79,68 +77,48 @@ namespace data::tool {
         }
         
         map_set remove(const key& k) const {
-            return map_set{Map.remove(k, value{true})};
+            return map_set{Map.remove(k)};
+        }
+        
+        map_set remove(const map_set& m) const {
+            return map_set{Map.remove(m.Map)};
         }
         
-        const ordered_list<key> values() const {
+        // ordered if the map is. 
+        decltype(std::declval<const M>().keys()) values() const {
             return Map.keys();
         }
         
         map_set() : Map{} {}
         map_set(M m) : Map(m) {}
-        map_set(list<key> keys) : Map{} {
-            insert(keys);
+        map_set(list<key> keys) : map_set{map_set{}.insert(keys)} {}
+        
+        // build a set in O(n) from strictly increasing keys. 
+        template <typename I>
+        static map_set from_sorted(I begin, I end) {
+            return map_set{M::from_sorted_keys(begin, end, value{true})};
         }
         
         bool operator==(const map_set& m) const {
-            return values() == m.values();
+            return Map == m.Map;
         }
         
         bool operator!=(const map_set& m) const {
             return !operator==(m);
         }
         
+        // union. 
         map_set operator&(const map_set& m) const {
-            return map_set{}.insert(*this).insert(m);
+            return insert(m);
         }
         
+        // intersection. 
         map_set operator|(const map_set& m) const {
-            auto a = values();
-            auto b = values();
-            map_set x{};
-            
-            while(!a.empty() && !b.empty()) {
-                auto i = a.first();
-                auto j = b.first();
-                if (i == j) {
-                    x = x.insert(i);
-                    a = a.rest();
-                    b = b.rest();
-                } else if(i < j) a = a.rest();
-                else b = b.rest();
-            }
-            
-            return x;
+            return map_set{Map.intersect(m.Map)};
         }
         
         map_set operator-(const map_set& m) const {
-            auto a = values();
-            auto b = values();
-            map_set x{};
-            
-            while(!a.empty() && !b.empty()) {
-                auto i = a.first();
-                auto j = b.first();
-                if (i == j) {
-                    a = a.rest();
-                    b = b.rest();
-                } if(i < j) {
-                    x = x.insert(i);
-                    a = a.rest();
-                } else b = b.rest();
-            }
-            
-            return x;
+            return remove(m);
         }
     };
     
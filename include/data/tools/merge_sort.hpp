@@ -5,39 +5,222 @@
 #ifndef DATA_TOOLS_MERGE_SORT
 #define DATA_TOOLS_MERGE_SORT
 
-#include <data/list/linked.hpp>
-
-namespace data::sort {
-    
-    template <typename X, typename L>
-    class merge : public L {
-        static L build(const X& x) {
-            return size(x) == 0 ? L{} : build(rest(x)) << L{first(x)};
+#include <algorithm>
+#include <iterator>
+#include <thread>
+#include <vector>
+#include <data/stack.hpp>
+#include <data/tools/thread_pool.hpp>
+
+// Stable merge sorts. None of them recurse on the size of the input.
+//
+// A persistent stack is sorted by copying its elements into a
+// buffer, sorting the buffer bottom-up and building the result
+// once from the back, so that the only nodes allocated are those
+// of the result.
+namespace data::sorting {
+
+    // blocks of this size are insertion sorted before merging.
+    constexpr size_t block = 32;
+
+    // merge [a, m) and [m, b) into out. Ties go to the left.
+    template <typename I, typename O>
+    O merge(I a, I m, I b, O out) {
+        I l = a;
+        I r = m;
+        while (l != m && r != b) {
+            if (*r < *l) *out = std::move(*r++);
+            else *out = std::move(*l++);
+            ++out;
+        }
+        out = std::move(l, m, out);
+        return std::move(r, b, out);
+    }
+
+    template <typename I>
+    void insertion_sort(I begin, I end) {
+        if (begin == end) return;
+        for (I i = std::next(begin); i != end; ++i) {
+            auto x = std::move(*i);
+            I j = i;
+            while (j != begin && x < *std::prev(j)) {
+                *j = std::move(*std::prev(j));
+                --j;
+            }
+            *j = std::move(x);
+        }
+    }
+
+    // merges adjacent runs, which are given by the offsets in bounds,
+    // until only one remains, going back and forth between the data
+    // and a buffer of the same size.
+    template <typename I, typename B>
+    void merge_runs(I begin, B buffer, std::vector<size_t>& bounds) {
+        bool in_buffer = false;
+        std::vector<size_t> next{};
+        while (bounds.size() > 2) {
+            next.clear();
+            for (size_t r = 0; r + 1 < bounds.size(); r += 2) {
+                next.push_back(bounds[r]);
+                size_t a = bounds[r];
+                size_t m = bounds[r + 1];
+                size_t b = r + 2 < bounds.size() ? bounds[r + 2] : m;
+                if (in_buffer) merge(buffer + a, buffer + m, buffer + b, begin + a);
+                else merge(begin + a, begin + m, begin + b, buffer + a);
+            }
+            next.push_back(bounds.back());
+            bounds.swap(next);
+            in_buffer = !in_buffer;
+        }
+
+        if (in_buffer) std::move(buffer, buffer + bounds.back(), begin);
+    }
+
+    // sort a random access range, using a buffer that holds
+    // at least as many elements as the range.
+    template <typename I, typename B>
+    void merge_sort(I begin, I end, B buffer) {
+        size_t n = std::distance(begin, end);
+        std::vector<size_t> bounds{};
+        for (size_t i = 0; i < n; i += block) {
+            insertion_sort(begin + i, begin + std::min(n, i + block));
+            bounds.push_back(i);
         }
-        
-        static merge round(merge m) {
-            return size(m) < 2 ? m : round(rest(rest(m))) << list::merge(first(m), first(rest(m)));
+        bounds.push_back(n);
+        merge_runs(begin, buffer, bounds);
+    }
+
+    // like merge_sort, but the runs to merge are the ones that are
+    // already in the data. Strictly decreasing runs are reversed.
+    // Input that is made of k runs takes O(n log k).
+    template <typename I, typename B>
+    void natural_merge_sort(I begin, I end, B buffer) {
+        size_t n = std::distance(begin, end);
+        std::vector<size_t> bounds{};
+        size_t i = 0;
+        while (i < n) {
+            bounds.push_back(i);
+            size_t j = i + 1;
+            if (j < n && begin[j] < begin[i]) {
+                while (j < n && begin[j] < begin[j - 1]) j++;
+                std::reverse(begin + i, begin + j);
+            } else while (j < n && !(begin[j] < begin[j - 1])) j++;
+            i = j;
         }
-    
-        merge() : L{} {}
-    
-    public:
-        merge(const X& init) : L{build(init)} {}
-        X operator*() const {
-            size_t s = size(*this);
-            return s == 0 ? X{} : s == 1 ? first(*this) : *round(*this);
+        bounds.push_back(n);
+        merge_runs(begin, buffer, bounds);
+    }
+
+    // the number of elements from [a, a + m) that come before
+    // position d in the merge of [a, a + m) and [b, b + n).
+    template <typename I>
+    size_t co_rank(I a, size_t m, I b, size_t n, size_t d) {
+        size_t lo = d > n ? d - n : 0;
+        size_t hi = std::min(d, m);
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (!(b[d - mid - 1] < a[mid])) lo = mid + 1;
+            else hi = mid;
         }
-    };
+        return lo;
+    }
+
+    // merge [a, m) and [m, b) into out in the given number of
+    // slices of out, which are done in the shared thread pool.
+    template <typename I, typename O>
+    void parallel_merge(I a, I m, I b, O out, uint32 threads) {
+        size_t left = std::distance(a, m);
+        size_t right = std::distance(m, b);
+        size_t n = left + right;
+        tool::thread_pool::shared().parallel_for(0, threads, [=](size_t t) {
+            size_t d = n * t / threads;
+            size_t e = n * (t + 1) / threads;
+            size_t i = co_rank(a, left, m, right, d);
+            size_t j = co_rank(a, left, m, right, e);
+            merge(a + i, a + j, m + (d - i), m + (e - j), out + d);
+        }, 1);
+    }
+
+    template <typename I, typename O>
+    void parallel_move(I begin, I end, O out, uint32 threads) {
+        size_t n = std::distance(begin, end);
+        tool::thread_pool::shared().parallel_for(0, threads, [=](size_t t) {
+            std::move(begin + n * t / threads, begin + n * (t + 1) / threads, out + n * t / threads);
+        }, 1);
+    }
+
+    // the halves are sorted at the same time and then merged into
+    // the buffer, with the work of the merge split between threads.
+    template <typename I, typename B>
+    void parallel_merge_sort(I begin, I end, B buffer, uint32 threads, size_t min_split) {
+        size_t n = std::distance(begin, end);
+        if (threads < 2 || n < min_split) return merge_sort(begin, end, buffer);
+
+        size_t half = n / 2;
+        uint32 t = threads / 2;
+        tool::future<void> l = tool::thread_pool::shared().spawn([begin, buffer, half, t, min_split]() {
+            parallel_merge_sort(begin, begin + half, buffer, t, min_split);
+        });
+        parallel_merge_sort(begin + half, end, buffer + half, threads - t, min_split);
+        l.get();
+
+        parallel_merge(begin, begin + half, end, buffer, threads);
+        parallel_move(buffer, buffer + n, begin, threads);
+    }
+
+    template <typename L>
+    using element = std::remove_const_t<std::remove_reference_t<decltype(std::declval<const L>().first())>>;
+
+    template <typename L>
+    std::vector<element<L>> elements(L list) {
+        std::vector<element<L>> v{};
+        v.reserve(data::size(list));
+        while (!data::empty(list)) {
+            v.push_back(data::first(list));
+            list = data::rest(list);
+        }
+        return v;
+    }
+
+    // built from the back so that it works for queues as well.
+    template <typename L, typename I>
+    L stack_from(I begin, I end) {
+        L l{};
+        while (end != begin) l = data::prepend(l, *--end);
+        return l;
+    }
 
 }
 
 namespace data {
-    
+
     template <typename X> X merge_sort(const X& a) {
         if (data::size(a) < 2) return a;
-        return *sort::merge<X, list::linked<X>>{a};
+        auto v = sorting::elements(a);
+        auto buffer = v;
+        sorting::merge_sort(v.begin(), v.end(), buffer.begin());
+        return sorting::stack_from<X>(v.begin(), v.end());
     }
-    
+
+    // for stacks that are mostly in order already.
+    template <typename X> X natural_merge_sort(const X& a) {
+        if (data::size(a) < 2) return a;
+        auto v = sorting::elements(a);
+        auto buffer = v;
+        sorting::natural_merge_sort(v.begin(), v.end(), buffer.begin());
+        return sorting::stack_from<X>(v.begin(), v.end());
+    }
+
+    // for contiguous containers such as bytes and cross<X>. Ranges
+    // smaller than min_split are sorted in one thread.
+    template <typename X> X parallel_merge_sort(X x,
+        uint32 threads = std::thread::hardware_concurrency(),
+        size_t min_split = 1 << 16) {
+        auto buffer = std::vector<std::remove_reference_t<decltype(*x.begin())>>(x.begin(), x.end());
+        sorting::parallel_merge_sort(x.begin(), x.end(), buffer.begin(), threads, min_split);
+        return x;
+    }
+
 }
 
 #endif
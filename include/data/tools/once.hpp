@@ -0,0 +1,81 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef DATA_TOOLS_ONCE
+#define DATA_TOOLS_ONCE
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <data/types.hpp>
+
+namespace data::tool {
+
+    // runs a computation once for a memoized value, as std::call_once
+    // does, but without relying on call_once to run it again after it
+    // throws, which not every implementation does.
+    //
+    // If the computation throws, the exception is kept and thrown in
+    // every thread that was waiting for that attempt to finish. A thread
+    // that comes along after it failed tries again.
+    class once {
+        enum state : byte {pending, running, done, failed};
+
+        std::atomic<state> State;
+        std::mutex Mutex;
+        std::condition_variable Finished;
+        std::exception_ptr Failure;
+
+    public:
+        once() : State{pending}, Mutex{}, Finished{}, Failure{} {}
+
+        once(const once&) = delete;
+        once& operator=(const once&) = delete;
+
+        // true once a call has returned without throwing. Anything
+        // that the computation wrote is visible to the caller.
+        bool finished() const {
+            return State.load(std::memory_order_acquire) == done;
+        }
+
+        template <typename F> void operator()(F f);
+    };
+
+    template <typename F> void once::operator()(F f) {
+        if (finished()) return;
+
+        std::unique_lock<std::mutex> lock{Mutex};
+        bool waited = false;
+        while (State.load(std::memory_order_relaxed) == running) {
+            waited = true;
+            Finished.wait(lock);
+        }
+
+        state s = State.load(std::memory_order_relaxed);
+        if (s == done) return;
+        if (s == failed && waited) std::rethrow_exception(Failure);
+
+        State.store(running, std::memory_order_relaxed);
+        lock.unlock();
+
+        try {
+            f();
+        } catch (...) {
+            lock.lock();
+            Failure = std::current_exception();
+            State.store(failed, std::memory_order_relaxed);
+            Finished.notify_all();
+            throw;
+        }
+
+        lock.lock();
+        Failure = nullptr;
+        State.store(done, std::memory_order_release);
+        Finished.notify_all();
+    }
+
+}
+
+#endif
@@ -5,200 +5,226 @@
 #ifndef DATA_TOOLS_ORDERED_LIST
 #define DATA_TOOLS_ORDERED_LIST
 
-#include <milewski/OrdList/OrdList.hpp>
+#include <iterator>
+#include <data/tools/indexed_list.hpp>
 #include <data/tools/functional_queue.hpp>
 #include <data/tools/linked_stack.hpp>
-    
+
 namespace data::tool {
-    
-    template <typename element> 
+
+    // a sorted persistent sequence. It is an indexed_list whose
+    // elements are kept in order, so insert finds its place by
+    // binary search and costs O(log n), as do rest, last and [].
+    // Equal elements are kept in the order they were inserted,
+    // with the newest first.
+    template <typename element>
     class ordered_list {
-        uint32 Size;
-        milewski::okasaki::OrdList<element> Ordered;
+        indexed_list<element> Ordered;
+
+        explicit ordered_list(const indexed_list<element>& o) : Ordered{o} {}
+
+        struct merger;
     public:
         ordered_list();
         explicit ordered_list(const functional_queue<linked_stack<element>>& l);
-        
+
+        // O(n) if the range is already sorted and O(n log n) otherwise.
+        template <typename I>
+        static ordered_list from(I begin, I end);
+
         bool empty() const;
         size_t size() const;
-        
+
         bool valid() const;
-        
+
         ordered_list insert(const element& x) const;
         ordered_list operator<<(const element& x) const;
         ordered_list operator<<(const linked_stack<element> l) const;
-        
+
+        // O(n + m).
+        ordered_list merge(const ordered_list& l) const;
+
         ordered_list rest() const;
         const element& first() const;
-        
+
         const element& operator[](uint32 n) const;
-        
+
         const element& last() const;
-        
+
         template <typename seq>
         bool operator==(const seq& x) const;
-        
+
         template <typename seq>
         bool operator!=(const seq& x) const;
-        
-        struct const_iterator {
-            const_iterator() : Ordered{} {}
-            
-            const element& operator*() const;
-            
-            const_iterator& operator++();
-            bool operator==(const const_iterator) const;
-            bool operator!=(const const_iterator) const;
-        private:
-            milewski::okasaki::OrdList<element> Ordered;
-            const_iterator(milewski::okasaki::OrdList<element> o) : Ordered{o} {}
-            
-            friend class ordered_list;
-        };
-        
+
+        using const_iterator = typename indexed_list<element>::const_iterator;
+        using iterator = const_iterator;
+
         const_iterator begin() const {
-            return const_iterator{Ordered};
+            return Ordered.begin();
         }
-        
+
         const_iterator end() const {
-            return const_iterator{};
+            return Ordered.end();
         }
-        
-    private:
-        const element& last_private() const;
-        
-        ordered_list(uint32 size, milewski::okasaki::OrdList<element> ordered);
     };
 
     template <typename element>
     std::ostream& operator<<(std::ostream& o, const data::tool::ordered_list<element>& l) {
         o << "ordered_list{";
-        if (!l.empty()) {
-            data::tool::ordered_list<element> x = l;
-            while(true) {
-                o << x.first();
-                x = x.rest();
-                if (x.empty()) break;
-                o << ", ";
-            }
+        auto i = l.begin();
+        if (i != l.end()) while (true) {
+            o << *i;
+            ++i;
+            if (i == l.end()) break;
+            o << ", ";
         }
         return o << "}";
     }
-    
+
+    // walks two sorted lists at once, so that the merged sequence
+    // can be given to indexed_list::from without being stored.
+    template <typename element>
+    struct ordered_list<element>::merger {
+        using value_type = std::remove_const_t<std::remove_reference_t<element>>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type*;
+        using reference = const element&;
+        using iterator_category = std::forward_iterator_tag;
+
+        const_iterator A;
+        const_iterator AEnd;
+        const_iterator B;
+        const_iterator BEnd;
+
+        // the element on the right goes first if it is less, which
+        // preserves the order of equal elements in this list.
+        bool right() const {
+            return A == AEnd || (B != BEnd && *B < *A);
+        }
+
+        const element& operator*() const {
+            return right() ? *B : *A;
+        }
+
+        merger& operator++() {
+            if (right()) ++B;
+            else ++A;
+            return *this;
+        }
+
+        bool operator==(const merger& m) const {
+            return A == m.A && B == m.B;
+        }
+
+        bool operator!=(const merger& m) const {
+            return !(*this == m);
+        }
+    };
+
     template <typename element>
     bool ordered_list<element>::valid() const {
-        if (empty()) return true;
-        if (!data::valid(first())) return false;
-        return rest().valid();
+        return Ordered.valid();
     }
-    
+
     template <typename element>
-    inline ordered_list<element>::ordered_list() : Size{0}, Ordered{} {}
-        
+    inline ordered_list<element>::ordered_list() : Ordered{} {}
+
     template <typename element>
     ordered_list<element>::ordered_list(const functional_queue<linked_stack<element>>& l) : ordered_list{} {
         functional_queue<linked_stack<element>> g = l;
         while(!data::empty(g)) {
-            *this << g.first();
+            *this = *this << g.first();
             g = g.rest();
         }
     }
-        
+
+    template <typename element>
+    template <typename I>
+    ordered_list<element> ordered_list<element>::from(I begin, I end) {
+        if (std::is_sorted(begin, end)) return ordered_list{indexed_list<element>::from(begin, end)};
+        ordered_list x{};
+        for (I i = begin; i != end; ++i) x = x << *i;
+        return x;
+    }
+
     template <typename element>
     template <typename seq>
     bool ordered_list<element>::operator==(const seq& x) const {
-        if (Size != x.size()) return false;
-        if (Size == 0) return true;
-        if (first() != x.first()) return false;
-        return rest() == x.rest();
+        if (size() != x.size()) return false;
+        seq y = x;
+        for (const element& e : Ordered) {
+            if (!(e == y.first())) return false;
+            y = y.rest();
+        }
+        return true;
     }
-    
+
     template <typename element>
     template <typename seq>
     bool ordered_list<element>::operator!=(const seq& x) const {
         return !operator==(x);
     }
-    
+
     template <typename element>
-    bool ordered_list<element>::empty() const {
-        return Size == 0;
+    inline bool ordered_list<element>::empty() const {
+        return Ordered.empty();
     }
-    
+
     template <typename element>
-    size_t ordered_list<element>::size() const {
-        return Size;
+    inline size_t ordered_list<element>::size() const {
+        return Ordered.size();
     }
-    
+
     template <typename element>
     ordered_list<element> ordered_list<element>::insert(const element& x) const {
-        return {Size + 1, Ordered.inserted(x)};
+        return ordered_list{Ordered.insert(Ordered.partition_point([&x](const element& e) -> bool {
+            return e < x;
+        }), x)};
     }
-    
+
     template <typename element>
-    ordered_list<element> ordered_list<element>::operator<<(const element& x) const {
-        return {Size + 1, Ordered.inserted(x)};
+    inline ordered_list<element> ordered_list<element>::operator<<(const element& x) const {
+        return insert(x);
     }
-    
+
     template <typename element>
     ordered_list<element> ordered_list<element>::operator<<(const linked_stack<element> l) const {
-        if (l.empty()) return *this;
-        return *this << l.first() << l.rest();
+        ordered_list x = *this;
+        for (const element& e : l) x = x.insert(e);
+        return x;
     }
-    
-    template <typename element>
-    ordered_list<element> ordered_list<element>::rest() const {
-        if (Size == 0) return {};
-        return {Size - 1, Ordered.popped_front()};
-    }
-    
-    template <typename element>
-    const element& ordered_list<element>::first() const {
-        return Ordered.front();
-    }
-    
-    template <typename element>
-    const element& ordered_list<element>::operator[](uint32 n) const {
-        if (n >= Size) throw std::out_of_range{"ordered list"};
-        if (n == 0) return first();
-        return rest()[n - 1];
-    }
-    
-    template <typename element>
-    const element& ordered_list<element>::last() const {
-        if (Size == 0) throw std::out_of_range{"ordered list"};
-        return last_private();
-    }
-    
+
     template <typename element>
-    const element& ordered_list<element>::last_private() const {
-        if (Size == 1) return first();
-        return rest().last_private();
+    ordered_list<element> ordered_list<element>::merge(const ordered_list& l) const {
+        if (l.empty()) return *this;
+        if (empty()) return l;
+        return ordered_list{indexed_list<element>::from(
+            merger{begin(), end(), l.begin(), l.end()},
+            merger{end(), end(), l.end(), l.end()})};
     }
-    
+
     template <typename element>
-    inline const element& ordered_list<element>::const_iterator::operator*() const {
-        return Ordered.front();
+    inline ordered_list<element> ordered_list<element>::rest() const {
+        return ordered_list{Ordered.rest()};
     }
-    
+
     template <typename element>
-    inline bool ordered_list<element>::const_iterator::operator==(const const_iterator i) const {
-        return Ordered == i.Ordered;
+    inline const element& ordered_list<element>::first() const {
+        return Ordered.first();
     }
-    
+
     template <typename element>
-    inline bool ordered_list<element>::const_iterator::operator!=(const const_iterator i) const {
-        return !(*this == i);
+    inline const element& ordered_list<element>::operator[](uint32 n) const {
+        if (n >= size()) throw std::out_of_range{"ordered list"};
+        return Ordered[n];
     }
-    
+
     template <typename element>
-    typename ordered_list<element>::const_iterator& ordered_list<element>::const_iterator::operator++() {
-        if (!Ordered.isEmpty()) Ordered = Ordered.popped_front();
-        return *this;
+    inline const element& ordered_list<element>::last() const {
+        if (empty()) throw std::out_of_range{"ordered list"};
+        return Ordered.last();
     }
-    
-    template <typename element>
-    ordered_list<element>::ordered_list(uint32 size, milewski::okasaki::OrdList<element> ordered) : Size{size}, Ordered{ordered} {}
 }
 
 #endif
-
@@ -0,0 +1,214 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef DATA_TOOLS_PAIRING_HEAP
+#define DATA_TOOLS_PAIRING_HEAP
+
+#include <data/types.hpp>
+#include <data/tools/allocation.hpp>
+
+namespace data::tool {
+
+    // a persistent pairing heap. insert and merge take O(1) and
+    // a heap can be built from n elements in O(n). rest takes
+    // O(log n) amortized, so long as old versions are not popped
+    // again. If they must be, use the leftist heap, which takes
+    // O(log n) in the worst case.
+    //
+    // Elements are ordered with <=, as with the leftist heap,
+    // so that the first element is the least.
+    //
+    // Nodes are kept as a binary tree in which the left link
+    // goes to the first child and the right link to the next
+    // sibling. The root of a heap never has a sibling.
+    template <typename elem, typename alloc = allocation::shared>
+    class pairing_heap {
+        struct node;
+        using next = typename alloc::template pointer<node>;
+
+        struct node {
+            elem Value;
+            next Child;
+            next Sibling;
+
+            node(const elem& v, next c, next s) : Value{v}, Child{c}, Sibling{s} {}
+        };
+
+        next Root;
+        size_t Size;
+
+        pairing_heap(next r, size_t size) : Root{r}, Size{size} {}
+
+        // a new root holding the value of a whose first child is
+        // b. The siblings of a and b are not looked at.
+        static next link(const next& a, const next& b, const next& sibling);
+        static next meld(const next& a, const next& b, const next& sibling);
+
+    public:
+        pairing_heap() : Root{}, Size{0} {}
+        explicit pairing_heap(const elem& x) : Root{alloc::template make<node>(x, nullptr, nullptr)}, Size{1} {}
+
+        pairing_heap(const pairing_heap&) = default;
+        pairing_heap(pairing_heap&&) = default;
+        pairing_heap& operator=(const pairing_heap&);
+        pairing_heap& operator=(pairing_heap&&);
+
+        // nodes which are not shared are destroyed in a loop.
+        ~pairing_heap();
+
+        // the least element becomes the root and all the others
+        // become its children. The work of sorting them is put
+        // off until the first call to rest.
+        template <typename it>
+        static pairing_heap from(it begin, it end);
+
+        bool empty() const;
+        size_t size() const;
+
+        const elem& first() const;
+        pairing_heap rest() const;
+
+        pairing_heap insert(const elem& x) const;
+        pairing_heap merge(const pairing_heap& h) const;
+    };
+
+    // the old root is left to the destructor of the argument.
+    template <typename elem, typename alloc>
+    inline pairing_heap<elem, alloc>& pairing_heap<elem, alloc>::operator=(const pairing_heap& h) {
+        pairing_heap x{h};
+        std::swap(Root, x.Root);
+        std::swap(Size, x.Size);
+        return *this;
+    }
+
+    template <typename elem, typename alloc>
+    inline pairing_heap<elem, alloc>& pairing_heap<elem, alloc>::operator=(pairing_heap&& h) {
+        std::swap(Root, h.Root);
+        std::swap(Size, h.Size);
+        return *this;
+    }
+
+    template <typename elem, typename alloc>
+    pairing_heap<elem, alloc>::~pairing_heap() {
+        // unique nodes are rotated so that a child becomes the
+        // parent of its former parent, which then has one fewer
+        // child. Thus no stack is needed.
+        next n = std::move(Root);
+        while (n != nullptr && n.use_count() == 1) {
+            node& m = *n;
+            if (m.Child == nullptr) {
+                next s = std::move(m.Sibling);
+                n = std::move(s);
+            } else if (m.Child.use_count() != 1) m.Child = nullptr;
+            else {
+                next c = std::move(m.Child);
+                m.Child = std::move(c->Sibling);
+                c->Sibling = std::move(n);
+                n = std::move(c);
+            }
+        }
+    }
+
+    template <typename elem, typename alloc>
+    inline typename pairing_heap<elem, alloc>::next
+    pairing_heap<elem, alloc>::link(const next& a, const next& b, const next& sibling) {
+        return alloc::template make<node>(a->Value, alloc::template make<node>(b->Value, b->Child, a->Child), sibling);
+    }
+
+    template <typename elem, typename alloc>
+    inline typename pairing_heap<elem, alloc>::next
+    pairing_heap<elem, alloc>::meld(const next& a, const next& b, const next& sibling) {
+        return a->Value <= b->Value ? link(a, b, sibling) : link(b, a, sibling);
+    }
+
+    template <typename elem, typename alloc>
+    template <typename it>
+    pairing_heap<elem, alloc> pairing_heap<elem, alloc>::from(it begin, it end) {
+        if (begin == end) return {};
+        it least = begin;
+        for (it i = begin; i != end; ++i) if (!(*least <= *i)) least = i;
+        next children{};
+        size_t size = 1;
+        for (it i = begin; i != end; ++i) if (i != least) {
+            children = alloc::template make<node>(*i, nullptr, children);
+            size++;
+        }
+        return pairing_heap{alloc::template make<node>(*least, children, nullptr), size};
+    }
+
+    template <typename elem, typename alloc>
+    inline bool pairing_heap<elem, alloc>::empty() const {
+        return Root == nullptr;
+    }
+
+    template <typename elem, typename alloc>
+    inline size_t pairing_heap<elem, alloc>::size() const {
+        return Size;
+    }
+
+    template <typename elem, typename alloc>
+    inline const elem& pairing_heap<elem, alloc>::first() const {
+        return Root->Value;
+    }
+
+    // the two-pass merge. The first pass melds the children in
+    // pairs from left to right. The results are chained through
+    // their sibling links, so they come out in reverse order,
+    // which is the order in which the second pass melds them.
+    // No other heap can see the nodes made by the first pass,
+    // so the second pass links them in place.
+    template <typename elem, typename alloc>
+    pairing_heap<elem, alloc> pairing_heap<elem, alloc>::rest() const {
+        if (Size <= 1) return {};
+        if (Root->Child->Sibling == nullptr) return pairing_heap{Root->Child, Size - 1};
+
+        next pairs{};
+        const next* current = &Root->Child;
+        while (*current != nullptr) {
+            const next& n = (*current)->Sibling;
+            if (n == nullptr) {
+                pairs = alloc::template make<node>((*current)->Value, (*current)->Child, pairs);
+                break;
+            }
+
+            pairs = meld(*current, n, pairs);
+            current = &n->Sibling;
+        }
+
+        next h = std::move(pairs);
+        next p = std::move(h->Sibling);
+        while (p != nullptr) {
+            next q = std::move(p->Sibling);
+            if (h->Value <= p->Value) {
+                p->Sibling = std::move(h->Child);
+                h->Child = std::move(p);
+            } else {
+                h->Sibling = std::move(p->Child);
+                p->Child = std::move(h);
+                h = std::move(p);
+            }
+            p = std::move(q);
+        }
+
+        return pairing_heap{h, Size - 1};
+    }
+
+    template <typename elem, typename alloc>
+    pairing_heap<elem, alloc> pairing_heap<elem, alloc>::insert(const elem& x) const {
+        if (empty()) return pairing_heap{x};
+        if (x <= Root->Value) return pairing_heap{alloc::template make<node>(x, Root, nullptr), Size + 1};
+        return pairing_heap{alloc::template make<node>(Root->Value,
+            alloc::template make<node>(x, nullptr, Root->Child), nullptr), Size + 1};
+    }
+
+    template <typename elem, typename alloc>
+    inline pairing_heap<elem, alloc> pairing_heap<elem, alloc>::merge(const pairing_heap& h) const {
+        if (h.empty()) return *this;
+        if (empty()) return h;
+        return pairing_heap{meld(Root, h.Root, nullptr), Size + h.Size};
+    }
+
+}
+
+#endif
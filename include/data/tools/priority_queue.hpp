@@ -5,64 +5,116 @@
 #ifndef DATA_TOOLS_PRIORITY_QUEUE
 #define DATA_TOOLS_PRIORITY_QUEUE
 
+#include <vector>
 #include <milewski/Leftist/LeftistHeap.hpp>
 #include <data/tools/linked_stack.hpp>
+#include <data/tools/pairing_heap.hpp>
     
 namespace data::tool {
     
-    template <typename x, typename stack>
-    class priority_queue {
+    // Milewski's leftist heap with the interface of pairing_heap.
+    // Every operation takes O(log n) in the worst case, even on
+    // old versions.
+    template <typename x>
+    class leftist_heap {
         using heap = milewski::okasaki::Heap<x>;
         heap Heap;
-        uint32 Size;
-        priority_queue(heap h, uint32 size) : Heap{h}, Size{size} {}
+        size_t Size;
+        leftist_heap(heap h, size_t size) : Heap{h}, Size{size} {}
     public:
+        leftist_heap() : Heap{}, Size{0} {}
+        
+        template <typename it>
+        static leftist_heap from(it begin, it end) {
+            std::vector<x> v(begin, end);
+            return {heap::heapify(v.begin(), v.end()), v.size()};
+        }
+        
+        bool empty() const {
+            return Size == 0;
+        }
+        
         size_t size() const {
             return Size;
         }
         
+        const x& first() const {
+            return Heap.front();
+        }
+        
+        leftist_heap rest() const {
+            return {Heap.popped_front(), Size - 1};
+        }
+        
+        leftist_heap insert(const x& elem) const {
+            return {Heap.inserted(elem), Size + 1};
+        }
+        
+        leftist_heap merge(const leftist_heap& h) const {
+            return {heap::merged(Heap, h.Heap), Size + h.Size};
+        }
+    };
+    
+    // the heap may be leftist_heap, which is the default, or 
+    // pairing_heap, which is faster but only amortized. 
+    template <typename x, typename stack, typename heap = leftist_heap<x>>
+    class priority_queue {
+        heap Heap;
+        priority_queue(heap h) : Heap{h} {}
+    public:
+        size_t size() const {
+            return Heap.size();
+        }
+        
         bool empty() const {
-            return Size == 0;
+            return Heap.empty();
         }
         
-        priority_queue() : Heap{}, Size{0} {}
-        priority_queue(std::initializer_list<x> init) : Heap{init}, Size{init.size()} {}
+        priority_queue() : Heap{} {}
+        priority_queue(std::initializer_list<x> init) : Heap{heap::from(init.begin(), init.end())} {}
             
         const x& first() const {
-            return Heap.front();
+            return Heap.first();
         }
         
         priority_queue rest() const {
-            return {Heap.popped_front(), Size - 1};
+            return {Heap.rest()};
         }
         
         priority_queue insert(x elem) const {
-            return {Heap.inserted(elem), Size + 1};
+            return {Heap.insert(elem)};
         }
         
         template <typename List>
         priority_queue insert(List l) const {
-            static interface::sequence<List> is_list{};
-            if (l.empty()) return *this;
-            return insert(l.first()).insert(l.rest());
+            return merge(priority_queue{l});
         }
         
+        priority_queue merge(const priority_queue& q) const {
+            return {Heap.merge(q.Heap)};
+        }
+        
+        // built all at once, which takes O(n). 
         template <typename List>
-        priority_queue(List l) : priority_queue{priority_queue{}.insert(l)} {}
+        priority_queue(List l) : Heap{} {
+            static interface::sequence<List> is_list{};
+            std::vector<x> v{};
+            for (; !l.empty(); l = l.rest()) v.push_back(l.first());
+            Heap = heap::from(v.begin(), v.end());
+        }
         
+        // the values in order, as a stack. 
         stack values() const {
+            std::vector<x> v{};
+            v.reserve(size());
+            for (heap p = Heap; !p.empty(); p = p.rest()) v.push_back(p.first());
             stack vals;
-            auto p = *this;
-            while (!p.empty()) {
-                vals = vals << p.first();
-                p = p.rest();
-            }
-            return reverse(vals);
+            for (auto i = v.rbegin(); i != v.rend(); ++i) vals = vals << *i;
+            return vals;
         }
         
         priority_queue& operator=(const priority_queue& q) {
             Heap = q.Heap;
-            Size = q.Size;
             return *this;
         }
         
@@ -5,17 +5,25 @@
 #ifndef DATA_RATE_LIMITER_H
 #define DATA_RATE_LIMITER_H
 
+#include <mutex>
 #include "circular_queue.h"
 
 namespace data {
     namespace tools {
+        // allows hits calls in any duration seconds. getTime returns how
+        // many seconds to wait before going ahead. It is safe to call from
+        // several threads. See tool::token_bucket for a lock-free limiter
+        // with a finer resolution.
         class rate_limiter {
         public:
             explicit rate_limiter(int hits, int duration) : m_queue(hits, -1), m_duration(duration) {};
             long getTime();
+            // now is in seconds since the epoch of std::chrono::steady_clock.
+            long getTime(long now);
         private:
             circular_queue m_queue;
             int m_duration;
+            std::mutex m_mutex;
         };
     }
 }
@@ -5,6 +5,7 @@
 #ifndef DATA_MAP_RB
 #define DATA_MAP_RB
 
+#include <vector>
 #include <data/tools/ordered_list.hpp>
 #include <data/map.hpp>
 #include <data/fold.hpp>
@@ -18,9 +19,8 @@ namespace data::tool {
         using map = milewski::okasaki::RBMap<K, V>;
     private:
         map Map;
-        size_t Size;
         
-        rb_map(map m, size_t x) : Map{m}, Size{x} {}
+        rb_map(map m) : Map{m} {}
         
     public:
         const V& operator[](const K& k) const;
@@ -35,19 +35,45 @@ namespace data::tool {
         rb_map remove(const K& k) const;
         rb_map remove(const entry& e) const;
         
+        // set operations by split and join, O(m log(n/m + 1)) 
+        // for maps of sizes m <= n. Subtrees that are not 
+        // affected are shared with the inputs. 
+        
+        // all entries of both maps. Where both maps have 
+        // a key, the value from m is kept. 
+        rb_map insert(const rb_map& m) const;
+        
+        // entries whose keys are also in m. 
+        rb_map intersect(const rb_map& m) const;
+        
+        // entries whose keys are not in m. 
+        rb_map remove(const rb_map& m) const;
+        
+        // also checks the red-black invariants, even where 
+        // the asserts in RBMap are compiled out. 
         bool valid() const {
-            return values().valid();
+            return Map.isRedBlack() && values().valid();
         }
         
         bool empty() const;
         size_t size() const;
         
-        rb_map() : Map{}, Size{0} {}
+        rb_map() : Map{} {}
         rb_map(const entry& e) : rb_map{rb_map{} << e} {}
         rb_map(const K& k, const V& v) : rb_map{entry{k, v}} {}
         
         rb_map(std::initializer_list<std::pair<K, V>> init);
         
+        // build a map in O(n) from entries whose keys are 
+        // strictly increasing. 
+        template <typename I>
+        static rb_map from_sorted(I begin, I end);
+        
+        // build a map in O(n) from strictly increasing keys 
+        // which are all given the same value. 
+        template <typename I>
+        static rb_map from_sorted_keys(I begin, I end, const V& v);
+        
         const ordered_list<K> keys() const;
         
         const ordered_list<entry> values() const;
@@ -58,11 +84,93 @@ namespace data::tool {
             return !(*this == map);
         }
         
-        using const_iterator = typename ordered_list<entry>::const_iterator;
+        // iterates over entries in order of their keys without 
+        // allocating. Entries are returned by value because the
+        // tree stores keys and values separately, so this is only 
+        // an input iterator. Use key() and value() for references 
+        // into the tree. 
+        struct const_iterator {
+            using value_type = entry;
+            using difference_type = int;
+            using pointer = void;
+            using reference = entry;
+            using iterator_category = std::input_iterator_tag;
+            
+            const_iterator() : It{} {}
+            
+            entry operator*() const {
+                return entry{It.key(), It.value()};
+            }
+            
+            const K& key() const {
+                return It.key();
+            }
+            
+            const V& value() const {
+                return It.value();
+            }
+            
+            const_iterator& operator++() {
+                ++It;
+                return *this;
+            }
+            
+            const_iterator operator++(int) {
+                const_iterator i = *this;
+                ++It;
+                return i;
+            }
+            
+            bool operator==(const const_iterator& i) const {
+                return It == i.It;
+            }
+            
+            bool operator!=(const const_iterator& i) const {
+                return It != i.It;
+            }
+            
+        private:
+            typename map::Iterator It;
+            const_iterator(typename map::Iterator i) : It{i} {}
+            friend struct rb_map;
+        };
         
         const_iterator begin() const;
         const_iterator end() const;
         
+        // first entry whose key is not less than k. 
+        const_iterator lower_bound(const K& k) const;
+        
+        // first entry whose key is greater than k. 
+        const_iterator upper_bound(const K& k) const;
+        
+        // the entries with keys in [Min, Max], in order. 
+        struct range {
+            const_iterator Begin;
+            const_iterator End;
+            
+            const_iterator begin() const {
+                return Begin;
+            }
+            
+            const_iterator end() const {
+                return End;
+            }
+        };
+        
+        // O(log n) to find the ends of the range, 
+        // then O(1) amortized per entry. 
+        range scan(const K& min, const K& max) const;
+        
+        // look up a range of queries whose keys, given by key(x), are 
+        // in increasing order, in one walk of the tree, which takes 
+        // O(m log(n/m + 1)) for m queries. found(x, v) is called for 
+        // every x whose key is in the map. See find_all.hpp. 
+        template <typename I, typename key, typename F>
+        void find_sorted(I begin, I end, key k, F found) const {
+            Map.findSorted(begin, end, k, found);
+        }
+        
     };
     
     template <typename K, typename V>
@@ -71,7 +179,7 @@ namespace data::tool {
     }
     
     template <typename K, typename V>
-    inline rb_map<K, V>::rb_map(std::initializer_list<std::pair<K, V> > init) : Map{}, Size{0} {
+    inline rb_map<K, V>::rb_map(std::initializer_list<std::pair<K, V> > init) : Map{} {
         for (auto p : init) *this = insert(p.first, p.second);
     }
     
@@ -79,34 +187,29 @@ namespace data::tool {
     bool rb_map<K, V>::operator==(const rb_map& map) const {
         if (this == &map) return true;
         if (size() != map.size()) return false;
-        auto a = map.begin();
-        for (auto b = begin(); b != end(); ++b) {
-            if (*a != *b) return false;
+        auto a = map.Map.begin();
+        for (auto b = Map.begin(); b != Map.end(); ++b) {
+            if (a.key() != b.key() || a.value() != b.value()) return false;
             ++a;
         }
         return true;
     }
     
+    // the map is already in order, so the lists are built directly.
     template <typename K, typename V>
     const ordered_list<K> rb_map<K, V>::keys() const {
-        linked_stack<K> kk{};
-        milewski::okasaki::forEach(Map, [&kk](const K& k, V) -> void {
-            kk = kk << k;
-        });
-        ordered_list<K> x{};
-        for (const auto& k : data::reverse(kk)) x = x << k;
-        return x;
+        std::vector<K> kk{};
+        kk.reserve(size());
+        for (auto i = Map.begin(); i != Map.end(); ++i) kk.push_back(i.key());
+        return ordered_list<K>::from(kk.begin(), kk.end());
     }
     
     template <typename K, typename V>
     const ordered_list<entry<K, V>> rb_map<K, V>::values() const {
-        linked_stack<entry> kk{};
-        milewski::okasaki::forEach(Map, [&kk](const K& k, V v) -> void {
-            kk = kk << entry{k, v};
-        });
-        ordered_list<entry> x{};
-        for (const auto& e : data::reverse(kk)) x = x << e;
-        return x;
+        std::vector<entry> kk{};
+        kk.reserve(size());
+        for (auto i = Map.begin(); i != Map.end(); ++i) kk.push_back(entry{i.key(), i.value()});
+        return ordered_list<entry>::from(kk.begin(), kk.end());
     }
     
     template <typename K, typename V>
@@ -127,11 +230,11 @@ namespace data::tool {
     
     template <typename K, typename V>
     inline rb_map<K, V> rb_map<K, V>::insert(const K& k, const V& v) const {
-        V already = operator[](k);
-        if (already == V{}) return rb_map{Map.inserted(k, v), Size + 1};
-        if (already == v) return *this;
-        rb_map removed = this->remove(k);
-        return rb_map{removed.Map.inserted(k, v), removed.Size + 1};
+        if (!Map.member(k)) return rb_map{Map.inserted(k, v)};
+        if (Map.findWithDefault(v, k) == v) return *this;
+        return rb_map{Map.insertedWith(k, v, [](const V&, const V& replacement) -> V {
+            return replacement;
+        })};
     }
     
     template <typename K, typename V>
@@ -139,13 +242,47 @@ namespace data::tool {
         return insert(e.Key, e.Value);
     }
     
-    // there's a more efficient way of doing this. 
-    // See matt.might.net/articles/red-black-delete/ 
     template <typename K, typename V>
     inline rb_map<K, V> rb_map<K, V>::remove(const K& k) const {
-        rb_map m{};
-        for (auto x = begin(); x != end(); ++x) if ((*x).Key != k) m = m.insert(*x);
-        return m;
+        if (!Map.member(k)) return *this;
+        return rb_map{Map.removed(k)};
+    }
+    
+    template <typename K, typename V>
+    inline rb_map<K, V> rb_map<K, V>::insert(const rb_map& m) const {
+        return rb_map{map::united(m.Map, Map)};
+    }
+    
+    template <typename K, typename V>
+    inline rb_map<K, V> rb_map<K, V>::intersect(const rb_map& m) const {
+        return rb_map{map::intersected(Map, m.Map)};
+    }
+    
+    template <typename K, typename V>
+    inline rb_map<K, V> rb_map<K, V>::remove(const rb_map& m) const {
+        return rb_map{map::subtracted(Map, m.Map)};
+    }
+    
+    template <typename K, typename V>
+    template <typename I>
+    inline rb_map<K, V> rb_map<K, V>::from_sorted(I begin, I end) {
+        return rb_map{map::fromSorted(begin, end, 
+            [](const entry& e) -> const K& {
+                return e.Key;
+            }, [](const entry& e) -> const V& {
+                return e.Value;
+            })};
+    }
+    
+    template <typename K, typename V>
+    template <typename I>
+    inline rb_map<K, V> rb_map<K, V>::from_sorted_keys(I begin, I end, const V& v) {
+        return rb_map{map::fromSorted(begin, end, 
+            [](const K& k) -> const K& {
+                return k;
+            }, [&v](const K&) -> const V& {
+                return v;
+            })};
     }
     
     template <typename K, typename V>
@@ -165,17 +302,33 @@ namespace data::tool {
     
     template <typename K, typename V>
     inline size_t rb_map<K, V>::size() const {
-        return Size;
+        return Map.size();
     }
     
     template <typename K, typename V>
     inline typename rb_map<K, V>::const_iterator rb_map<K, V>::begin() const {
-        return values().begin();
+        return const_iterator{Map.begin()};
     } 
     
     template <typename K, typename V>
     inline typename rb_map<K, V>::const_iterator rb_map<K, V>::end() const {
-        return values().end();
+        return const_iterator{Map.end()};
+    }
+    
+    template <typename K, typename V>
+    inline typename rb_map<K, V>::const_iterator rb_map<K, V>::lower_bound(const K& k) const {
+        return const_iterator{Map.lowerBound(k)};
+    }
+    
+    template <typename K, typename V>
+    inline typename rb_map<K, V>::const_iterator rb_map<K, V>::upper_bound(const K& k) const {
+        return const_iterator{Map.upperBound(k)};
+    }
+    
+    template <typename K, typename V>
+    inline typename rb_map<K, V>::range rb_map<K, V>::scan(const K& min, const K& max) const {
+        if (max < min) return range{end(), end()};
+        return range{lower_bound(min), upper_bound(max)};
     }
     
 }
@@ -0,0 +1,242 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef DATA_TOOLS_REAL_TIME_QUEUE
+#define DATA_TOOLS_REAL_TIME_QUEUE
+
+#include <data/list.hpp>
+#include <data/tools/lazy.hpp>
+#include <data/tools/linked_stack.hpp>
+#include <data/tools/functional_queue.hpp>
+
+namespace data::tool {
+
+    // Okasaki's real-time queue. The front is a lazy stream and
+    // the rear is an ordinary stack. Rather than reversing the
+    // rear all at once when the front runs out, the reversal is
+    // suspended as a rotation which is evaluated one step at a
+    // time. The schedule is a suffix of the front which has not
+    // been forced yet, and every operation forces one cell of it.
+    // Thus first, rest and append take O(1) in the worst case,
+    // even when old versions of a queue are used again.
+    template <typename elem>
+    class real_time_queue {
+
+        struct cell;
+
+        // a lazy list. Cells which are no longer shared are
+        // destroyed in a loop.
+        struct stream {
+            ptr<lazy<cell>> Next;
+
+            stream() : Next{} {}
+            stream(ptr<lazy<cell>> n) : Next{n} {}
+            stream(const stream&) = default;
+            stream(stream&&) = default;
+            stream& operator=(const stream&) = default;
+            stream& operator=(stream&&) = default;
+            ~stream();
+
+            // forces the first cell.
+            bool empty() const;
+            const elem& first() const;
+            const stream& rest() const;
+
+            static stream make(const elem& x, const stream& r);
+        };
+
+        struct cell {
+            bool Empty;
+            std::optional<elem> First;
+            stream Rest;
+
+            cell() : Empty{true}, First{}, Rest{} {}
+            cell(const elem& x, const stream& r) : Empty{false}, First{x}, Rest{r} {}
+        };
+
+        using rear = linked_stack<elem>;
+
+        stream Front;
+        size_t FrontSize;
+        rear Rear;
+        stream Schedule;
+
+        real_time_queue(stream f, size_t n, rear r, stream s) :
+            Front{f}, FrontSize{n}, Rear{r}, Schedule{s} {}
+
+        // when the rotation starts, |r| = |f| + 1.
+        static stream rotate(const stream& f, const rear& r, const stream& a);
+        static real_time_queue exec(const stream& f, size_t n, const rear& r, const stream& s);
+
+    public:
+        real_time_queue() : Front{}, FrontSize{0}, Rear{}, Schedule{} {}
+        real_time_queue(const elem& x) : real_time_queue{real_time_queue{}.append(x)} {}
+
+        template <typename X, typename Y, typename ... P>
+        real_time_queue(X x, Y y, P... p) : real_time_queue{real_time_queue{}.append(x, y, p...)} {}
+
+        bool empty() const;
+        size_t size() const;
+        bool valid() const;
+
+        const elem& first() const;
+        real_time_queue rest() const;
+
+        real_time_queue append(const elem& x) const;
+        real_time_queue prepend(const elem& x) const;
+        real_time_queue append(real_time_queue q) const;
+
+        template <typename X, typename Y, typename ... P>
+        real_time_queue append(X x, Y y, P... p) const;
+
+        real_time_queue operator<<(const elem& x) const;
+        real_time_queue operator<<(const real_time_queue& q) const;
+
+        bool operator==(const real_time_queue& q) const;
+        bool operator!=(const real_time_queue& q) const;
+
+        using const_iterator = queue_iterator<real_time_queue, elem>;
+
+        const_iterator begin() const {
+            return const_iterator{*this};
+        }
+
+        const_iterator end() const {
+            return const_iterator{};
+        }
+    };
+
+    template <typename elem>
+    std::ostream& operator<<(std::ostream& o, const real_time_queue<elem>& n) {
+        return functional::stack::write(o, n);
+    }
+
+    template <typename elem>
+    real_time_queue<elem>::stream::~stream() {
+        // a cell which has not been evaluated holds a suspended 
+        // rotation, which is left to be destroyed normally. 
+        while (Next != nullptr && Next.use_count() == 1 && Next->evaluated()) {
+            ptr<lazy<cell>> n = std::move(const_cast<cell&>(Next->force()).Rest.Next);
+            Next = std::move(n);
+        }
+    }
+    
+    template <typename elem>
+    inline bool real_time_queue<elem>::stream::empty() const {
+        return Next == nullptr || Next->force().Empty;
+    }
+
+    template <typename elem>
+    inline const elem& real_time_queue<elem>::stream::first() const {
+        return *Next->force().First;
+    }
+
+    template <typename elem>
+    inline const typename real_time_queue<elem>::stream& real_time_queue<elem>::stream::rest() const {
+        return Next->force().Rest;
+    }
+
+    template <typename elem>
+    inline typename real_time_queue<elem>::stream real_time_queue<elem>::stream::make(const elem& x, const stream& r) {
+        return stream{std::make_shared<lazy<cell>>(cell{x, r})};
+    }
+
+    // rotate(f, r, a) = f ++ reverse(r) ++ a, one step per cell.
+    template <typename elem>
+    typename real_time_queue<elem>::stream real_time_queue<elem>::rotate(const stream& f, const rear& r, const stream& a) {
+        return stream{std::make_shared<lazy<cell>>(std::function<cell()>{[f, r, a]() -> cell {
+            if (f.empty()) return cell{r.first(), a};
+            return cell{f.first(), rotate(f.rest(), r.rest(), stream::make(r.first(), a))};
+        }})};
+    }
+
+    template <typename elem>
+    real_time_queue<elem> real_time_queue<elem>::exec(const stream& f, size_t n, const rear& r, const stream& s) {
+        if (!s.empty()) return real_time_queue{f, n, r, s.rest()};
+        stream g = rotate(f, r, stream{});
+        return real_time_queue{g, n + r.size(), rear{}, g};
+    }
+
+    template <typename elem>
+    inline bool real_time_queue<elem>::empty() const {
+        return FrontSize == 0;
+    }
+
+    template <typename elem>
+    inline size_t real_time_queue<elem>::size() const {
+        return FrontSize + Rear.size();
+    }
+
+    template <typename elem>
+    bool real_time_queue<elem>::valid() const {
+        for (const elem& x : *this) if (!data::valid(x)) return false;
+        return true;
+    }
+
+    template <typename elem>
+    inline const elem& real_time_queue<elem>::first() const {
+        return Front.first();
+    }
+
+    template <typename elem>
+    inline real_time_queue<elem> real_time_queue<elem>::rest() const {
+        if (empty()) return *this;
+        return exec(Front.rest(), FrontSize - 1, Rear, Schedule);
+    }
+
+    template <typename elem>
+    inline real_time_queue<elem> real_time_queue<elem>::append(const elem& x) const {
+        return exec(Front, FrontSize, Rear << x, Schedule);
+    }
+
+    // the new cell is already evaluated, so it is also put on
+    // the schedule in order to keep the schedule as long as the
+    // front is longer than the rear.
+    template <typename elem>
+    inline real_time_queue<elem> real_time_queue<elem>::prepend(const elem& x) const {
+        return real_time_queue{stream::make(x, Front), FrontSize + 1, Rear, stream::make(x, Schedule)};
+    }
+
+    template <typename elem>
+    real_time_queue<elem> real_time_queue<elem>::append(real_time_queue q) const {
+        real_time_queue x = *this;
+        for (const elem& e : q) x = x.append(e);
+        return x;
+    }
+
+    template <typename elem>
+    template <typename X, typename Y, typename ... P>
+    inline real_time_queue<elem> real_time_queue<elem>::append(X x, Y y, P... p) const {
+        return append(x).append(y, p...);
+    }
+
+    template <typename elem>
+    inline real_time_queue<elem> real_time_queue<elem>::operator<<(const elem& x) const {
+        return append(x);
+    }
+
+    template <typename elem>
+    inline real_time_queue<elem> real_time_queue<elem>::operator<<(const real_time_queue& q) const {
+        return append(q);
+    }
+
+    template <typename elem>
+    bool real_time_queue<elem>::operator==(const real_time_queue& q) const {
+        if (size() != q.size()) return false;
+        const_iterator b = q.begin();
+        for (const elem& x : *this) {
+            if (x != *b) return false;
+            ++b;
+        }
+        return true;
+    }
+
+    template <typename elem>
+    inline bool real_time_queue<elem>::operator!=(const real_time_queue& q) const {
+        return !operator==(q);
+    }
+
+}
+
+#endif
@@ -0,0 +1,109 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef DATA_TOOLS_SELECT
+#define DATA_TOOLS_SELECT
+
+#include <thread>
+#include <utility>
+#include <data/tools/sleepers.hpp>
+
+namespace data::tool {
+
+    // one case of a select, which is a channel endpoint to get from
+    // and a function to call with what is got. Made by on.
+    template <typename from, typename f> struct select_case {
+        from From;
+        f Then;
+
+        // true if an item was got and handled. Otherwise, sets open if
+        // the channel might still have something to get.
+        bool attempt(bool &open) {
+            bool closed = From.closed();
+            typename from::value_type x{};
+            if (From.get(x, false)) {
+                Then(std::move(x));
+                return true;
+            }
+            if (!closed) open = true;
+            return false;
+        }
+    };
+
+    // for example,
+    //
+    //     select(on(a.From, [](int x) {...}), on(b.From, [](string x) {...}));
+    //
+    // The endpoints may be those of channel, bounded_channel or spsc_channel.
+    template <typename from, typename f>
+    select_case<from, f> on(from c, f then) {
+        return select_case<from, f>{c, then};
+    }
+
+    namespace low {
+        template <typename... cases>
+        int attempt_cases(bool &open, cases &...c) {
+            constexpr int n = sizeof...(cases);
+            // start from a different case each time so
+            // that a busy channel cannot starve the others.
+            static thread_local uint32 turn = 0;
+            int start = turn++ % n;
+            for (int k = 0; k < n; k++) {
+                int i = (start + k) % n;
+                int j = 0;
+                bool done = false;
+                ((done = done || (j++ == i && c.attempt(open))), ...);
+                if (done) return i;
+            }
+            return -1;
+        }
+    }
+
+    // gets one item from whichever channel has one first and calls the
+    // function of its case with it. Returns the index of that case, or
+    // -1 once all the channels are closed and empty. While nothing can
+    // be got, the thread sleeps until one of the channels is put to.
+    template <typename... cases>
+    int select(cases &&...c) {
+        static_assert(sizeof...(cases) > 0);
+
+        // try a few times before going to sleep.
+        constexpr uint32 spins = 64;
+        for (uint32 tries = 0; tries < spins; tries++) {
+            bool open = false;
+            int i = low::attempt_cases(open, c...);
+            if (i >= 0 || !open) return i;
+            std::this_thread::yield();
+        }
+
+        // look again after listening so that an item just put is not missed.
+        signal s{};
+        (c.From.listen(s), ...);
+        try {
+            while (true) {
+                bool open = false;
+                int i = low::attempt_cases(open, c...);
+                if (i >= 0 || !open) {
+                    (c.From.ignore(s), ...);
+                    return i;
+                }
+                s.wait();
+            }
+        } catch (...) {
+            (c.From.ignore(s), ...);
+            throw;
+        }
+    }
+
+    // like select, but returns -1 right away if nothing can be got.
+    template <typename... cases>
+    int try_select(cases &&...c) {
+        static_assert(sizeof...(cases) > 0);
+        bool open = false;
+        return low::attempt_cases(open, c...);
+    }
+
+}
+
+#endif
@@ -0,0 +1,439 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef DATA_TOOLS_SLEEPERS
+#define DATA_TOOLS_SLEEPERS
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <data/types.hpp>
+
+namespace data::tool {
+
+    // a thread that waits on several channels at once, as select does,
+    // waits on one of these, and every channel that it is listening to
+    // notifies it when an item is put or the channel is closed.
+    class signal {
+        std::mutex Mutex;
+        std::condition_variable Ready;
+        bool Notified;
+
+    public:
+        signal() : Mutex{}, Ready{}, Notified{false} {}
+
+        void notify() {
+            std::lock_guard<std::mutex> lock{Mutex};
+            Notified = true;
+            Ready.notify_one();
+        }
+
+        // waits until notify is called, unless it has been
+        // called since the last time wait returned.
+        void wait() {
+            std::unique_lock<std::mutex> lock{Mutex};
+            Ready.wait(lock, [this]() {
+                return Notified;
+            });
+            Notified = false;
+        }
+    };
+
+    // how a channel that passes items without a lock waits when it is full
+    // or empty. A thread that cannot make progress tries again a few times
+    // and then goes to sleep on a condition variable, and a thread that does
+    // make progress only takes the lock if it sees that someone is asleep.
+    //
+    // ring is the derived type, which provides push, pop, push_n and pop_n,
+    // which put and get without waiting and without waking anyone up.
+    template <typename ring> struct sleepers {
+        // how many times to try again before going to sleep.
+        static constexpr uint32 spins = 64;
+
+        alignas(64) std::atomic<bool> Closed;
+
+        // the numbers of threads that are asleep, including selects.
+        std::atomic<uint32> Getters;
+        std::atomic<uint32> Putters;
+
+        std::mutex Mutex;
+        std::condition_variable NotEmpty;
+        std::condition_variable NotFull;
+        std::vector<signal*> Listeners;
+
+        sleepers() : Closed{false}, Getters{0}, Putters{0}, Mutex{}, NotEmpty{}, NotFull{}, Listeners{} {}
+
+        void close() {
+            Closed.store(true);
+            std::lock_guard<std::mutex> lock{Mutex};
+            NotEmpty.notify_all();
+            NotFull.notify_all();
+            for (signal *s : Listeners) s->notify();
+        }
+
+        bool closed() const {
+            return Closed.load();
+        }
+
+        // a listener counts as a sleeping getter, so that it is notified
+        // whenever one would be woken.
+        void listen(signal &s) {
+            {
+                std::lock_guard<std::mutex> lock{Mutex};
+                Listeners.push_back(&s);
+                Getters.fetch_add(1);
+            }
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+
+        void ignore(signal &s) {
+            std::lock_guard<std::mutex> lock{Mutex};
+            Listeners.erase(std::find(Listeners.begin(), Listeners.end(), &s));
+            Getters.fetch_sub(1);
+        }
+
+        template <typename X> bool try_put(X &&x) {
+            bool put;
+            try {
+                put = self().push(std::forward<X>(x));
+            } catch (...) {
+                wake_all();
+                throw;
+            }
+            if (!put) return false;
+            wake_getters(1);
+            return true;
+        }
+
+        template <typename X> void put(X &&x) {
+            send([this, &x]() -> size_t {
+                return self().push(std::forward<X>(x));
+            }, []() {
+                return true;
+            });
+        }
+
+        template <typename it> void put_n(it begin, it end) {
+            if (begin == end) return;
+            send([this, &begin, end]() {
+                it next = self().push_n(begin, end);
+                size_t n = std::distance(begin, next);
+                begin = next;
+                return n;
+            }, [&begin, end]() {
+                return begin == end;
+            });
+        }
+
+        template <typename X> bool get(X &out, bool wait) {
+            return receive([this, &out]() -> size_t {
+                return self().pop(out);
+            }, wait, std::chrono::steady_clock::time_point::max()) != 0;
+        }
+
+        template <typename out> size_t get_n(out o, size_t max, bool wait) {
+            if (max == 0) return 0;
+            return receive([this, &o, max]() {
+                return self().pop_n(o, max);
+            }, wait, std::chrono::steady_clock::time_point::max());
+        }
+
+        template <typename X> bool get_until(X &out, std::chrono::steady_clock::time_point deadline) {
+            return receive([this, &out]() -> size_t {
+                return self().pop(out);
+            }, true, deadline) != 0;
+        }
+
+        // step tries to put something and says how many items it put.
+        // done says whether there is anything left to put.
+        template <typename step, typename finished> void send(step s, finished done);
+
+        // step tries to get something and says how many items it got.
+        template <typename step>
+        size_t receive(step s, bool wait, std::chrono::steady_clock::time_point deadline);
+
+        // a thread that is about to sleep counts itself in the waiting
+        // threads and then looks again, and a thread that makes progress
+        // looks at the count after it is done, with fences in between,
+        // so one of them always sees the other. n is how many items
+        // were passed, which is how many threads may go on.
+        void wake_getters(size_t n) {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (Getters.load(std::memory_order_relaxed) == 0) return;
+            std::lock_guard<std::mutex> lock{Mutex};
+            if (n == 1) NotEmpty.notify_one();
+            else NotEmpty.notify_all();
+            for (signal *s : Listeners) s->notify();
+        }
+
+        void wake_putters(size_t n) {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (Putters.load(std::memory_order_relaxed) == 0) return;
+            std::lock_guard<std::mutex> lock{Mutex};
+            if (n == 1) NotFull.notify_one();
+            else NotFull.notify_all();
+        }
+
+    private:
+        // when an item throws, the ring may have passed some items or made
+        // some room before it, which no one has been woken for yet.
+        void wake_all() {
+            std::lock_guard<std::mutex> lock{Mutex};
+            NotEmpty.notify_all();
+            NotFull.notify_all();
+            for (signal *s : Listeners) s->notify();
+        }
+
+        // counts a thread among the sleepers for as long as it exists,
+        // so that the count is right even if an item throws.
+        struct asleep {
+            std::atomic<uint32> &Count;
+
+            explicit asleep(std::atomic<uint32> &c) : Count{c} {
+                Count.fetch_add(1);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+            }
+
+            ~asleep() {
+                Count.fetch_sub(1);
+            }
+        };
+
+        ring &self() {
+            return static_cast<ring&>(*this);
+        }
+    };
+
+    // the endpoints of a channel that passes items through a ring which
+    // derives from sleepers. bounded_channel and spsc_channel derive from
+    // this and differ only in the ring.
+    template <typename ring> class ring_channel {
+        using item = typename ring::value_type;
+
+    public:
+        class to {
+            ptr<ring> Inner;
+            to() : Inner{} {}
+            to(ptr<ring> i) : Inner{i} {}
+
+        public:
+            void close() {
+                Inner->close();
+            }
+
+            bool closed() const {
+                return Inner->closed();
+            }
+
+            // waits while the channel is full. Throws
+            // std::logic_error if the channel is closed.
+            void put(const item &i) {
+                Inner->put(i);
+            }
+
+            void put(item &&i) {
+                Inner->put(std::move(i));
+            }
+
+            // takes forward iterators and waits for room as needed. If the
+            // channel is closed partway through, the items before that
+            // point will have been put. Use std::move_iterator to move them.
+            template <typename it> void put_n(it begin, it end) {
+                Inner->put_n(begin, end);
+            }
+
+            // false if the channel is full.
+            bool try_put(const item &i) {
+                return Inner->try_put(i);
+            }
+
+            bool try_put(item &&i) {
+                return Inner->try_put(std::move(i));
+            }
+
+            friend class ring_channel;
+        };
+
+        class from {
+            ptr<ring> Inner;
+            from() : Inner{} {}
+            from(ptr<ring> i) : Inner{i} {}
+
+        public:
+            using value_type = item;
+
+            bool closed() const {
+                return Inner->closed();
+            }
+
+            // false once the channel is closed and empty, or if
+            // wait is false and the channel is empty.
+            bool get(item &out, bool wait = true) {
+                return Inner->get(out, wait);
+            }
+
+            // waits for at least one item as get does and then takes up
+            // to max items without waiting. Returns the number got.
+            template <typename out> size_t get_n(out o, size_t max, bool wait = true) {
+                return Inner->get_n(o, max, wait);
+            }
+
+            // false if nothing could be got before the timeout.
+            template <typename rep, typename period>
+            bool try_get_for(item &out, const std::chrono::duration<rep, period> &timeout) {
+                return Inner->get_until(out, std::chrono::steady_clock::now() + timeout);
+            }
+
+            // s is notified whenever an item is put or the channel is
+            // closed, until ignore is called. This is used by select.
+            void listen(signal &s) {
+                Inner->listen(s);
+            }
+
+            void ignore(signal &s) {
+                Inner->ignore(s);
+            }
+
+            friend class ring_channel;
+        };
+
+        to To;
+        from From;
+
+    protected:
+        ring_channel(ptr<ring> i) : To{i}, From{i} {}
+
+    public:
+        size_t size() const {
+            return To.Inner->Mask + 1;
+        }
+
+        void close() {
+            To.close();
+        }
+
+        bool closed() const {
+            return To.closed();
+        }
+
+        void put(const item &i) {
+            To.put(i);
+        }
+
+        void put(item &&i) {
+            To.put(std::move(i));
+        }
+
+        template <typename it> void put_n(it begin, it end) {
+            To.put_n(begin, end);
+        }
+
+        bool try_put(const item &i) {
+            return To.try_put(i);
+        }
+
+        bool try_put(item &&i) {
+            return To.try_put(std::move(i));
+        }
+
+        bool get(item &out, bool wait = true) {
+            return From.get(out, wait);
+        }
+
+        template <typename out> size_t get_n(out o, size_t max, bool wait = true) {
+            return From.get_n(o, max, wait);
+        }
+
+        template <typename rep, typename period>
+        bool try_get_for(item &out, const std::chrono::duration<rep, period> &timeout) {
+            return From.try_get_for(out, timeout);
+        }
+    };
+
+
+    // wake_all is called after the lock has been let go, since the
+    // steps may be called with it held.
+    template <typename ring>
+    template <typename step, typename finished>
+    void sleepers<ring>::send(step s, finished done) try {
+        while (true) {
+            for (uint32 i = 0; i < spins; i++) {
+                if (Closed.load(std::memory_order_relaxed)) throw std::logic_error("put to closed channel");
+                if (size_t n = s(); n != 0) {
+                    wake_getters(n);
+                    if (done()) return;
+                    i = 0;
+                } else std::this_thread::yield();
+            }
+
+            size_t n;
+            {
+                asleep a{Putters};
+                std::unique_lock<std::mutex> lock{Mutex};
+                while (true) {
+                    if (Closed.load()) throw std::logic_error("put to closed channel");
+                    n = s();
+                    if (n != 0) break;
+                    NotFull.wait(lock);
+                }
+            }
+            wake_getters(n);
+            if (done()) return;
+        }
+    } catch (...) {
+        wake_all();
+        throw;
+    }
+
+    template <typename ring>
+    template <typename step>
+    size_t sleepers<ring>::receive(step s, bool wait, std::chrono::steady_clock::time_point deadline) try {
+        using clock = std::chrono::steady_clock;
+        auto got = [this, &s]() {
+            size_t n = s();
+            if (n != 0) wake_putters(n);
+            return n;
+        };
+
+        if (size_t n = got(); n != 0 || !wait) return n;
+
+        bool forever = deadline == clock::time_point::max();
+        for (uint32 i = 0; i < spins; i++) {
+            std::this_thread::yield();
+            if (size_t n = got(); n != 0) return n;
+            if (Closed.load(std::memory_order_relaxed)) return got();
+            if (!forever && clock::now() >= deadline) return 0;
+        }
+
+        size_t n;
+        {
+            asleep a{Getters};
+            std::unique_lock<std::mutex> lock{Mutex};
+            while (true) {
+                n = s();
+                if (n != 0 || Closed.load()) break;
+                if (forever) NotEmpty.wait(lock);
+                else if (NotEmpty.wait_until(lock, deadline) == std::cv_status::timeout) {
+                    n = s();
+                    break;
+                }
+            }
+        }
+        if (n != 0) wake_putters(n);
+        return n;
+    } catch (...) {
+        wake_all();
+        throw;
+    }
+
+}
+
+#endif
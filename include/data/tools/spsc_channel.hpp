@@ -0,0 +1,144 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef DATA_TOOLS_SPSC_CHANNEL
+#define DATA_TOOLS_SPSC_CHANNEL
+
+#include <atomic>
+#include <chrono>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <utility>
+#include <data/tools/sleepers.hpp>
+
+namespace data::tool {
+
+    // the ring behind spsc_channel.
+    template <class item> struct spsc_ring : sleepers<spsc_ring<item>> {
+        using value_type = item;
+
+        struct slot {
+            alignas(item) unsigned char Data[sizeof(item)];
+
+            item* value() {
+                return std::launder(reinterpret_cast<item*>(Data));
+            }
+        };
+
+        const size_t Mask;
+        std::unique_ptr<slot[]> Slots;
+
+        // written by the thread that puts.
+        alignas(64) std::atomic<size_t> Back;
+        size_t FrontCache;
+
+        // written by the thread that gets.
+        alignas(64) std::atomic<size_t> Front;
+        size_t BackCache;
+
+        static size_t round_up(uint32 n) {
+            size_t s = 2;
+            while (s < n) s <<= 1;
+            return s;
+        }
+
+        explicit spsc_ring(uint32 size) : sleepers<spsc_ring>{}, Mask{round_up(size) - 1}, Slots{new slot[Mask + 1]},
+            Back{0}, FrontCache{0}, Front{0}, BackCache{0} {}
+
+        ~spsc_ring() {
+            for (size_t f = Front.load(); f != Back.load(); f++) Slots[f & Mask].value()->~item();
+        }
+
+        // how many slots can be written starting from back.
+        size_t room(size_t back) {
+            if (back - FrontCache > Mask) FrontCache = Front.load(std::memory_order_acquire);
+            return Mask + 1 - (back - FrontCache);
+        }
+
+        // how many slots can be read starting from front.
+        size_t filled(size_t front) {
+            if (BackCache == front) BackCache = Back.load(std::memory_order_acquire);
+            return BackCache - front;
+        }
+
+        template <typename X> bool push(X &&x) {
+            size_t back = Back.load(std::memory_order_relaxed);
+            if (room(back) == 0) return false;
+            new (Slots[back & Mask].Data) item(std::forward<X>(x));
+            Back.store(back + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool pop(item &out) {
+            size_t front = Front.load(std::memory_order_relaxed);
+            if (filled(front) == 0) return false;
+            item *v = Slots[front & Mask].value();
+            try {
+                out = std::move(*v);
+            } catch (...) {
+                v->~item();
+                Front.store(front + 1, std::memory_order_release);
+                throw;
+            }
+            v->~item();
+            Front.store(front + 1, std::memory_order_release);
+            return true;
+        }
+
+        // push_n and pop_n only move the index once they are done, so if
+        // an item throws, they move it past the items that were finished.
+        template <typename it> it push_n(it begin, it end) {
+            size_t back = Back.load(std::memory_order_relaxed);
+            size_t n = std::min(room(back), size_t(std::distance(begin, end)));
+            for (size_t i = 0; i < n; i++, ++begin) try {
+                new (Slots[(back + i) & Mask].Data) item(*begin);
+            } catch (...) {
+                Back.store(back + i, std::memory_order_release);
+                throw;
+            }
+            Back.store(back + n, std::memory_order_release);
+            return begin;
+        }
+
+        template <typename out> size_t pop_n(out o, size_t max) {
+            size_t front = Front.load(std::memory_order_relaxed);
+            size_t n = std::min(filled(front), max);
+            for (size_t i = 0; i < n; i++) {
+                item *v = Slots[(front + i) & Mask].value();
+                try {
+                    *o++ = std::move(*v);
+                } catch (...) {
+                    for (size_t j = i; j < n; j++) Slots[(front + j) & Mask].value()->~item();
+                    Front.store(front + n, std::memory_order_release);
+                    throw;
+                }
+                v->~item();
+            }
+            Front.store(front + n, std::memory_order_release);
+            return n;
+        }
+    };
+
+    // a bounded_channel for when there is only one thread that puts
+    // and one thread that gets. It is up to the user to see that this
+    // is so; copies of To and From may be passed around, but only one
+    // thread may use each side at a time.
+    //
+    // Each side owns one index into the ring and only reads the other,
+    // so try_put and try_get finish in a fixed number of steps. Each
+    // index is on its own cache line along with a copy of the other
+    // index, which is only read again when the ring looks full or empty.
+    //
+    // Items that throw while being put are not put, and items that throw
+    // while being got are lost, as with bounded_channel.
+    template <class item> class spsc_channel : public ring_channel<spsc_ring<item>> {
+    public:
+        // the size is rounded up to a power of two.
+        explicit spsc_channel(uint32 size) : ring_channel<spsc_ring<item>>{std::make_shared<spsc_ring<item>>(size)} {}
+    };
+
+}
+
+#endif
@@ -0,0 +1,453 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef DATA_TOOLS_THREAD_POOL
+#define DATA_TOOLS_THREAD_POOL
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <data/tools/work_stealing_deque.hpp>
+
+namespace data::tool {
+
+    class thread_pool;
+
+    template <typename X> class future;
+
+    namespace low {
+
+        // something for the pool to do. run does it and then deletes it.
+        struct task {
+            virtual void run() = 0;
+            virtual ~task() {}
+        };
+
+        template <typename f>
+        struct job final : task {
+            f Fun;
+
+            explicit job(f &&fun) : Fun{std::move(fun)} {}
+
+            void run() override {
+                f fun = std::move(Fun);
+                delete this;
+                fun();
+            }
+        };
+
+        // jobs and states do not come from the per-thread pools in
+        // data/tools/allocation.hpp. They are usually freed by a
+        // thread other than the one that made them, so their blocks
+        // would pile up on the free lists of the workers.
+        template <typename f> task *make_task(f fun) {
+            return new job<f>{std::move(fun)};
+        }
+
+        template <typename X>
+        using stored = std::conditional_t<std::is_void<X>::value, bool, X>;
+
+        // what a future refers to. Continuations are tasks that are
+        // given to the pool once the value is set.
+        template <typename X>
+        struct state {
+            std::atomic<bool> Ready;
+            std::optional<stored<X>> Value;
+            std::exception_ptr Error;
+            std::mutex Mutex;
+            std::condition_variable Done;
+            std::vector<task*> Continuations;
+
+            state() : Ready{false}, Value{}, Error{}, Mutex{}, Done{}, Continuations{} {}
+
+            void finish(thread_pool &p);
+        };
+
+    }
+
+    // a pool of threads that share work by stealing it from each other.
+    //
+    // Each worker has its own deque of tasks. A task that is spawned from
+    // a worker goes on the bottom of that worker's deque and is taken
+    // from there first, so the worker tends to run the newest task,
+    // which is the one whose data is most likely to be in cache. A
+    // worker that runs out steals the oldest task of another worker,
+    // which tends to be the largest. Tasks spawned from other threads
+    // go on a queue that all the workers look at.
+    //
+    // A thread that waits for a future that is not ready runs other
+    // tasks in the meantime if it is a worker, so tasks may wait for
+    // each other without using up the workers.
+    class thread_pool {
+    public:
+        // at least one thread.
+        explicit thread_pool(uint32 threads = std::thread::hardware_concurrency());
+
+        // waits for every task that has been spawned to be run.
+        ~thread_pool();
+
+        thread_pool(const thread_pool&) = delete;
+        thread_pool &operator=(const thread_pool&) = delete;
+
+        uint32 size() const {
+            return Workers.size();
+        }
+
+        // the pool that is used throughout the library, with one
+        // thread for each core.
+        static thread_pool &shared() {
+            static thread_pool p{};
+            return p;
+        }
+
+        // run fun in the pool.
+        template <typename f>
+        auto spawn(f fun) -> future<std::invoke_result_t<f>>;
+
+        // call fun(i) for every i in [begin, end). The range is split in
+        // half until the pieces are no bigger than grain, and the pieces
+        // are run in the pool. If grain is 0, there are about eight pieces
+        // for every thread. Returns when every call has returned. If any
+        // throws, one of the exceptions is thrown after that.
+        template <typename f>
+        void parallel_for(size_t begin, size_t end, f fun, size_t grain = 0);
+
+        // whether the current thread is one of the workers of this pool.
+        bool working() const {
+            return current().Pool == this;
+        }
+
+        // run one task that is waiting, if there is one. Used
+        // while a worker waits for something.
+        bool run_one() {
+            low::task *t = find(current().Index);
+            if (t == nullptr) return false;
+            t->run();
+            return true;
+        }
+
+    private:
+        // how many times to look for work before going to sleep.
+        static constexpr uint32 spins = 64;
+
+        struct worker {
+            work_stealing_deque<low::task> Deque;
+            std::thread Thread;
+        };
+
+        struct identity {
+            thread_pool *Pool;
+            uint32 Index;
+        };
+
+        static identity &current() {
+            thread_local identity i{nullptr, 0};
+            return i;
+        }
+
+        std::vector<std::unique_ptr<worker>> Workers;
+
+        // tasks from other threads.
+        std::mutex QueueMutex;
+        std::deque<low::task*> Queue;
+        std::atomic<size_t> Queued;
+
+        // for sleeping when there is nothing to do.
+        std::mutex Mutex;
+        std::condition_variable Wake;
+        std::atomic<uint32> Sleeping;
+        bool Stopping;
+
+        template <typename X, typename f>
+        static void fulfill(thread_pool &p, low::state<X> &s, f &fun) {
+            try {
+                if constexpr (std::is_void<X>::value) {
+                    fun();
+                    s.Value.emplace(true);
+                } else s.Value.emplace(fun());
+            } catch (...) {
+                s.Error = std::current_exception();
+            }
+            s.finish(p);
+        }
+
+        void work(uint32 index);
+        low::task *find(uint32 index);
+        low::task *steal(uint32 index);
+
+    public:
+        // give a task to the pool. Used by spawn and by future::then.
+        void submit(low::task *t);
+
+        template <typename X> friend class future;
+        template <typename X> friend struct low::state;
+    };
+
+    // the result of a task in a thread_pool.
+    template <typename X> class future {
+        ptr<low::state<X>> State;
+        thread_pool *Pool;
+
+        future(ptr<low::state<X>> s, thread_pool *p) : State{s}, Pool{p} {}
+
+    public:
+        future() : State{}, Pool{nullptr} {}
+
+        bool valid() const {
+            return State != nullptr;
+        }
+
+        bool ready() const {
+            return State->Ready.load(std::memory_order_acquire);
+        }
+
+        // waits until the value is ready. A worker of the
+        // pool runs other tasks while it waits.
+        void wait() const;
+
+        // the value, or the exception that the task threw.
+        X get() const;
+
+        // a future for fun(x) where x is the value of this future, which
+        // is run in the pool once this one is ready. If this one holds an
+        // exception, so does the one that is returned.
+        template <typename f> auto then(f fun) const;
+
+        friend class thread_pool;
+        template <typename Y> friend class future;
+    };
+
+    template <typename X>
+    void low::state<X>::finish(thread_pool &p) {
+        std::vector<task*> next{};
+        {
+            std::lock_guard<std::mutex> lock{Mutex};
+            Ready.store(true, std::memory_order_release);
+            next.swap(Continuations);
+            Done.notify_all();
+        }
+        for (task *t : next) p.submit(t);
+    }
+
+    template <typename f>
+    auto thread_pool::spawn(f fun) -> future<std::invoke_result_t<f>> {
+        using X = std::invoke_result_t<f>;
+        auto s = std::make_shared<low::state<X>>();
+        submit(low::make_task([this, s, fun = std::move(fun)]() mutable {
+            fulfill(*this, *s, fun);
+        }));
+        return future<X>{s, this};
+    }
+
+    template <typename X>
+    void future<X>::wait() const {
+        if (ready()) return;
+        if (Pool != nullptr && Pool->working()) {
+            uint32 idle = 0;
+            while (!ready()) {
+                if (Pool->run_one()) idle = 0;
+                else if (++idle < thread_pool::spins) std::this_thread::yield();
+                else break;
+            }
+            if (ready()) return;
+        }
+
+        std::unique_lock<std::mutex> lock{State->Mutex};
+        State->Done.wait(lock, [this]() {
+            return State->Ready.load(std::memory_order_relaxed);
+        });
+    }
+
+    template <typename X>
+    X future<X>::get() const {
+        wait();
+        if (State->Error) std::rethrow_exception(State->Error);
+        if constexpr (!std::is_void<X>::value) return *State->Value;
+    }
+
+    template <typename X>
+    template <typename f>
+    auto future<X>::then(f fun) const {
+        using Y = std::conditional_t<std::is_void<X>::value,
+            std::invoke_result<f>, std::invoke_result<f, const low::stored<X>&>>;
+        using Z = typename Y::type;
+        auto s = std::make_shared<low::state<Z>>();
+        thread_pool *p = Pool;
+        ptr<low::state<X>> from = State;
+        low::task *t = low::make_task([p, s, from, fun = std::move(fun)]() mutable {
+            if (from->Error) {
+                s->Error = from->Error;
+                s->finish(*p);
+                return;
+            }
+            auto g = [&fun, &from]() -> Z {
+                if constexpr (std::is_void<X>::value) return fun();
+                else return fun(*from->Value);
+            };
+            thread_pool::fulfill(*p, *s, g);
+        });
+
+        bool now;
+        {
+            std::lock_guard<std::mutex> lock{State->Mutex};
+            now = State->Ready.load(std::memory_order_relaxed);
+            if (!now) State->Continuations.push_back(t);
+        }
+        if (now) p->submit(t);
+        return future<Z>{s, p};
+    }
+
+    inline thread_pool::thread_pool(uint32 threads) : Workers{}, QueueMutex{}, Queue{}, Queued{0},
+        Mutex{}, Wake{}, Sleeping{0}, Stopping{false} {
+        threads = std::max<uint32>(threads, 1);
+        for (uint32 i = 0; i < threads; i++) Workers.push_back(std::make_unique<worker>());
+        for (uint32 i = 0; i < threads; i++) Workers[i]->Thread = std::thread{[this, i]() {
+            work(i);
+        }};
+    }
+
+    inline thread_pool::~thread_pool() {
+        {
+            std::lock_guard<std::mutex> lock{Mutex};
+            Stopping = true;
+            Wake.notify_all();
+        }
+        for (auto &w : Workers) w->Thread.join();
+    }
+
+    // a worker that is about to sleep counts itself as sleeping and then
+    // looks for work again, and a thread that submits a task looks at the
+    // count after the task can be found, so one of them sees the other.
+    inline void thread_pool::submit(low::task *t) {
+        identity &c = current();
+        if (c.Pool == this) Workers[c.Index]->Deque.push(t);
+        else {
+            std::lock_guard<std::mutex> lock{QueueMutex};
+            Queue.push_back(t);
+            Queued.store(Queue.size());
+        }
+
+        if (Sleeping.load() == 0) return;
+        std::lock_guard<std::mutex> lock{Mutex};
+        Wake.notify_one();
+    }
+
+    inline void thread_pool::work(uint32 index) {
+        current() = identity{this, index};
+        uint32 idle = 0;
+        while (true) {
+            if (low::task *t = find(index)) {
+                t->run();
+                idle = 0;
+                continue;
+            }
+
+            if (++idle < spins) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock{Mutex};
+            Sleeping.fetch_add(1);
+            if (low::task *t = find(index)) {
+                Sleeping.fetch_sub(1);
+                lock.unlock();
+                t->run();
+                idle = 0;
+                continue;
+            }
+
+            // tasks that are running may still spawn more, but
+            // those go to the workers that are running them.
+            if (Stopping) {
+                Sleeping.fetch_sub(1);
+                return;
+            }
+
+            Wake.wait(lock);
+            Sleeping.fetch_sub(1);
+            idle = 0;
+        }
+    }
+
+    inline low::task *thread_pool::find(uint32 index) {
+        if (low::task *t = Workers[index]->Deque.take()) return t;
+
+        if (Queued.load() != 0) {
+            std::lock_guard<std::mutex> lock{QueueMutex};
+            if (!Queue.empty()) {
+                low::task *t = Queue.front();
+                Queue.pop_front();
+                Queued.store(Queue.size());
+                return t;
+            }
+        }
+
+        return steal(index);
+    }
+
+    // start from a random worker so that thieves spread out.
+    inline low::task *thread_pool::steal(uint32 index) {
+        uint32 n = Workers.size();
+        if (n < 2) return nullptr;
+        thread_local std::minstd_rand random{std::random_device{}()};
+        uint32 start = random() % n;
+        for (uint32 k = 0; k < n; k++) {
+            uint32 v = (start + k) % n;
+            if (v == index) continue;
+            if (low::task *t = Workers[v]->Deque.steal()) return t;
+        }
+        return nullptr;
+    }
+
+    template <typename f>
+    void thread_pool::parallel_for(size_t begin, size_t end, f fun, size_t grain) {
+        if (begin >= end) return;
+        if (grain == 0) grain = std::max<size_t>(1, (end - begin) / (8 * size()));
+
+        // split the range in half, spawn the upper half, and go
+        // on with the lower half until it is small enough.
+        auto pieces = [this, &fun, grain](size_t b, size_t e, auto &self) -> void {
+            std::vector<future<void>> halves{};
+            while (e - b > grain) {
+                size_t m = b + (e - b) / 2;
+                halves.push_back(spawn([m, e, &self]() {
+                    self(m, e, self);
+                }));
+                e = m;
+            }
+
+            std::exception_ptr error{};
+            try {
+                for (size_t i = b; i < e; i++) fun(i);
+            } catch (...) {
+                error = std::current_exception();
+            }
+
+            // every piece must be done before anything is thrown,
+            // since they all refer to fun.
+            for (auto &h : halves) try {
+                h.get();
+            } catch (...) {
+                if (!error) error = std::current_exception();
+            }
+            if (error) std::rethrow_exception(error);
+        };
+
+        pieces(begin, end, pieces);
+    }
+
+}
+
+#endif
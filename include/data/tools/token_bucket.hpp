@@ -0,0 +1,111 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef DATA_TOOLS_TOKEN_BUCKET
+#define DATA_TOOLS_TOKEN_BUCKET
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <data/types.hpp>
+
+namespace data::tool {
+
+    // a rate limiter that allows count acquisitions every period on
+    // average, and up to burst of them at once. It may be shared
+    // between threads, and it does not take a lock.
+    //
+    // This is the generic cell rate algorithm, which is a token bucket
+    // that is kept as a single number: the time at which the bucket
+    // will be full again, in nanoseconds of std::chrono::steady_clock.
+    // Every token moves that time forward by period / count, and a
+    // request is allowed if the time does not end up more than burst
+    // tokens in the future. An update is one compare-and-swap.
+    class token_bucket {
+    public:
+        using clock = std::chrono::steady_clock;
+        using duration = std::chrono::nanoseconds;
+
+        token_bucket(uint64 count, duration period, uint64 burst = 1) :
+            Interval{count == 0 ? 0 : period.count() / int64(count)},
+            Tolerance{Interval * int64(burst)}, Full{0} {
+            if (Interval <= 0) throw std::invalid_argument{"token_bucket needs between one token per period and one per nanosecond"};
+            if (burst == 0) throw std::invalid_argument{"token_bucket must have a burst of at least one"};
+        }
+
+        token_bucket(const token_bucket &b) : Interval{b.Interval}, Tolerance{b.Tolerance}, Full{b.Full.load()} {}
+
+        // the time between tokens.
+        duration interval() const {
+            return duration{Interval};
+        }
+
+        uint64 burst() const {
+            return Tolerance / Interval;
+        }
+
+        // take n tokens if there are that many.
+        bool try_acquire(uint64 n = 1) {
+            return try_acquire(n, clock::now());
+        }
+
+        bool try_acquire(uint64 n, clock::time_point now);
+
+        // take n tokens whether or not there are that many, and return
+        // how long to wait before using them. Later calls queue behind.
+        duration reserve(uint64 n = 1) {
+            return reserve(n, clock::now());
+        }
+
+        duration reserve(uint64 n, clock::time_point now);
+
+        // take n tokens, sleeping until they are available.
+        void acquire(uint64 n = 1) {
+            duration wait = reserve(n);
+            if (wait.count() > 0) std::this_thread::sleep_for(wait);
+        }
+
+        // how many tokens could be taken now. None while
+        // reserve has taken more than there were.
+        uint64 available(clock::time_point now = clock::now()) const {
+            int64 left = Tolerance - std::max<int64>(Full.load(std::memory_order_relaxed) - nanoseconds(now), 0);
+            return std::max<int64>(left, 0) / Interval;
+        }
+
+    private:
+        const int64 Interval;
+        const int64 Tolerance;
+
+        // the time at which the bucket will be full.
+        alignas(64) std::atomic<int64> Full;
+
+        static int64 nanoseconds(clock::time_point t) {
+            return std::chrono::duration_cast<duration>(t.time_since_epoch()).count();
+        }
+    };
+
+    inline bool token_bucket::try_acquire(uint64 n, clock::time_point now) {
+        int64 t = nanoseconds(now);
+        int64 full = Full.load(std::memory_order_relaxed);
+        while (true) {
+            int64 next = std::max(full, t) + Interval * int64(n);
+            if (next - t > Tolerance) return false;
+            if (Full.compare_exchange_weak(full, next, std::memory_order_relaxed)) return true;
+        }
+    }
+
+    inline token_bucket::duration token_bucket::reserve(uint64 n, clock::time_point now) {
+        int64 t = nanoseconds(now);
+        int64 full = Full.load(std::memory_order_relaxed);
+        int64 next;
+        do next = std::max(full, t) + Interval * int64(n);
+        while (!Full.compare_exchange_weak(full, next, std::memory_order_relaxed));
+        return duration{std::max<int64>(next - t - Tolerance, 0)};
+    }
+
+}
+
+#endif
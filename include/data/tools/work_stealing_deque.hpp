@@ -0,0 +1,113 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef DATA_TOOLS_WORK_STEALING_DEQUE
+#define DATA_TOOLS_WORK_STEALING_DEQUE
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <data/types.hpp>
+
+namespace data::tool {
+
+    // the deque of Chase and Lev, as corrected for weak memory by Lê et al.
+    // One thread, the owner, pushes and takes pointers at the bottom, and any
+    // thread may steal from the top. The owner only contends with thieves
+    // when there is one item left.
+    //
+    // The array of items grows when it is full. Old arrays are kept until
+    // the deque is destroyed, since a thief may still be reading one.
+    template <typename X> class work_stealing_deque {
+        struct array {
+            const int64 Size;
+            std::unique_ptr<std::atomic<X*>[]> Items;
+
+            explicit array(int64 size) : Size{size}, Items{new std::atomic<X*>[size]} {}
+
+            X* get(int64 i) const {
+                return Items[i & (Size - 1)].load(std::memory_order_relaxed);
+            }
+
+            void put(int64 i, X* x) {
+                Items[i & (Size - 1)].store(x, std::memory_order_relaxed);
+            }
+        };
+
+        alignas(64) std::atomic<int64> Top;
+        alignas(64) std::atomic<int64> Bottom;
+        std::atomic<array*> Array;
+        std::vector<std::unique_ptr<array>> Arrays;
+
+        array *grow(array *a, int64 top, int64 bottom) {
+            Arrays.push_back(std::make_unique<array>(a->Size * 2));
+            array *b = Arrays.back().get();
+            for (int64 i = top; i < bottom; i++) b->put(i, a->get(i));
+            Array.store(b, std::memory_order_release);
+            return b;
+        }
+
+    public:
+        // the size is a power of two.
+        explicit work_stealing_deque(int64 size = 256) : Top{0}, Bottom{0}, Array{}, Arrays{} {
+            Arrays.push_back(std::make_unique<array>(size));
+            Array.store(Arrays.back().get());
+        }
+
+        work_stealing_deque(const work_stealing_deque&) = delete;
+        work_stealing_deque &operator=(const work_stealing_deque&) = delete;
+
+        // may be wrong by the time it returns.
+        bool empty() const {
+            return Bottom.load(std::memory_order_relaxed) <= Top.load(std::memory_order_relaxed);
+        }
+
+        // only the owner may push and take.
+        void push(X* x) {
+            int64 b = Bottom.load(std::memory_order_relaxed);
+            int64 t = Top.load(std::memory_order_acquire);
+            array *a = Array.load(std::memory_order_relaxed);
+            if (b - t > a->Size - 1) a = grow(a, t, b);
+            a->put(b, x);
+            Bottom.store(b + 1, std::memory_order_seq_cst);
+        }
+
+        // the item that was pushed last, or nullptr if there is none.
+        X* take() {
+            int64 b = Bottom.load(std::memory_order_relaxed) - 1;
+            array *a = Array.load(std::memory_order_relaxed);
+            Bottom.store(b, std::memory_order_seq_cst);
+            int64 t = Top.load(std::memory_order_seq_cst);
+            if (t > b) {
+                Bottom.store(b + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            X* x = a->get(b);
+            if (t == b) {
+                // the last item, which a thief may be after too.
+                if (!Top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                    x = nullptr;
+                Bottom.store(b + 1, std::memory_order_relaxed);
+            }
+            return x;
+        }
+
+        // the item that was pushed first, or nullptr if there is none or
+        // if another thread got to it first.
+        X* steal() {
+            int64 t = Top.load(std::memory_order_seq_cst);
+            int64 b = Bottom.load(std::memory_order_seq_cst);
+            if (t >= b) return nullptr;
+
+            X* x = Array.load(std::memory_order_acquire)->get(t);
+            if (!Top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                return nullptr;
+            return x;
+        }
+    };
+
+}
+
+#endif
@@ -50,15 +50,12 @@ namespace milewski::okasaki {
             assert(!isEmpty());
             return Heap(_tree->_right);
         }
+        // subtrees were checked when they were made, so only
+        // the root needs to be checked here. 
         void assertInv() const
         {
-            if (!isEmpty())
-            {
-                // left bias
-                assert(left().rank() >= right().rank());
-                left().assertInv();
-                right().assertInv();
-            }
+            // left bias
+            assert(isEmpty() || left().rank() >= right().rank());
         }
     public:
         Heap() {}
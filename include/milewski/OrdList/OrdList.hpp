@@ -4,25 +4,29 @@
 #include <cassert>
 #include <memory>
 #include <initializer_list>
+#include <data/tools/allocation.hpp>
 
 namespace milewski::okasaki {
-    template<class T>
+    // A is an allocation policy from data/tools/allocation.hpp. 
+    template<class T, class A = data::tool::allocation::shared>
     // requires Ord<T>
     struct OrdList
     {
+        struct Item;
+        using Ptr = typename A::template pointer<const Item>;
         struct Item
         {
-            Item(T v, std::shared_ptr<const Item> const & tail) : _val(v), _next(tail) {}
+            Item(T v, Ptr const & tail) : _val(v), _next(tail) {}
             T _val;
-            std::shared_ptr<const Item> _next;
+            Ptr _next;
         };
         friend Item;
-        explicit OrdList(std::shared_ptr<const Item> const & items) : _head(items) {}
+        explicit OrdList(Ptr const & items) : _head(items) {}
         
         // Empty list
         OrdList() : _head{nullptr} {}
         // Cons
-        OrdList(T v, OrdList const & tail) : _head(std::make_shared<Item>(v, tail._head))
+        OrdList(T v, OrdList const & tail) : _head(A::template make<const Item>(v, tail._head))
         {
             assert(tail.isEmpty() || v <= tail.front());
         }
@@ -43,13 +47,13 @@ namespace milewski::okasaki {
             if (isEmpty() || v <= front())
                 return OrdList(v, OrdList(_head));
             else {
-                return OrdList<T>(front(), popped_front().inserted(v));
+                return OrdList(front(), popped_front().inserted(v));
             }
         }
         // For debugging
         int headCount() const { return _head.use_count(); }
         
-        std::shared_ptr<const Item> _head;
+        Ptr _head;
         
         bool operator==(const OrdList o) const { return _head == o._head; }
         
@@ -57,17 +61,17 @@ namespace milewski::okasaki {
     };
 
 
-    template<class T>
-    OrdList<T> merged(OrdList<T> const & a, OrdList<T> const & b)
+    template<class T, class A>
+    OrdList<T, A> merged(OrdList<T, A> const & a, OrdList<T, A> const & b)
     {
         if (a.isEmpty())
             return b;
         if (b.isEmpty())
             return a;
         if (a.front() <= b.front())
-            return OrdList<T>(a.front(), merged(a.popped_front(), b));
+            return OrdList<T, A>(a.front(), merged(a.popped_front(), b));
         else
-            return OrdList<T>(b.front(), merged(a, b.popped_front()));
+            return OrdList<T, A>(b.front(), merged(a, b.popped_front()));
     }
 }
 
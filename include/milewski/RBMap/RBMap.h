@@ -1,8 +1,11 @@
 #ifndef MILEWSKI_OKASAKI_RBMAP
 #define MILEWSKI_OKASAKI_RBMAP
 
+#include <algorithm>
 #include <cassert>
+#include <iterator>
 #include <memory>
+#include <data/tools/allocation.hpp>
 
 namespace milewski::okasaki {
 
@@ -12,24 +15,34 @@ namespace milewski::okasaki {
     // 2. Every path from rootKey to empty node contains the same
     // number of black nodes.
 
-    template<class K, class V>
+    // A is an allocation policy from data/tools/allocation.hpp. 
+    template<class K, class V, class A = data::tool::allocation::shared>
     class RBMap
     {
+        struct Node;
+        using Ptr = typename A::template pointer<const Node>;
         struct Node
         {
             Node(Color c,
-                std::shared_ptr<const Node> const & lft,
+                Ptr const & lft,
                 const K key, V val,
-                std::shared_ptr<const Node> const & rgt)
-                : _c(c), _lft(lft), _key(key), _val(val), _rgt(rgt)
+                Ptr const & rgt)
+                : _c(c)
+                , _bh((lft ? lft->_bh : 0) + (c == B ? 1 : 0))
+                , _size(1 + (lft ? lft->_size : 0) + (rgt ? rgt->_size : 0))
+                , _lft(lft), _key(key), _val(val), _rgt(rgt)
             {}
             Color _c;
-            std::shared_ptr<const Node> _lft;
+            // black height and number of nodes, so that 
+            // join and size take constant time. 
+            int _bh;
+            size_t _size;
+            Ptr _lft;
             const K _key;
             const V _val;
-            std::shared_ptr<const Node> _rgt;
+            Ptr _rgt;
         };
-        explicit RBMap(std::shared_ptr<const Node> const & node) : _root(node) {}
+        explicit RBMap(Ptr const & node) : _root(node) {}
         Color rootColor() const
         {
             assert(!isEmpty());
@@ -38,12 +51,13 @@ namespace milewski::okasaki {
     public:
         RBMap() : _root{nullptr} {}
         RBMap(Color c, RBMap const & lft, const K& key, const V& val, RBMap const & rgt)
-            : _root(std::make_shared<const Node>(c, lft._root, key, val, rgt._root))
+            : _root(A::template make<const Node>(c, lft._root, key, val, rgt._root))
         {
             assert(lft.isEmpty() || lft.rootKey() < key);
             assert(rgt.isEmpty() || key < rgt.rootKey());
         }
         bool isEmpty() const { return !_root; }
+        size_t size() const { return isEmpty() ? 0 : _root->_size; }
         const K& rootKey() const
         {
             assert(!isEmpty());
@@ -96,14 +110,241 @@ namespace milewski::okasaki {
             return RBMap(B, t.left(), t.rootKey(), t.rootValue(), t.right());
         }
         template<class F>
-        RBMap insertedWith(K k, V v, F combine)
+        RBMap insertedWith(K k, V v, F combine) const
         {
             RBMap t = insWith(k, v, combine);
             return RBMap(B, t.left(), t.rootKey(), t.rootValue(), t.right());
         }
+        // Build a map in linear time from a range whose keys are 
+        // strictly increasing. Every level but the deepest is full, 
+        // so the deepest level is red if it is not full too. 
+        template<class I, class KeyOf, class ValueOf>
+        static RBMap fromSorted(I beg, I end, KeyOf key, ValueOf value)
+        {
+            size_t n = std::distance(beg, end);
+            int full = 0;
+            while ((size_t(2) << full) - 1 <= n) ++full;
+            return build(beg, n, 0, full, key, value);
+        }
+        template<class I>
+        static RBMap fromSortedListOfPairs(I beg, I end)
+        {
+            return fromSorted(beg, end
+            , [](auto const & p) -> const K& { return p.first; }
+            , [](auto const & p) -> const V& { return p.second; });
+        }
+        // Set operations by split and join (Blelloch, Ferizovic 
+        // and Sun). Subtrees that are not touched by the other 
+        // map are shared with the result. 
+        // 
+        // all keys of a and b. Where both have a key, the value
+        // from a is kept. 
+        static RBMap united(RBMap const & a, RBMap const & b)
+        {
+            if (a.isEmpty())
+                return b;
+            if (b.isEmpty())
+                return a;
+            Split s = b.split(a.rootKey());
+            return join(united(a.left(), s.lft), a.rootKey(), a.rootValue(), united(a.right(), s.rgt));
+        }
+        // keys of a which are also in b, with values from a. 
+        static RBMap intersected(RBMap const & a, RBMap const & b)
+        {
+            if (a.isEmpty() || b.isEmpty())
+                return RBMap();
+            Split s = b.split(a.rootKey());
+            RBMap lft = intersected(a.left(), s.lft);
+            RBMap rgt = intersected(a.right(), s.rgt);
+            if (s.found)
+                return join(lft, a.rootKey(), a.rootValue(), rgt);
+            return join(lft, rgt);
+        }
+        // keys of a which are not in b. 
+        static RBMap subtracted(RBMap const & a, RBMap const & b)
+        {
+            if (a.isEmpty() || b.isEmpty())
+                return a;
+            Split s = a.split(b.rootKey());
+            return join(subtracted(s.lft, b.left()), subtracted(s.rgt, b.right()));
+        }
+        // join two maps and a key which is greater than every key 
+        // in lft and less than every key in rgt. 
+        static RBMap join(RBMap const & lft, const K& x, const V& v, RBMap const & rgt)
+        {
+            RBMap l = lft.blackened();
+            RBMap r = rgt.blackened();
+            int hl = l.blackHeight();
+            int hr = r.blackHeight();
+            if (hl > hr)
+                return joinRight(l, hl, x, v, r, hr).blackened();
+            if (hr > hl)
+                return joinLeft(l, hl, x, v, r, hr).blackened();
+            return RBMap(R, l, x, v, r);
+        }
+        // join two maps where every key in lft is less than
+        // every key in rgt. 
+        static RBMap join(RBMap const & lft, RBMap const & rgt)
+        {
+            if (lft.isEmpty())
+                return rgt;
+            if (rgt.isEmpty())
+                return lft;
+            const Node* last = lft._root.get();
+            while (last->_rgt)
+                last = last->_rgt.get();
+            K x = last->_key;
+            V v = last->_val;
+            return join(lft.removed(x), x, v, rgt);
+        }
+        // the keys less than x, whether x was found, and the 
+        // keys greater than x. 
+        struct Split
+        {
+            RBMap lft;
+            bool found;
+            RBMap rgt;
+        };
+        Split split(const K& x) const
+        {
+            if (isEmpty())
+                return Split{RBMap(), false, RBMap()};
+            if (x < rootKey())
+            {
+                Split s = left().split(x);
+                return Split{s.lft, s.found, join(s.rgt, rootKey(), rootValue(), right())};
+            }
+            if (rootKey() < x)
+            {
+                Split s = right().split(x);
+                return Split{join(left(), rootKey(), rootValue(), s.lft), s.found, s.rgt};
+            }
+            return Split{left(), true, right()};
+        }
+        // In-order iterator. The path to the current node is kept
+        // on a fixed stack, so iteration never allocates. The height 
+        // of a red-black tree with n nodes is at most 2 log2(n + 1). 
+        class Iterator
+        {
+            static constexpr int MaxDepth = 2 * 8 * sizeof(void*);
+        public:
+            Iterator() : _depth(0) {}
+            Iterator(Iterator const & i) : _depth(i._depth)
+            {
+                for (int d = 0; d < _depth; ++d) _path[d] = i._path[d];
+            }
+            Iterator& operator=(Iterator const & i)
+            {
+                _depth = i._depth;
+                for (int d = 0; d < _depth; ++d) _path[d] = i._path[d];
+                return *this;
+            }
+            const K& key() const
+            {
+                assert(_depth > 0);
+                return _path[_depth - 1]->_key;
+            }
+            const V& value() const
+            {
+                assert(_depth > 0);
+                return _path[_depth - 1]->_val;
+            }
+            Iterator& operator++()
+            {
+                assert(_depth > 0);
+                const Node* n = _path[--_depth];
+                pushLeft(n->_rgt.get());
+                return *this;
+            }
+            bool operator==(Iterator const & i) const
+            {
+                return current() == i.current();
+            }
+            bool operator!=(Iterator const & i) const
+            {
+                return current() != i.current();
+            }
+        private:
+            friend class RBMap;
+            const Node* current() const
+            {
+                return _depth == 0 ? nullptr : _path[_depth - 1];
+            }
+            void push(const Node* n)
+            {
+                assert(_depth < MaxDepth);
+                _path[_depth++] = n;
+            }
+            void pushLeft(const Node* n)
+            {
+                for (; n != nullptr; n = n->_lft.get()) push(n);
+            }
+            const Node* _path[MaxDepth];
+            int _depth;
+        };
+        Iterator begin() const
+        {
+            Iterator i;
+            i.pushLeft(_root.get());
+            return i;
+        }
+        Iterator end() const
+        {
+            return Iterator();
+        }
+        // first key not less than x. 
+        Iterator lowerBound(const K& x) const
+        {
+            Iterator i;
+            for (const Node* n = _root.get(); n != nullptr;)
+                if (n->_key < x)
+                    n = n->_rgt.get();
+                else
+                {
+                    i.push(n);
+                    n = n->_lft.get();
+                }
+            return i;
+        }
+        // first key greater than x. 
+        Iterator upperBound(const K& x) const
+        {
+            Iterator i;
+            for (const Node* n = _root.get(); n != nullptr;)
+                if (x < n->_key)
+                {
+                    i.push(n);
+                    n = n->_lft.get();
+                }
+                else
+                    n = n->_rgt.get();
+            return i;
+        }
+        // Look up a range of keys sorted in increasing order in one 
+        // walk of the tree. The range is split at the key of each 
+        // node, so m keys take O(m log(n/m + 1)) rather than 
+        // O(m log n). found(x, value) is called for every x in the 
+        // range whose key is in the map. 
+        template<class I, class KeyOf, class F>
+        void findSorted(I beg, I end, KeyOf key, F found) const
+        {
+            findSorted(_root.get(), beg, end, key, found);
+        }
+        // Kahrs' persistent deletion. Only the path to the 
+        // removed key is copied. 
+        RBMap removed(const K& x) const
+        {
+            RBMap t = del(x);
+            if (t.isEmpty())
+                return t;
+            return RBMap(B, t.left(), t.rootKey(), t.rootValue(), t.right());
+        }
         // 1. No red node has a red child.
         void assert1() const
         {
+#ifndef NDEBUG
+            // this walks the whole tree, so it must not run in 
+            // release builds, where ins would become linear. 
             if (!isEmpty())
             {
                 auto lft = left();
@@ -116,6 +357,7 @@ namespace milewski::okasaki {
                 lft.assert1();
                 rgt.assert1();
             }
+#endif
         }
         // 2. Every path from root to empty node contains the same
         // number of black nodes.
@@ -128,7 +370,31 @@ namespace milewski::okasaki {
             assert(lft == rgt);
             return (rootColor() == B) ? 1 + lft : lft;
         }
+        // 1 and 2 without assert, so that they can be
+        // checked in release builds too.
+        bool isRedBlack() const
+        {
+            return blackCount() >= 0;
+        }
     private:
+        // the number of black nodes on every path, or -1 if
+        // the paths differ, a red node has a red child, or
+        // the black height that is kept in the node is wrong.
+        int blackCount() const
+        {
+            if (isEmpty())
+                return 0;
+            if (rootColor() == R)
+                for (const RBMap& c : {left(), right()})
+                    if (!c.isEmpty() && c.rootColor() == R)
+                        return -1;
+            int lft = left().blackCount();
+            int rgt = right().blackCount();
+            if (lft < 0 || lft != rgt)
+                return -1;
+            int h = (rootColor() == B) ? 1 + lft : lft;
+            return h == blackHeight() ? h : -1;
+        }
         RBMap ins(const K& x, const V& v) const
         {
             assert1();
@@ -184,6 +450,168 @@ namespace milewski::okasaki {
                     return RBMap(c, left(), y, combine(yv, v), right());
             }
         }
+        template<class I, class KeyOf, class F>
+        static void findSorted(const Node* n, I beg, I end, KeyOf& key, F& found)
+        {
+            if (n == nullptr || beg == end)
+                return;
+            I mid = std::lower_bound(beg, end, n->_key, 
+                [&key](const typename std::iterator_traits<I>::value_type& x, const K& k) -> bool {
+                    return key(x) < k;
+                });
+            findSorted(n->_lft.get(), beg, mid, key, found);
+            for (; mid != end && !(n->_key < key(*mid)); ++mid)
+                found(*mid, n->_val);
+            findSorted(n->_rgt.get(), mid, end, key, found);
+        }
+        template<class I, class KeyOf, class ValueOf>
+        static RBMap build(I& it, size_t n, int depth, int full, KeyOf& key, ValueOf& value)
+        {
+            if (n == 0)
+                return RBMap();
+            size_t half = (n - 1) / 2;
+            RBMap lft = build(it, half, depth + 1, full, key, value);
+            K x = key(*it);
+            V v = value(*it);
+            ++it;
+            RBMap rgt = build(it, n - 1 - half, depth + 1, full, key, value);
+            return RBMap(depth < full ? B : R, lft, x, v, rgt);
+        }
+        int blackHeight() const
+        {
+            return isEmpty() ? 0 : _root->_bh;
+        }
+        RBMap blackened() const
+        {
+            if (isEmpty() || rootColor() == B)
+                return *this;
+            return paint(B);
+        }
+        // t has black height h, which is at least as great as 
+        // that of r. r is black. 
+        static RBMap joinRight(RBMap const & t, int h, const K& x, const V& v, RBMap const & r, int hr)
+        {
+            if (h == hr && (t.isEmpty() || t.rootColor() == B))
+                return RBMap(R, t, x, v, r);
+            Color c = t.rootColor();
+            RBMap m = joinRight(t.right(), c == B ? h - 1 : h, x, v, r, hr);
+            if (c == B && m.rootColor() == R && !m.right().isEmpty() && m.right().rootColor() == R)
+                return RBMap(R
+                , RBMap(B, t.left(), t.rootKey(), t.rootValue(), m.left())
+                , m.rootKey()
+                , m.rootValue()
+                , m.right().paint(B));
+            return RBMap(c, t.left(), t.rootKey(), t.rootValue(), m);
+        }
+        static RBMap joinLeft(RBMap const & l, int hl, const K& x, const V& v, RBMap const & t, int h)
+        {
+            if (h == hl && (t.isEmpty() || t.rootColor() == B))
+                return RBMap(R, l, x, v, t);
+            Color c = t.rootColor();
+            RBMap m = joinLeft(l, hl, x, v, t.left(), c == B ? h - 1 : h);
+            if (c == B && m.rootColor() == R && !m.left().isEmpty() && m.left().rootColor() == R)
+                return RBMap(R
+                , m.left().paint(B)
+                , m.rootKey()
+                , m.rootValue()
+                , RBMap(B, m.right(), t.rootKey(), t.rootValue(), t.right()));
+            return RBMap(c, m, t.rootKey(), t.rootValue(), t.right());
+        }
+        // del on a black tree returns a tree with black height
+        // reduced by one. del on a red tree (or on an empty tree)
+        // leaves the black height unchanged.
+        RBMap del(const K& x) const
+        {
+            if (isEmpty())
+                return RBMap();
+            K y = rootKey();
+            if (x < y)
+            {
+                if (!left().isEmpty() && left().rootColor() == B)
+                    return balanceLeft(left().del(x), y, rootValue(), right());
+                return RBMap(R, left().del(x), y, rootValue(), right());
+            }
+            else if (y < x)
+            {
+                if (!right().isEmpty() && right().rootColor() == B)
+                    return balanceRight(left(), y, rootValue(), right().del(x));
+                return RBMap(R, left(), y, rootValue(), right().del(x));
+            }
+            else
+                return fuse(left(), right());
+        }
+        // the left side is one black node shorter than the right. 
+        static RBMap balanceLeft(RBMap const & lft, K x, V v, RBMap const & rgt)
+        {
+            if (!lft.isEmpty() && lft.rootColor() == R)
+                return RBMap(R, lft.paint(B), x, v, rgt);
+            else if (rgt.rootColor() == B)
+                return rebalance(lft, x, v, rgt.paint(R));
+            else
+                return RBMap(R
+                , RBMap(B, lft, x, v, rgt.left().left())
+                , rgt.left().rootKey()
+                , rgt.left().rootValue()
+                , rebalance(rgt.left().right(), rgt.rootKey(), rgt.rootValue(), rgt.right().paint(R)));
+        }
+        // the right side is one black node shorter than the left. 
+        static RBMap balanceRight(RBMap const & lft, K x, V v, RBMap const & rgt)
+        {
+            if (!rgt.isEmpty() && rgt.rootColor() == R)
+                return RBMap(R, lft, x, v, rgt.paint(B));
+            else if (lft.rootColor() == B)
+                return rebalance(lft.paint(R), x, v, rgt);
+            else
+                return RBMap(R
+                , rebalance(lft.left().paint(R), lft.rootKey(), lft.rootValue(), lft.right().left())
+                , lft.right().rootKey()
+                , lft.right().rootValue()
+                , RBMap(B, lft.right().right(), x, v, rgt));
+        }
+        // join two trees of equal black height whose keys 
+        // are all in order. 
+        static RBMap fuse(RBMap const & lft, RBMap const & rgt)
+        {
+            if (lft.isEmpty())
+                return rgt;
+            if (rgt.isEmpty())
+                return lft;
+            if (lft.rootColor() == R && rgt.rootColor() == R)
+            {
+                RBMap m = fuse(lft.right(), rgt.left());
+                if (!m.isEmpty() && m.rootColor() == R)
+                    return RBMap(R
+                    , RBMap(R, lft.left(), lft.rootKey(), lft.rootValue(), m.left())
+                    , m.rootKey()
+                    , m.rootValue()
+                    , RBMap(R, m.right(), rgt.rootKey(), rgt.rootValue(), rgt.right()));
+                return RBMap(R, lft.left(), lft.rootKey(), lft.rootValue()
+                , RBMap(R, m, rgt.rootKey(), rgt.rootValue(), rgt.right()));
+            }
+            if (lft.rootColor() == B && rgt.rootColor() == B)
+            {
+                RBMap m = fuse(lft.right(), rgt.left());
+                if (!m.isEmpty() && m.rootColor() == R)
+                    return RBMap(R
+                    , RBMap(B, lft.left(), lft.rootKey(), lft.rootValue(), m.left())
+                    , m.rootKey()
+                    , m.rootValue()
+                    , RBMap(B, m.right(), rgt.rootKey(), rgt.rootValue(), rgt.right()));
+                return balanceLeft(lft.left(), lft.rootKey(), lft.rootValue()
+                , RBMap(B, m, rgt.rootKey(), rgt.rootValue(), rgt.right()));
+            }
+            if (rgt.rootColor() == R)
+                return RBMap(R, fuse(lft, rgt.left()), rgt.rootKey(), rgt.rootValue(), rgt.right());
+            return RBMap(R, lft.left(), lft.rootKey(), lft.rootValue(), fuse(lft.right(), rgt));
+        }
+        // Kahrs' version of balance, which also handles the 
+        // case of two red children. Used by deletion. 
+        static RBMap rebalance(RBMap const & lft, K x, V v, RBMap const & rgt)
+        {
+            if (!lft.isEmpty() && lft.rootColor() == R && !rgt.isEmpty() && rgt.rootColor() == R)
+                return RBMap(R, lft.paint(B), x, v, rgt.paint(B));
+            return balance(lft, x, v, rgt);
+        }
         // Called only when parent is black
         static RBMap balance(RBMap const & lft, K x, V v, RBMap const & rgt)
         {
@@ -234,11 +662,11 @@ namespace milewski::okasaki {
             return RBMap(c, left(), rootKey(), rootValue(), right());
         }
     private:
-        std::shared_ptr<const Node> _root;
+        Ptr _root;
     };
 
-    template<class K, class V, class F>
-    void forEach(RBMap<K, V> const & t, F f) {
+    template<class K, class V, class A, class F>
+    void forEach(RBMap<K, V, A> const & t, F f) {
         if (!t.isEmpty()) {
             forEach(t.left(), f);
             f(t.rootKey(), t.rootValue());
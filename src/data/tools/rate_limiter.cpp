@@ -6,9 +6,15 @@
 namespace data {
     namespace tools {
 
+        // steady_clock, so that changes to the system time
+        // do not make calls wait too long or not at all.
         long rate_limiter::getTime() {
-            long now = std::chrono::duration_cast<std::chrono::seconds>(
-                    std::chrono::system_clock::now().time_since_epoch()).count();
+            return getTime(std::chrono::duration_cast<std::chrono::seconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+
+        long rate_limiter::getTime(long now) {
+            std::lock_guard<std::mutex> lock(m_mutex);
             long lastSent=m_queue.getValue();
             if(lastSent == -1) {
                 m_queue.setValue(now);
@@ -0,0 +1,136 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <data/tools.hpp>
+#include <data/tools/allocation.hpp>
+#include <data/tools/bounded_channel.hpp>
+#include <milewski/OrdList/OrdList.hpp>
+#include "gtest/gtest.h"
+#include <thread>
+#include <vector>
+
+namespace data {
+    
+    template <typename alloc>
+    void test_allocation_policy() {
+        
+        tool::linked_stack<int, alloc> s{};
+        for (int i = 0; i < 1000; i++) s = s << i;
+        EXPECT_EQ(s.size(), 1000);
+        EXPECT_EQ(s.first(), 999);
+        EXPECT_EQ(s[999], 0);
+        EXPECT_EQ(s, s.rest() << 999);
+        EXPECT_NE(s, s.rest());
+        
+        tool::linked_tree<int, alloc> t{1, tool::linked_tree<int, alloc>{2}, tool::linked_tree<int, alloc>{3}};
+        EXPECT_EQ(t.size(), 3);
+        EXPECT_TRUE(t.contains(3));
+        EXPECT_EQ(t.left().root(), 2);
+        
+        milewski::okasaki::OrdList<int, alloc> o{};
+        for (int i : {5, 1, 4, 2, 3}) o = o.inserted(i);
+        int expected = 1;
+        for (auto x = o; !x.isEmpty(); x = x.popped_front()) EXPECT_EQ(x.front(), expected++);
+        
+        milewski::okasaki::RBMap<int, int, alloc> m{};
+        for (int i = 0; i < 1000; i++) m = m.inserted((i * 7) % 1000, i);
+        for (int i = 0; i < 1000; i += 2) m = m.removed(i);
+        EXPECT_EQ(m.size(), 500);
+        EXPECT_TRUE(m.isRedBlack());
+        for (int i = 0; i < 1000; i++) EXPECT_EQ(m.member(i), i % 2 == 1);
+    }
+    
+    TEST(AllocationTest, TestShared) {
+        test_allocation_policy<tool::allocation::shared>();
+    }
+    
+    TEST(AllocationTest, TestPooled) {
+        test_allocation_policy<tool::allocation::pooled>();
+    }
+    
+    TEST(AllocationTest, TestLocal) {
+        test_allocation_policy<tool::allocation::local>();
+    }
+    
+    // a block is given back to the pool if the object in it cannot be made. 
+    TEST(AllocationTest, TestLocalThrows) {
+        struct refuses {
+            char Bytes[344];
+            refuses() {
+                throw std::runtime_error{"no"};
+            }
+        };
+        
+        // the reference count and the object share one block. 
+        using pointer = tool::allocation::local_ptr<refuses>;
+        using pool = tool::allocation::pool<sizeof(size_t) + sizeof(refuses), alignof(size_t)>;
+        EXPECT_THROW(pointer::make(), std::runtime_error);
+        size_t slabs = pool::slabs();
+        for (int i = 0; i < 10000; i++) EXPECT_THROW(pointer::make(), std::runtime_error);
+        EXPECT_EQ(pool::slabs(), slabs);
+    }
+    
+    // pooled nodes may be made in one thread and freed in another, 
+    // including after the thread which made them has exited. 
+    TEST(AllocationTest, TestPooledAcrossThreads) {
+        
+        using stack = tool::linked_stack<int, tool::allocation::pooled>;
+        std::vector<stack> made(4);
+        
+        std::vector<std::thread> threads{};
+        for (int t = 0; t < 4; t++) threads.emplace_back([&made, t]() {
+            stack s{};
+            for (int i = 0; i < 10000; i++) s = s << i;
+            made[t] = s;
+        });
+        for (auto& t : threads) t.join();
+        
+        for (const stack& s : made) EXPECT_EQ(s.size(), 10000);
+        
+        std::thread consumer{[&made]() {
+            for (stack& s : made) s = stack{};
+            stack s{};
+            for (int i = 0; i < 50000; i++) s = s << i;
+            EXPECT_EQ(s[49999], 0);
+        }};
+        consumer.join();
+    }
+    
+    // a thread which only frees blocks gives them up when it exits, 
+    // so the next thread that runs out gets them back. 
+    TEST(AllocationTest, TestFreeOnlyThread) {
+        using pool = tool::allocation::pool<200, 8>;
+        void* p = nullptr;
+        std::thread{[&p]() {
+            p = pool::allocate();
+        }}.join();
+        std::thread{[p]() {
+            pool::deallocate(p);
+        }}.join();
+        void* q = nullptr;
+        std::thread{[&q]() {
+            q = pool::allocate();
+            pool::deallocate(q);
+        }}.join();
+        EXPECT_EQ(p, q);
+    }
+    
+    // one thread allocates and another frees. The blocks that pile up 
+    // in the thread that frees must find their way back, so only as 
+    // many slabs are carved as are needed for the blocks in flight. 
+    TEST(AllocationTest, TestProducerConsumer) {
+        using pool = tool::allocation::pool<72, 8>;
+        size_t before = pool::slabs();
+        tool::bounded_channel<void*> c{1024};
+        std::thread consumer{[c]() mutable {
+            void* p;
+            while (c.get(p)) pool::deallocate(p);
+        }};
+        for (int i = 0; i < 1000000; i++) c.put(pool::allocate());
+        c.close();
+        consumer.join();
+        EXPECT_LE(pool::slabs() - before, 8);
+    }
+    
+}
@@ -0,0 +1,404 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <data/tools/channel.hpp>
+#include <data/tools/bounded_channel.hpp>
+#include <data/tools/spsc_channel.hpp>
+#include <data/tools/select.hpp>
+#include "gtest/gtest.h"
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace data {
+
+    // several threads put the numbers 1 to n and several threads get them.
+    template <typename chan>
+    void test_many(chan c, uint32 producers, uint32 consumers, uint64 n) {
+        std::vector<std::thread> put{};
+        for (uint32 p = 0; p < producers; p++) put.emplace_back([c, p, producers, n]() mutable {
+            for (uint64 i = p + 1; i <= n; i += producers) c.put(i);
+        });
+
+        std::vector<uint64> sums(consumers, 0);
+        std::vector<uint64> counts(consumers, 0);
+        std::vector<std::thread> get{};
+        for (uint32 q = 0; q < consumers; q++) get.emplace_back([c, q, &sums, &counts]() mutable {
+            uint64 x;
+            while (c.get(x)) {
+                sums[q] += x;
+                counts[q]++;
+            }
+        });
+
+        for (auto& t : put) t.join();
+        c.close();
+        for (auto& t : get) t.join();
+
+        uint64 sum = 0;
+        uint64 count = 0;
+        for (uint32 q = 0; q < consumers; q++) {
+            sum += sums[q];
+            count += counts[q];
+        }
+        EXPECT_EQ(count, n);
+        EXPECT_EQ(sum, n * (n + 1) / 2);
+    }
+
+    // like test_many, but with items passed in batches of up to b.
+    template <typename chan>
+    void test_batches(chan c, uint32 producers, uint32 consumers, uint64 n, uint32 b) {
+        std::vector<std::thread> put{};
+        for (uint32 p = 0; p < producers; p++) put.emplace_back([c, p, producers, n, b]() mutable {
+            std::vector<uint64> batch{};
+            for (uint64 i = p + 1; i <= n; i += producers) {
+                batch.push_back(i);
+                if (batch.size() == b) {
+                    c.put_n(batch.begin(), batch.end());
+                    batch.clear();
+                }
+            }
+            c.put_n(batch.begin(), batch.end());
+        });
+
+        std::vector<uint64> sums(consumers, 0);
+        std::vector<uint64> counts(consumers, 0);
+        std::vector<std::thread> get{};
+        for (uint32 q = 0; q < consumers; q++) get.emplace_back([c, q, b, &sums, &counts]() mutable {
+            std::vector<uint64> batch{};
+            while (c.get_n(std::back_inserter(batch), b) != 0) {
+                EXPECT_LE(batch.size(), b);
+                for (uint64 x : batch) sums[q] += x;
+                counts[q] += batch.size();
+                batch.clear();
+            }
+        });
+
+        for (auto& t : put) t.join();
+        c.close();
+        for (auto& t : get) t.join();
+
+        uint64 sum = 0;
+        uint64 count = 0;
+        for (uint32 q = 0; q < consumers; q++) {
+            sum += sums[q];
+            count += counts[q];
+        }
+        EXPECT_EQ(count, n);
+        EXPECT_EQ(sum, n * (n + 1) / 2);
+    }
+
+    // items that can only be moved, and a wait that times out.
+    template <typename chan>
+    void test_moves(chan c) {
+        using std::chrono::milliseconds;
+        std::unique_ptr<int> x{};
+        EXPECT_FALSE(c.try_get_for(x, milliseconds(10)));
+
+        c.put(std::make_unique<int>(1));
+        std::vector<std::unique_ptr<int>> v{};
+        for (int i = 2; i <= 4; i++) v.push_back(std::make_unique<int>(i));
+        c.put_n(std::make_move_iterator(v.begin()), std::make_move_iterator(v.end()));
+
+        EXPECT_TRUE(c.try_get_for(x, milliseconds(10)));
+        EXPECT_EQ(*x, 1);
+
+        std::vector<std::unique_ptr<int>> got{};
+        EXPECT_EQ(c.get_n(std::back_inserter(got), 0), 0);
+        EXPECT_EQ(c.get_n(std::back_inserter(got), 2), 2);
+        EXPECT_EQ(c.get_n(std::back_inserter(got), 5), 1);
+        EXPECT_EQ(c.get_n(std::back_inserter(got), 5, false), 0);
+        for (int i = 0; i < 3; i++) EXPECT_EQ(*got[i], i + 2);
+
+        // a waiting thread gets an item that is put later.
+        std::thread t{[c]() mutable {
+            std::unique_ptr<int> y{};
+            EXPECT_TRUE(c.try_get_for(y, std::chrono::seconds(10)));
+            EXPECT_EQ(*y, 5);
+            EXPECT_FALSE(c.try_get_for(y, std::chrono::seconds(10)));
+        }};
+        std::this_thread::sleep_for(milliseconds(20));
+        c.put(std::make_unique<int>(5));
+        std::this_thread::sleep_for(milliseconds(20));
+        c.close();
+        t.join();
+
+        EXPECT_THROW(c.put_n(std::make_move_iterator(v.begin()), std::make_move_iterator(v.end())), std::logic_error);
+    }
+
+    // an item that cannot be copied or moved into a channel if it is
+    // -1, and that cannot be moved out of a channel if it is -2.
+    struct fragile {
+        int X;
+
+        explicit fragile(int x = 0) : X{x} {}
+
+        fragile(const fragile &f) : X{f.X} {
+            if (X == -1) throw std::runtime_error{"put"};
+        }
+
+        fragile(fragile &&f) : X{f.X} {
+            if (X == -1) throw std::runtime_error{"put"};
+        }
+
+        fragile &operator=(const fragile &f) = default;
+
+        fragile &operator=(fragile &&f) {
+            if (f.X == -2) throw std::runtime_error{"get"};
+            X = f.X;
+            return *this;
+        }
+    };
+
+    // an item that throws is not put or is lost, and the channel
+    // goes on working, with every slot going around the ring.
+    template <typename chan>
+    void test_throws(chan c, uint32 producers) {
+        auto round = [&c]() {
+            fragile x{};
+            for (int i = 0; i < 3 * int(c.size()); i++) {
+                c.put(fragile{i});
+                EXPECT_TRUE(c.get(x));
+                EXPECT_EQ(x.X, i);
+            }
+            EXPECT_FALSE(c.get(x, false));
+        };
+
+        fragile x{};
+        EXPECT_THROW(c.put(fragile{-1}), std::runtime_error);
+        EXPECT_THROW(c.try_put(fragile{-1}), std::runtime_error);
+        EXPECT_FALSE(c.get(x, false));
+        c.put(fragile{1});
+        EXPECT_TRUE(c.get(x));
+        EXPECT_EQ(x.X, 1);
+        round();
+
+        // the items before the one that throws are put.
+        std::vector<fragile> v{};
+        v.reserve(4);
+        for (int i : {1, 2, -1, 3}) v.emplace_back(i);
+        EXPECT_THROW(c.put_n(v.begin(), v.end()), std::runtime_error);
+        std::vector<fragile> got{};
+        EXPECT_EQ(c.get_n(std::back_inserter(got), 4), 2);
+        EXPECT_EQ(got[0].X, 1);
+        EXPECT_EQ(got[1].X, 2);
+        EXPECT_FALSE(c.get(x, false));
+        round();
+
+        c.put(fragile{-2});
+        c.put(fragile{5});
+        EXPECT_THROW(c.get(x), std::runtime_error);
+        EXPECT_TRUE(c.get(x));
+        EXPECT_EQ(x.X, 5);
+        round();
+
+        // get_n loses the items after the one that throws.
+        std::vector<fragile> three(3);
+        c.put(fragile{6});
+        c.put(fragile{-2});
+        c.put(fragile{7});
+        EXPECT_THROW(c.get_n(three.begin(), 3), std::runtime_error);
+        EXPECT_EQ(three[0].X, 6);
+        EXPECT_EQ(three[2].X, 0);
+        EXPECT_FALSE(c.get(x, false));
+        round();
+
+        // threads that wait are not stuck behind items that threw.
+        std::vector<std::thread> threads{};
+        for (uint32 p = 0; p < producers; p++) threads.emplace_back([c]() mutable {
+            for (int i = 1; i <= 10000; i++) try {
+                c.put(fragile{i % 10 == 0 ? -1 : i});
+            } catch (const std::runtime_error &) {}
+        });
+        int64 sum = 0;
+        std::thread consumer{[c, &sum]() mutable {
+            fragile y{};
+            while (c.get(y)) sum += y.X;
+        }};
+        for (auto &t : threads) t.join();
+        c.close();
+        consumer.join();
+        EXPECT_EQ(sum, int64(producers) * 45000000);
+    }
+
+    // an item left in the channel is destroyed with it.
+    template <typename chan>
+    void test_leftovers(chan c) {
+        c.put(fragile{8});
+        EXPECT_THROW(c.put(fragile{-1}), std::runtime_error);
+        c.put(fragile{9});
+    }
+
+    TEST(ChannelTest, TestChannel) {
+        tool::channel<int> c{};
+        int x;
+        EXPECT_FALSE(c.get(x, false));
+        c.put(1);
+        c.put(2);
+        EXPECT_FALSE(c.closed());
+        c.close();
+        EXPECT_TRUE(c.closed());
+        EXPECT_THROW(c.put(3), std::logic_error);
+        EXPECT_TRUE(c.get(x));
+        EXPECT_EQ(x, 1);
+        EXPECT_TRUE(c.get(x));
+        EXPECT_EQ(x, 2);
+        EXPECT_FALSE(c.get(x));
+
+        test_many(tool::channel<uint64>{16}, 1, 1, 20000);
+        test_many(tool::channel<uint64>{16}, 3, 2, 20000);
+        test_many(tool::channel<uint64>{}, 2, 3, 20000);
+    }
+
+    TEST(ChannelTest, TestBoundedChannel) {
+        tool::bounded_channel<std::string> c{3};
+        EXPECT_EQ(c.size(), 4);
+        std::string x;
+        EXPECT_FALSE(c.get(x, false));
+        for (int i = 0; i < 4; i++) EXPECT_TRUE(c.try_put(std::to_string(i)));
+        EXPECT_FALSE(c.try_put("full"));
+        EXPECT_TRUE(c.get(x));
+        EXPECT_EQ(x, "0");
+        c.put("4");
+
+        c.close();
+        EXPECT_THROW(c.put("5"), std::logic_error);
+        for (int i = 1; i < 5; i++) {
+            EXPECT_TRUE(c.get(x));
+            EXPECT_EQ(x, std::to_string(i));
+        }
+        EXPECT_FALSE(c.get(x));
+
+        // items that are never got are destroyed with the channel.
+        tool::bounded_channel<std::string> d{8};
+        for (int i = 0; i < 5; i++) d.put(std::string(100, 'x'));
+        d.get(x);
+
+        // a thread waiting to get is woken by close.
+        tool::bounded_channel<int> e{2};
+        std::thread t{[e]() mutable {
+            int y;
+            EXPECT_FALSE(e.get(y));
+        }};
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        e.close();
+        t.join();
+
+        test_many(tool::bounded_channel<uint64>{2}, 1, 1, 20000);
+        test_many(tool::bounded_channel<uint64>{16}, 4, 4, 100000);
+        test_many(tool::bounded_channel<uint64>{1024}, 8, 2, 100000);
+        test_many(tool::bounded_channel<uint64>{4}, 2, 8, 20000);
+        test_throws(tool::bounded_channel<fragile>{4}, 3);
+        test_leftovers(tool::bounded_channel<fragile>{4});
+    }
+
+    TEST(ChannelTest, TestBatches) {
+        test_moves(tool::channel<std::unique_ptr<int>>{});
+        test_moves(tool::channel<std::unique_ptr<int>>{4});
+        test_moves(tool::bounded_channel<std::unique_ptr<int>>{4});
+
+        test_batches(tool::channel<uint64>{16}, 1, 1, 20000, 64);
+        test_batches(tool::channel<uint64>{}, 3, 2, 20000, 100);
+        test_batches(tool::bounded_channel<uint64>{2}, 1, 1, 20000, 7);
+        test_batches(tool::bounded_channel<uint64>{64}, 4, 4, 100000, 64);
+        test_batches(tool::bounded_channel<uint64>{1024}, 2, 8, 100000, 1000);
+    }
+
+    TEST(ChannelTest, TestSpscChannel) {
+        tool::spsc_channel<std::string> c{3};
+        EXPECT_EQ(c.size(), 4);
+        std::string x;
+        EXPECT_FALSE(c.get(x, false));
+        for (int i = 0; i < 4; i++) EXPECT_TRUE(c.try_put(std::to_string(i)));
+        EXPECT_FALSE(c.try_put("full"));
+        EXPECT_TRUE(c.get(x));
+        EXPECT_EQ(x, "0");
+        c.put("4");
+
+        c.close();
+        EXPECT_THROW(c.put("5"), std::logic_error);
+        for (int i = 1; i < 5; i++) {
+            EXPECT_TRUE(c.get(x));
+            EXPECT_EQ(x, std::to_string(i));
+        }
+        EXPECT_FALSE(c.get(x));
+
+        tool::spsc_channel<std::string> d{8};
+        for (int i = 0; i < 5; i++) d.put(std::string(100, 'x'));
+        d.get(x);
+
+        test_moves(tool::spsc_channel<std::unique_ptr<int>>{4});
+        test_many(tool::spsc_channel<uint64>{2}, 1, 1, 20000);
+        test_many(tool::spsc_channel<uint64>{1024}, 1, 1, 100000);
+        test_batches(tool::spsc_channel<uint64>{2}, 1, 1, 20000, 3);
+        test_batches(tool::spsc_channel<uint64>{256}, 1, 1, 100000, 64);
+        test_throws(tool::spsc_channel<fragile>{4}, 1);
+        test_leftovers(tool::spsc_channel<fragile>{4});
+    }
+
+    TEST(ChannelTest, TestSelect) {
+        tool::channel<int> a{};
+        tool::bounded_channel<std::string> b{4};
+        tool::spsc_channel<uint64> c{4};
+
+        int i = 0;
+        std::string s{};
+        uint64 u = 0;
+        auto on_a = tool::on(a.From, [&i](int x) {
+            i += x;
+        });
+        auto on_b = tool::on(b.From, [&s](std::string x) {
+            s += x;
+        });
+        auto on_c = tool::on(c.From, [&u](uint64 x) {
+            u += x;
+        });
+
+        EXPECT_EQ(tool::try_select(on_a, on_b, on_c), -1);
+        b.put("x");
+        EXPECT_EQ(tool::try_select(on_a, on_b, on_c), 1);
+        EXPECT_EQ(s, "x");
+
+        // a select that is waiting is woken by a put.
+        std::thread t{[b]() mutable {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            b.put("y");
+        }};
+        EXPECT_EQ(tool::select(on_a, on_b, on_c), 1);
+        EXPECT_EQ(s, "xy");
+        t.join();
+
+        // one thread drains three channels that are put to by others.
+        uint64 n = 20000;
+        std::thread pa{[a, n]() mutable {
+            for (uint64 x = 0; x < n; x++) a.put(1);
+            a.close();
+        }};
+        std::thread pb{[b, n]() mutable {
+            for (uint64 x = 0; x < n; x++) b.put("z");
+            b.close();
+        }};
+        std::thread pc{[c, n]() mutable {
+            for (uint64 x = 1; x <= n; x++) c.put(x);
+            c.close();
+        }};
+
+        std::vector<uint64> counts(3, 0);
+        int r;
+        while ((r = tool::select(on_a, on_b, on_c)) >= 0) counts[r]++;
+        pa.join();
+        pb.join();
+        pc.join();
+
+        EXPECT_EQ(counts, (std::vector<uint64>{n, n, n}));
+        EXPECT_EQ(i, n);
+        EXPECT_EQ(s.size(), n + 2);
+        EXPECT_EQ(u, n * (n + 1) / 2);
+        EXPECT_EQ(tool::select(on_a, on_b, on_c), -1);
+    }
+
+}
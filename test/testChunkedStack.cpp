@@ -0,0 +1,102 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <data/tools/chunked_stack.hpp>
+#include <data/tools/functional_queue.hpp>
+#include <data/fold.hpp>
+#include "gtest/gtest.h"
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace data {
+    template <typename elem>
+    using chunked = tool::chunked_stack<elem, 4>;
+    
+    TEST(ChunkedStackTest, TestChunkedStack) {
+        
+        EXPECT_TRUE(chunked<int>{} == chunked<int>());
+        EXPECT_TRUE(chunked<int>(1) == chunked<int>(1));
+        EXPECT_FALSE(chunked<int>(1) == chunked<int>{});
+        EXPECT_FALSE(chunked<int>(1) == chunked<int>(0));
+        EXPECT_TRUE(chunked<int>(1).rest() == chunked<int>{});
+        
+        chunked<int> l{1, 2, 3, 4, 5, 6, 7, 8, 9};
+        EXPECT_EQ(l.size(), 9);
+        EXPECT_EQ(l.first(), 1);
+        EXPECT_EQ(l[8], 9);
+        EXPECT_EQ(l.from(5).first(), 6);
+        EXPECT_EQ(l.from(5).size(), 4);
+        EXPECT_TRUE(l.from(9).empty());
+        EXPECT_TRUE(l.contains(7));
+        EXPECT_FALSE(l.contains(10));
+        EXPECT_EQ(l, chunked<int>{} << 9 << 8 << 7 << 6 << 5 << 4 << 3 << 2 << 1);
+        EXPECT_EQ(data::reverse(l).first(), 9);
+        
+        int expected = 1;
+        for (int x : l) EXPECT_EQ(x, expected++);
+        EXPECT_EQ(expected, 10);
+    }
+    
+    // pushing onto an old version of a stack must not 
+    // disturb newer versions which share its chunk. 
+    TEST(ChunkedStackTest, TestChunkedStackPersistence) {
+        
+        chunked<std::string> a = chunked<std::string>{} << "a" << "b";
+        chunked<std::string> b = a << "c";
+        chunked<std::string> c = a << "d";
+        chunked<std::string> d = a.rest() << "e";
+        
+        EXPECT_EQ(a, (chunked<std::string>{"b", "a"}));
+        EXPECT_EQ(b, (chunked<std::string>{"c", "b", "a"}));
+        EXPECT_EQ(c, (chunked<std::string>{"d", "b", "a"}));
+        EXPECT_EQ(d, (chunked<std::string>{"e", "a"}));
+        EXPECT_EQ(b.rest(), a);
+        EXPECT_EQ(c.rest(), a);
+    }
+    
+    TEST(ChunkedStackTest, TestChunkedStackConcurrentPush) {
+        
+        chunked<int> base = chunked<int>{} << 0;
+        std::vector<chunked<int>> pushed(8);
+        std::vector<std::thread> threads{};
+        for (int t = 0; t < 8; t++) threads.emplace_back([&pushed, base, t]() {
+            chunked<int> s = base;
+            for (int i = 1; i <= 1000; i++) s = s << t * 1000 + i;
+            pushed[t] = s;
+        });
+        for (auto& t : threads) t.join();
+        
+        for (int t = 0; t < 8; t++) {
+            EXPECT_EQ(pushed[t].size(), 1001);
+            int expected = t * 1000 + 1000;
+            for (int x : pushed[t]) {
+                if (expected == t * 1000) EXPECT_EQ(x, 0);
+                else EXPECT_EQ(x, expected);
+                expected--;
+            }
+        }
+    }
+    
+    TEST(ChunkedStackTest, TestChunkedStackAsSequence) {
+        
+        tool::functional_queue<chunked<int>> q{};
+        for (int i = 0; i < 20; i++) q = q << i;
+        EXPECT_EQ(q.size(), 20);
+        EXPECT_EQ(q.first(), 0);
+        EXPECT_EQ(q.rest().first(), 1);
+        
+        chunked<int> l{};
+        for (int i = 1; i <= 100; i++) l = l << i;
+        EXPECT_EQ(data::fold([](int a, int b) -> int {
+            return a + b;
+        }, 0, l), 5050);
+        
+        // destroying a long stack must not overflow the call stack. 
+        chunked<int> big{};
+        for (int i = 0; i < 1000000; i++) big = big << i;
+        EXPECT_EQ(big.size(), 1000000);
+        big = chunked<int>{};
+    }
+}
@@ -0,0 +1,114 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <data/math/permutation.hpp>
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+namespace data {
+    using dense = math::dense_permutation;
+
+    dense random_permutation(size_t n, std::mt19937& random) {
+        std::vector<uint32> v(n);
+        std::iota(v.begin(), v.end(), 0);
+        std::shuffle(v.begin(), v.end(), random);
+        return dense{v};
+    }
+
+    TEST(DensePermutationTest, TestDensePermutation) {
+        EXPECT_TRUE(dense{}.is_identity());
+        EXPECT_EQ(dense{}, dense(5));
+        EXPECT_EQ(dense(5)(7), 7);
+        EXPECT_THROW(dense(std::vector<uint32>{0, 0}), std::invalid_argument);
+        EXPECT_THROW(dense(std::vector<uint32>{1, 2}), std::invalid_argument);
+        EXPECT_THROW(dense::from_cycles({{1, 2}, {2, 3}}), std::invalid_argument);
+
+        dense p = dense::from_cycles({{1, 2, 3}});
+        EXPECT_EQ(p(1), 2);
+        EXPECT_EQ(p(3), 1);
+        EXPECT_EQ(p(0), 0);
+        EXPECT_EQ(p * p * p, dense{});
+        EXPECT_EQ(p * p, p.inverse());
+        EXPECT_EQ(p.signature(), math::positive);
+        EXPECT_EQ(dense::from_cycles({{4, 0}}).signature(), math::negative);
+
+        // (p * q)(i) = p(q(i))
+        dense q = dense::from_cycles({{0, 1}}, 8);
+        EXPECT_EQ((p * q)(0), 2);
+        EXPECT_EQ((q * p)(0), 1);
+        EXPECT_EQ((p * q).degree(), 8);
+        EXPECT_EQ((p * q).cycles(), (std::vector<std::vector<uint32>>{{0, 2, 3, 1}}));
+    }
+
+    TEST(DensePermutationTest, TestDensePermutationRandom) {
+        std::mt19937 random{11};
+        for (size_t n : {1, 2, 10, 1000, 20000}) {
+            dense p = random_permutation(n, random);
+            dense q = random_permutation(n, random);
+            dense pq = p * q;
+            for (uint32 i = 0; i < n; i++) EXPECT_EQ(pq(i), p(q(i)));
+
+            EXPECT_TRUE((p * p.inverse()).is_identity());
+            EXPECT_TRUE((p.inverse() * p).is_identity());
+            EXPECT_EQ(dense::from_cycles(p.cycles(), n), p);
+            EXPECT_EQ(pq.signature(), p.signature() * q.signature());
+            EXPECT_EQ(pq.inverse(), q.inverse() * p.inverse());
+        }
+    }
+
+    TEST(DensePermutationTest, TestCycleForm) {
+        using perm = math::permutation<uint32>;
+        using cycle = perm::cycle;
+
+        perm p12{cycle{1, 2}};
+        perm p23{cycle{2, 3}};
+        perm p123{cycle{1, 2, 3}};
+        perm p321{cycle{3, 2, 1}};
+
+        EXPECT_EQ(p12 * p12, perm{});
+        EXPECT_EQ(p123 * p321, perm{});
+        EXPECT_EQ(p123 * p123, p321);
+        EXPECT_EQ(p123.inverse(), p321);
+        EXPECT_EQ(p12 * p23, p123);
+        EXPECT_EQ((cycle{1, 2} * cycle{2, 3}), p123);
+        EXPECT_EQ((perm{cycle{1, 2}, cycle{2, 3}}), p123);
+        EXPECT_EQ(p123 * 3, 1);
+        EXPECT_EQ(p12.signature(), math::negative);
+        EXPECT_EQ(p123.signature(), math::positive);
+
+        EXPECT_EQ(p123.dense(), dense::from_cycles({{1, 2, 3}}));
+        EXPECT_EQ(perm{p123.dense()}, p123);
+        EXPECT_EQ((perm{cycle{1, 1}}.dense()), dense{});
+    }
+
+    // points that are negative or far apart are numbered
+    // before they are put in dense form.
+    TEST(DensePermutationTest, TestSparsePoints) {
+        using perm = math::permutation<int>;
+        using cycle = perm::cycle;
+
+        perm n{cycle{-1, 2}};
+        EXPECT_EQ(n * -1, 2);
+        EXPECT_EQ(n * n, perm{});
+        EXPECT_EQ(n.inverse(), n);
+        EXPECT_NE(n, (perm{cycle{-1, 3}}));
+        EXPECT_EQ((perm{cycle{-5, -3}, cycle{-3, 7}}), (perm{cycle{-5, -3, 7}}));
+        EXPECT_THROW(n.dense(), std::invalid_argument);
+
+        perm b{cycle{1000000000, 1}};
+        perm c{cycle{1, 2000000000}};
+        EXPECT_EQ(b * 1, 1000000000);
+        EXPECT_EQ(b * b, perm{});
+        EXPECT_EQ(b * c, (perm{cycle{1, 2000000000, 1000000000}}));
+        EXPECT_NE(b, c);
+
+        using wide = math::permutation<uint64>;
+        EXPECT_EQ((wide{wide::cycle{0, uint64(1) << 40}} * wide{wide::cycle{0, 1}}),
+            (wide{wide::cycle{0, 1, uint64(1) << 40}}));
+        EXPECT_THROW((wide{wide::cycle{0, uint64(1) << 40}}.dense()), std::invalid_argument);
+    }
+
+}
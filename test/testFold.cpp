@@ -0,0 +1,122 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <data/tools.hpp>
+#include <data/parallel.hpp>
+#include "gtest/gtest.h"
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+namespace data {
+
+    // associative but not commutative.
+    struct concatenate {
+        string operator()(const string& a, const string& b) const {
+            return a + b;
+        }
+    };
+
+    // neither associative nor commutative.
+    struct subtract {
+        int64 operator()(int64 a, int64 b) const {
+            return a - b;
+        }
+    };
+
+    // associative and commutative, but it will not add zero.
+    struct add_nonzero {
+        int64 operator()(int64 a, int64 b) const {
+            if (a == 0 || b == 0) throw std::domain_error{"zero"};
+            return a + b;
+        }
+    };
+
+    // associative, and it will not concatenate "0".
+    struct concatenate_nonzero {
+        string operator()(const string& a, const string& b) const {
+            if (a == "0" || b == "0") throw std::domain_error{"zero"};
+            return a + b;
+        }
+    };
+
+}
+
+namespace data::math {
+    template <> struct associative<data::concatenate, data::string> {};
+    template <> struct associative<data::concatenate_nonzero, data::string> {};
+    template <> struct associative<data::add_nonzero, data::int64> {};
+    template <> struct commutative<data::add_nonzero, data::int64> {};
+}
+
+namespace data {
+
+    TEST(FoldTest, TestFoldLong) {
+        stack<uint64> s{};
+        for (uint64 i = 1; i <= 1000000; i++) s = s << i;
+
+        auto sum = [](uint64 a, uint64 b) -> uint64 {
+            return a + b;
+        };
+
+        EXPECT_EQ(fold(sum, uint64{0}, s), 500000500000);
+        EXPECT_EQ(reduce<uint64>(sum, s), 500000500000);
+        EXPECT_EQ(nest([](uint64 x) -> uint64 {
+            return x + 2;
+        }, 1000000, uint64{1}), 2000001);
+
+        // reduce goes from the right.
+        EXPECT_EQ((reduce<string>([](const string& a, const string& b) -> string {
+            return a + b;
+        }, stack<string>{"a", "b", "c"})), "abc");
+    }
+
+    TEST(FoldTest, TestParallelReduce) {
+        static_assert(meta::is_associative<plus<uint64>, uint64>::value);
+        static_assert(meta::is_commutative<plus<uint64>, uint64>::value);
+        static_assert(meta::is_associative<concatenate, string>::value);
+        static_assert(!meta::is_commutative<concatenate, string>::value);
+        static_assert(!meta::is_associative<subtract, int64>::value);
+
+        cross<uint64> c(1000000);
+        std::iota(c.begin(), c.end(), 1);
+        for (uint32 threads : {1, 2, 3, 8})
+            EXPECT_EQ(parallel_reduce(plus<uint64>{}, c, threads, 1000), 500000500000);
+        EXPECT_EQ(parallel_reduce(plus<uint64>{}, cross<uint64>{}), 0);
+        EXPECT_EQ(parallel_reduce(plus<uint64>{}, c, 4, 0), 500000500000);
+        EXPECT_EQ(parallel_reduce(plus<uint64>{}, cross<uint64>{}, 4, 0), 0);
+        EXPECT_EQ(parallel_reduce(plus<uint64>{}, cross<uint64>{1}, 4, 0), 1);
+
+        std::vector<string> words{};
+        string expected{};
+        for (int i = 0; i < 5000; i++) {
+            words.push_back(std::to_string(i));
+            expected += words.back();
+        }
+        EXPECT_EQ(parallel_reduce(concatenate{}, words, 4, 100), expected);
+        EXPECT_EQ(parallel_reduce(concatenate{}, words, 4, 0), expected);
+
+        // the order is kept even though the operation cannot be split.
+        std::vector<int64> v(10000);
+        std::iota(v.begin(), v.end(), 0);
+        EXPECT_EQ(parallel_reduce(subtract{}, v, 4, 100), -49995000);
+
+        std::vector<string> w(words.begin(), words.begin() + 3000);
+        tool::linked_tree<string> t = tool::linked_tree<string>::balanced(w.begin(), w.end());
+        string e{};
+        for (const string& x : w) e += x;
+        EXPECT_EQ(parallel_reduce(concatenate{}, t, 4, 100), e);
+        EXPECT_EQ(parallel_reduce(concatenate{}, tool::linked_tree<string>{}), "");
+
+        std::vector<int64> u(v.begin(), v.begin() + 100);
+        EXPECT_EQ(parallel_reduce(subtract{}, tool::linked_tree<int64>::balanced(u.begin(), u.end()), 4, 10), -4950);
+
+        // the part that throws is done in the calling thread, which
+        // must wait for the others before the exception leaves.
+        static_assert(meta::is_commutative<add_nonzero, int64>::value);
+        EXPECT_THROW(parallel_reduce(add_nonzero{}, v, 4, 100), std::domain_error);
+        EXPECT_THROW(parallel_reduce(concatenate_nonzero{}, words, 4, 100), std::domain_error);
+    }
+
+}
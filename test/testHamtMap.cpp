@@ -0,0 +1,183 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <data/tools.hpp>
+#include <data/crypto/digest.hpp>
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace data {
+
+    // puts every key into one of a few buckets, so that there are
+    // many full collisions.
+    struct bad_hash {
+        size_t operator()(int x) const {
+            return static_cast<size_t>(x % 7);
+        }
+    };
+
+    template <typename map>
+    void expect_same(const map& m, const std::unordered_map<int, int>& u) {
+        ASSERT_EQ(m.size(), u.size());
+        size_t count = 0;
+        for (const auto& e : m) {
+            auto i = u.find(e.Key);
+            ASSERT_NE(i, u.end());
+            EXPECT_EQ(i->second, e.Value);
+            count++;
+        }
+        EXPECT_EQ(count, u.size());
+        for (const auto& p : u) EXPECT_EQ(m[p.first], p.second);
+    }
+
+    template <typename hash>
+    void test_hamt_map() {
+        using map = tool::hamt_map<int, int, hash>;
+
+        map e{};
+        EXPECT_TRUE(e.empty());
+        EXPECT_EQ(e.begin(), e.end());
+        EXPECT_FALSE(e.contains(1));
+        EXPECT_EQ(e.remove(1), e);
+
+        map m{{1, 2}, {3, 4}};
+        EXPECT_EQ(m.size(), 2);
+        EXPECT_EQ(m[1], 2);
+        EXPECT_EQ(m[3], 4);
+        EXPECT_EQ(m[5], 0);
+        EXPECT_EQ(m.find(5), nullptr);
+        EXPECT_EQ(m.insert(1, 5)[1], 5);
+        EXPECT_EQ(m[1], 2);
+        EXPECT_EQ(m.insert(1, 2), m);
+        EXPECT_EQ(m.remove(1).remove(3), e);
+        EXPECT_EQ(m.remove(1), (map{{3, 4}}));
+
+        // compare against std::unordered_map while reusing old versions.
+        std::mt19937 random{5};
+        std::vector<map> versions{map{}};
+        std::vector<std::unordered_map<int, int>> expected{{}};
+        for (int i = 0; i < 3000; i++) {
+            size_t v = random() % versions.size();
+            map x = versions[v];
+            std::unordered_map<int, int> u = expected[v];
+            int k = random() % 500;
+            if (random() % 3 == 0) {
+                x = x.remove(k);
+                u.erase(k);
+            } else {
+                int value = random() % 100;
+                x = x.insert(k, value);
+                u[k] = value;
+            }
+            versions.push_back(x);
+            expected.push_back(u);
+        }
+
+        for (size_t i = 0; i < versions.size(); i += 97) expect_same(versions[i], expected[i]);
+
+        // the form of the trie does not depend on the order of insertion.
+        std::vector<int> keys(1000);
+        for (int i = 0; i < 1000; i++) keys[i] = i * 31;
+        map a{};
+        for (int k : keys) a = a.insert(k, k);
+        std::shuffle(keys.begin(), keys.end(), random);
+        map b{};
+        for (int k : keys) b = b.insert(k, k);
+        EXPECT_EQ(a, b);
+        EXPECT_NE(a, b.insert(0, 1));
+        for (int k : keys) if (k % 2 == 0) b = b.remove(k);
+        EXPECT_NE(a, b);
+        for (int k : keys) if (k % 2 == 0) b = b.insert(k, k);
+        EXPECT_EQ(a, b);
+    }
+
+    TEST(HamtMapTest, TestHamtMap) {
+        test_hamt_map<std::hash<int>>();
+        test_hamt_map<bad_hash>();
+    }
+
+    TEST(HamtMapTest, TestHamtTransient) {
+        using map = tool::hamt_map<int, int>;
+        map::transient t{};
+        std::unordered_map<int, int> u{};
+        for (int i = 0; i < 10000; i++) {
+            t.insert(i, i * 2);
+            u[i] = i * 2;
+        }
+
+        map m = t.persistent();
+        expect_same(m, u);
+
+        // changes to the transient after it has been made
+        // persistent do not change the map.
+        for (int i = 0; i < 10000; i += 2) t.remove(i);
+        for (int i = 1; i < 10000; i += 4) t.insert(i, 0);
+        expect_same(m, u);
+        EXPECT_EQ(t.size(), 5000);
+        EXPECT_TRUE(t.contains(1));
+        EXPECT_FALSE(t.contains(2));
+        EXPECT_EQ(*t.find(1), 0);
+        EXPECT_EQ(*t.find(3), 6);
+
+        map::transient r{m};
+        for (int i = 0; i < 10000; i++) r.remove(i);
+        EXPECT_EQ(r.size(), 0);
+        EXPECT_EQ(r.persistent(), map{});
+        expect_same(m, u);
+
+        std::vector<map::entry> entries{};
+        for (const auto& p : u) entries.push_back(map::entry{p.first, p.second});
+        EXPECT_EQ(map::from(entries.begin(), entries.end()), m);
+    }
+
+    TEST(HamtMapTest, TestHamtSet) {
+        using set = tool::hamt_set<int>;
+
+        set a{};
+        set b{};
+        for (int i = 0; i < 100; i++) {
+            if (i % 2 == 0) a = a.insert(i);
+            if (i % 3 == 0) b = b.insert(i);
+        }
+
+        set u = a & b;
+        set n = a | b;
+        set d = a - b;
+        for (int i = 0; i < 100; i++) {
+            EXPECT_EQ(u.contains(i), i % 2 == 0 || i % 3 == 0);
+            EXPECT_EQ(n.contains(i), i % 6 == 0);
+            EXPECT_EQ(d.contains(i), i % 2 == 0 && i % 3 != 0);
+        }
+
+        EXPECT_EQ(u.size(), 67);
+        EXPECT_EQ(n.size(), 17);
+        EXPECT_EQ(d.size(), 33);
+        EXPECT_EQ(d & n, a);
+    }
+
+    TEST(HamtMapTest, TestHamtDigest) {
+        using digest = crypto::digest<32>;
+        hash_map<digest, int> m{};
+        std::vector<digest> keys{};
+        std::mt19937 random{3};
+        for (int i = 0; i < 1000; i++) {
+            digest d{};
+            for (byte& x : d) x = static_cast<byte>(random());
+            keys.push_back(d);
+            m = m.insert(d, i);
+        }
+
+        EXPECT_EQ(m.size(), 1000);
+        for (int i = 0; i < 1000; i++) EXPECT_EQ(m[keys[i]], i);
+
+        std::vector<const int*> found = tool::find_all(m, keys.begin(), keys.end(), 4, 100);
+        for (int i = 0; i < 1000; i++) EXPECT_EQ(*found[i], i);
+        EXPECT_EQ(tool::find_all(m, keys.begin(), keys.end(), 4, 0), found);
+        EXPECT_EQ(tool::find_all(m.remove(keys[5]), keys.begin(), keys.end())[5], nullptr);
+    }
+
+}
@@ -0,0 +1,87 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <data/tools/indexed_list.hpp>
+#include "gtest/gtest.h"
+#include <vector>
+
+namespace data {
+    using seq = tool::indexed_list<int>;
+    
+    void expect_same(const seq& s, const std::vector<int>& v) {
+        ASSERT_EQ(s.size(), v.size());
+        size_t i = 0;
+        for (int x : s) EXPECT_EQ(x, v[i++]);
+        EXPECT_EQ(i, v.size());
+        for (size_t j = 0; j < v.size(); j += 7) EXPECT_EQ(s[j], v[j]);
+    }
+    
+    TEST(IndexedListTest, TestIndexedList) {
+        
+        seq e{};
+        EXPECT_TRUE(e.empty());
+        EXPECT_EQ(e.begin(), e.end());
+        
+        seq s = seq{} << 1 << 2 << 3;
+        EXPECT_EQ(s, (seq{1, 2, 3}));
+        EXPECT_NE(s, (seq{1, 2}));
+        EXPECT_EQ(s.first(), 1);
+        EXPECT_EQ(s.last(), 3);
+        EXPECT_EQ(s.rest(), (seq{2, 3}));
+        EXPECT_EQ(s.prepend(0), (seq{0, 1, 2, 3}));
+        EXPECT_EQ((seq{0, s}), (seq{0, 1, 2, 3}));
+        EXPECT_EQ(s.update(1, 5), (seq{1, 5, 3}));
+        EXPECT_EQ(s.insert(3, 4), (seq{1, 2, 3, 4}));
+        EXPECT_EQ(s.remove(0), (seq{2, 3}));
+        EXPECT_THROW(s[3], std::out_of_range);
+    }
+    
+    TEST(IndexedListTest, TestIndexedListSplitConcat) {
+        
+        std::vector<int> v{};
+        for (int i = 0; i < 1000; i++) v.push_back(i);
+        seq s = seq::from(v.begin(), v.end());
+        expect_same(s, v);
+        
+        for (size_t n : {size_t(0), size_t(1), size_t(499), size_t(500), size_t(999), size_t(1000)}) {
+            auto p = s.split(n);
+            expect_same(p.first, std::vector<int>(v.begin(), v.begin() + n));
+            expect_same(p.second, std::vector<int>(v.begin() + n, v.end()));
+            EXPECT_EQ(p.first << p.second, s);
+        }
+        
+        // concatenate lists of very different sizes. 
+        seq small = seq{-1, -2};
+        std::vector<int> w = v;
+        w.insert(w.end(), {-1, -2});
+        expect_same(s << small, w);
+        w = std::vector<int>{-1, -2};
+        w.insert(w.end(), v.begin(), v.end());
+        expect_same(small << s, w);
+        
+        // random edits against a vector. 
+        seq t{};
+        std::vector<int> u{};
+        for (int i = 0; i < 3000; i++) {
+            size_t at = u.empty() ? 0 : (size_t(i) * 7919) % (u.size() + 1);
+            if (i % 4 == 3 && at < u.size()) {
+                t = t.remove(at);
+                u.erase(u.begin() + at);
+            } else if (i % 5 == 4 && at < u.size()) {
+                t = t.update(at, -i);
+                u[at] = -i;
+            } else {
+                t = t.insert(at, i);
+                u.insert(u.begin() + at, i);
+            }
+        }
+        expect_same(t, u);
+        
+        seq sorted = seq::from(v.begin(), v.end());
+        EXPECT_EQ(sorted.partition_point([](int x) -> bool {
+            return x < 317;
+        }), 317);
+    }
+    
+}
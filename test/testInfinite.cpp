@@ -0,0 +1,92 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <data/list/infinite.hpp>
+#include "gtest/gtest.h"
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+namespace data {
+
+    TEST(InfiniteTest, TestInfiniteMemoized) {
+        std::atomic<int> calls{0};
+        auto next = [&calls](uint64 x) -> uint64 {
+            calls++;
+            return x + 1;
+        };
+
+        infinite<uint64, decltype(next)> naturals{next, 0};
+        auto a = naturals;
+        for (int i = 0; i < 100; i++) {
+            EXPECT_EQ(a.first(), i);
+            a = a.rest();
+        }
+        EXPECT_EQ(calls, 100);
+
+        // a copy made before the walk shares what was computed.
+        auto b = naturals;
+        for (int i = 0; i < 100; i++) b = b.rest();
+        EXPECT_EQ(b.first(), 100);
+        EXPECT_EQ(calls, 100);
+
+        // read from several threads at once.
+        std::vector<std::thread> threads{};
+        for (int t = 0; t < 4; t++) threads.emplace_back([naturals]() {
+            auto c = naturals;
+            for (int i = 0; i < 1000; i++) c = c.rest();
+            EXPECT_EQ(c.first(), 1000);
+        });
+        for (auto& t : threads) t.join();
+        EXPECT_EQ(calls, 1000);
+    }
+
+    TEST(InfiniteTest, TestInfiniteLong) {
+        auto next = [](uint64 x) -> uint64 {
+            return x + 1;
+        };
+
+        // a list with a million computed elements is
+        // destroyed without running out of stack.
+        infinite<uint64, decltype(next)> naturals{next, 0};
+        auto a = naturals;
+        for (int i = 0; i < 1000000; i++) a = a.rest();
+        EXPECT_EQ(a.first(), 1000000);
+    }
+
+    TEST(InfiniteTest, TestInfinitePrefetch) {
+        std::atomic<uint64> calls{0};
+        auto next = [&calls](uint64 x) -> uint64 {
+            calls++;
+            if (x == 50) throw std::logic_error{"fifty"};
+            return x + 1;
+        };
+
+        {
+            infinite<uint64, decltype(next)> a = infinite<uint64, decltype(next)>{next, 0}.prefetch(10);
+
+            // the first ten are computed without being read.
+            for (int i = 0; i < 500 && calls < 10; i++)
+                std::this_thread::sleep_for(std::chrono::milliseconds{2});
+            EXPECT_EQ(calls, 10);
+
+            for (int i = 0; i < 20; i++) a = a.rest();
+            EXPECT_EQ(a.first(), 20);
+            for (int i = 0; i < 500 && calls < 30; i++)
+                std::this_thread::sleep_for(std::chrono::milliseconds{2});
+            EXPECT_EQ(calls, 30);
+
+            for (int i = 20; i < 50; i++) a = a.rest();
+            EXPECT_EQ(a.first(), 50);
+            EXPECT_THROW(a.rest(), std::logic_error);
+
+            // a failed element is computed again the next time it is read.
+            uint64 before = calls;
+            EXPECT_THROW(a.rest(), std::logic_error);
+            EXPECT_EQ(calls, before + 1);
+        }
+    }
+
+}
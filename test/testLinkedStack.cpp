@@ -3,6 +3,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include "data/tools/linked_stack.hpp"
+#include "data/tools/merge_sort.hpp"
 #include "gtest/gtest.h"
 
 namespace data {
@@ -112,11 +113,45 @@ namespace data {
         for (const int& x : t) ;
     }
 
-    // TODO
+    // none of these should recurse once per element. 
+    TEST(LinkedStackTest, TestLongLinkedStack) {
+        
+        const int max = 1000000;
+        stack<int> a{};
+        stack<int> b{};
+        for (int i = 0; i < max; i++) {
+            a = a << i;
+            b = b << i;
+        }
+        
+        EXPECT_EQ(a.size(), max);
+        EXPECT_TRUE(a.valid());
+        EXPECT_TRUE(a.contains(0));
+        EXPECT_FALSE(a.contains(max));
+        EXPECT_EQ(a, b);
+        EXPECT_NE(a, b.rest() << -1);
+        EXPECT_EQ(a.from(max - 1).first(), 0);
+        EXPECT_EQ(a[max - 2], 1);
+        EXPECT_TRUE(a.from(max).empty());
+        
+        // lists that share a tail. 
+        stack<int> c = a.rest() << -1;
+        EXPECT_EQ(c, a.rest() << -1);
+        EXPECT_EQ(c.rest(), a.rest());
+        
+        EXPECT_EQ(data::reverse(a).first(), 0);
+        
+        a = stack<int>{};
+        EXPECT_EQ(c.size(), max);
+        EXPECT_EQ(c[max - 1], 0);
+    }
+    
     TEST(LinkedStackTest, TestLinkedStackSort) {
         
-        /*EXPECT_TRUE(stack<int>(1, 2, 3, 4, 5) == sort(stack<int>(4, 5, 1, 3, 2)));
-        EXPECT_TRUE(stack<int>(1, 2, 3, 3, 4, 5) == sort(stack<int>(4, 3, 5, 1, 3, 2)));*/
+        EXPECT_TRUE(stack<int>(1, 2, 3, 4, 5) == sort(stack<int>(4, 5, 1, 3, 2)));
+        EXPECT_TRUE(stack<int>(1, 2, 3, 3, 4, 5) == sort(stack<int>(4, 3, 5, 1, 3, 2)));
+        EXPECT_TRUE(stack<int>(1, 2, 3, 3, 4, 5) == natural_merge_sort(stack<int>(4, 3, 5, 1, 3, 2)));
+        EXPECT_TRUE(stack<int>(1, 2, 3, 4, 5) == functional::stack::merge(stack<int>(1, 3, 5), stack<int>(2, 4)));
         
     }
 }
@@ -4,6 +4,7 @@
 
 #include <data/tools.hpp>
 #include "gtest/gtest.h"
+#include <vector>
 
 namespace data {
     
@@ -78,4 +79,90 @@ namespace data {
         EXPECT_EQ(p.right().size(), 0);
     }
     
+    template <typename traversal>
+    std::vector<int> collect(traversal t) {
+        std::vector<int> v{};
+        for (int x : t) v.push_back(x);
+        return v;
+    }
+    
+    TEST(LinkedTreeTest, TestLinkedTreeOrders) {
+        //       4
+        //     2   6
+        //    1 3 5
+        tree<int> t{4, tree<int>{2, tree<int>{1}, tree<int>{3}}, tree<int>{6, tree<int>{5}, tree<int>{}}};
+        
+        EXPECT_EQ(collect(t.pre_order()), (std::vector<int>{4, 2, 1, 3, 6, 5}));
+        EXPECT_EQ(collect(t.in_order()), (std::vector<int>{1, 2, 3, 4, 5, 6}));
+        EXPECT_EQ(collect(t.post_order()), (std::vector<int>{1, 3, 2, 5, 6, 4}));
+        EXPECT_EQ(collect(tree<int>{}.in_order()), std::vector<int>{});
+        
+        EXPECT_TRUE(t.contains(5));
+        EXPECT_FALSE(t.contains(7));
+        EXPECT_TRUE(t.valid());
+        
+        std::vector<int> v{1, 2, 3, 4, 5, 6};
+        tree<int> b = tree<int>::balanced(v.begin(), v.end());
+        EXPECT_EQ(collect(b.in_order()), v);
+        EXPECT_EQ(b.size(), 6);
+        EXPECT_LE(b.left().size() + 1, b.right().size() + 2);
+        EXPECT_EQ(b, (tree<int>{3, tree<int>{1, tree<int>{}, tree<int>{2}}, tree<int>{5, tree<int>{4}, tree<int>{6}}}));
+        EXPECT_NE(b, t);
+        
+        auto sum = [](int x, int l, int r) -> int { return x + l + r; };
+        EXPECT_EQ(t.fold(sum, 0), 21);
+        EXPECT_EQ(tree<int>{}.fold(sum, 0), 0);
+        
+        auto height = [](int, size_t l, size_t r) -> size_t { return 1 + std::max(l, r); };
+        EXPECT_EQ(b.fold(height, size_t{0}), 3);
+    }
+
+    // persistent trees may share subtrees, even between
+    // the two sides of a node.
+    TEST(LinkedTreeTest, TestSharedSubtrees) {
+        tree<int> leaf{1};
+        tree<int> s{0, leaf, leaf};
+        tree<int> d{2, s, s};
+
+        EXPECT_EQ(collect(s.post_order()), (std::vector<int>{1, 1, 0}));
+        EXPECT_EQ(collect(s.in_order()), (std::vector<int>{1, 0, 1}));
+        EXPECT_EQ(collect(s.pre_order()), (std::vector<int>{0, 1, 1}));
+        EXPECT_EQ(collect(d.post_order()), (std::vector<int>{1, 1, 0, 1, 1, 0, 2}));
+        EXPECT_EQ(collect(d.in_order()), (std::vector<int>{1, 0, 1, 2, 1, 0, 1}));
+        EXPECT_EQ(d.size(), 7);
+
+        auto sum = [](int x, int l, int r) -> int { return x + l + r; };
+        EXPECT_EQ(s.fold(sum, 0), 2);
+        EXPECT_EQ(d.fold(sum, 0), 6);
+        EXPECT_EQ(d.parallel_fold(sum, 0, 4, 1), 6);
+    }
+
+    TEST(LinkedTreeTest, TestLargeLinkedTree) {
+        // a chain a million deep. 
+        tree<int> chain{};
+        tree<int> other{};
+        for (int i = 0; i < 1000000; i++) {
+            chain = tree<int>{i, chain, tree<int>{}};
+            other = tree<int>{i, other, tree<int>{}};
+        }
+        EXPECT_TRUE(chain.contains(0));
+        EXPECT_TRUE(chain.valid());
+        EXPECT_EQ(chain, other);
+        EXPECT_EQ(collect(chain.in_order()).front(), 0);
+        EXPECT_EQ(collect(chain.post_order()).back(), 999999);
+        
+        std::vector<int> v(1000000);
+        for (int i = 0; i < 1000000; i++) v[i] = i;
+        tree<int> b = tree<int>::balanced(v.begin(), v.end());
+        tree<int> c = tree<int>::balanced(v.begin(), v.end());
+        EXPECT_EQ(b, c);
+        EXPECT_NE(b, chain);
+        
+        auto sum = [](int x, int64 l, int64 r) -> int64 { return x + l + r; };
+        int64 expected = 999999LL * 1000000LL / 2;
+        EXPECT_EQ(b.fold(sum, int64{0}), expected);
+        EXPECT_EQ(b.parallel_fold(sum, int64{0}, 4, 1000), expected);
+        EXPECT_EQ(chain.parallel_fold(sum, int64{0}, 4, 1000), expected);
+    }
+    
 }
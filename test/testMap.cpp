@@ -4,6 +4,9 @@
 
 #include <data/tools.hpp>
 #include "gtest/gtest.h"
+#include <map>
+#include <vector>
+#include <algorithm>
 
 namespace data {
     
@@ -51,5 +54,219 @@ namespace data {
         
         EXPECT_EQ(m1.remove(3), m2);
     }
+    
+    TEST(MapTest, TestReplaceInMap) {
+        
+        map<int, int> m1{{2, 1}, {3, 5}, {1, 7}};
+        map<int, int> m2{{2, 1}, {3, 4}, {1, 7}};
+        
+        EXPECT_EQ(m1.insert(3, 4), m2);
+        EXPECT_EQ(m1.insert(3, 4).size(), 3);
+        EXPECT_EQ(m1.insert(3, 5), m1);
+        EXPECT_EQ(m1.remove(4), m1);
+        EXPECT_TRUE(m1.remove(1).remove(2).remove(3).empty());
+    }
+    
+    // compare red-black deletion against std::map and check
+    // the red-black invariants after every step. 
+    TEST(MapTest, TestRedBlackDelete) {
+        using rb = milewski::okasaki::RBMap<int, int>;
+        
+        std::default_random_engine engine{1};
+        std::uniform_int_distribution<int> key{0, 499};
+        
+        rb t{};
+        std::map<int, int> expected{};
+        
+        for (int i = 0; i < 4000; i++) {
+            int k = key(engine);
+            if (i % 3 == 0) {
+                t = t.inserted(k, i);
+                expected.insert({k, i});
+            } else {
+                t = t.removed(k);
+                expected.erase(k);
+            }
+            
+            ASSERT_TRUE(t.isRedBlack());
+            
+            for (int j = 0; j < 500; j += 37) EXPECT_EQ(t.member(j), expected.count(j) == 1);
+        }
+        
+        map<int, int> m{};
+        for (int i = 0; i < 500; i++) m = m.insert(i, i);
+        for (int i = 0; i < 500; i += 2) m = m.remove(i);
+        EXPECT_EQ(m.size(), 250);
+        for (int i = 0; i < 500; i++) EXPECT_EQ(m.contains(i), i % 2 == 1);
+    }
+    
+    TEST(MapTest, TestMapIteration) {
+        
+        // entries are made as they are read, so they cannot be referred to. 
+        static_assert(std::is_same_v<std::iterator_traits<map<int, int>::const_iterator>::iterator_category, std::input_iterator_tag>);
+        
+        map<int, int> m{};
+        EXPECT_EQ(m.begin(), m.end());
+        EXPECT_EQ(m.lower_bound(3), m.end());
+        
+        for (int i = 0; i < 100; i++) m = m.insert((i * 37) % 100, i);
+        
+        int expected = 0;
+        for (const entry<int, int> e : m) {
+            EXPECT_EQ(e.Key, expected);
+            EXPECT_EQ(e.Value, m[e.Key]);
+            expected++;
+        }
+        EXPECT_EQ(expected, 100);
+        
+        map<int, int> evens{};
+        for (int i = 0; i < 100; i += 2) evens = evens.insert(i, i);
+        
+        EXPECT_EQ((*evens.lower_bound(10)).Key, 10);
+        EXPECT_EQ((*evens.lower_bound(11)).Key, 12);
+        EXPECT_EQ((*evens.upper_bound(10)).Key, 12);
+        EXPECT_EQ((*evens.upper_bound(-5)).Key, 0);
+        EXPECT_EQ(evens.lower_bound(99), evens.end());
+        EXPECT_EQ(evens.upper_bound(98), evens.end());
+        
+        int count = 0;
+        int next = 20;
+        for (const entry<int, int> e : evens.scan(19, 31)) {
+            EXPECT_EQ(e.Key, next);
+            next += 2;
+            count++;
+        }
+        EXPECT_EQ(count, 6);
+        
+        count = 0;
+        for ([[maybe_unused]] const entry<int, int> e : evens.scan(31, 19)) count++;
+        EXPECT_EQ(count, 0);
+    }
+    
+    TEST(MapTest, TestMapFromSorted) {
+        
+        for (int n = 0; n < 70; n++) {
+            std::vector<entry<int, int>> entries{};
+            for (int i = 0; i < n; i++) entries.push_back(entry<int, int>{2 * i, i});
+            
+            map<int, int> m = map<int, int>::from_sorted(entries.begin(), entries.end());
+            map<int, int> expected{};
+            for (const auto& e : entries) expected = expected.insert(e);
+            
+            EXPECT_EQ(m.size(), n);
+            EXPECT_EQ(m, expected);
+            
+            // the result must be a valid red-black tree, and 
+            // must stay one as it is changed. 
+            EXPECT_TRUE(m.valid());
+            for (int i = 0; i < 2 * n; i += 3) {
+                m = m.insert(i, 0).remove(i + 1);
+                ASSERT_TRUE(m.valid());
+            }
+        }
+        
+        std::vector<int> keys{1, 3, 4, 8, 9};
+        set<int> s = set<int>::from_sorted(keys.begin(), keys.end());
+        EXPECT_EQ(s.size(), 5);
+        for (int i = 0; i < 10; i++) EXPECT_EQ(s.contains(i), std::count(keys.begin(), keys.end(), i) == 1);
+    }
+    
+    TEST(MapTest, TestMapSetAlgebra) {
+        
+        milewski::okasaki::RBMap<int, int> a{};
+        milewski::okasaki::RBMap<int, int> b{};
+        std::map<int, int> ea{};
+        std::map<int, int> eb{};
+        
+        for (int i = 0; i < 2000; i++) {
+            int k = (i * 7919) % 3001;
+            if (i % 3 == 0) {
+                b = b.inserted(k, -i);
+                eb.emplace(k, -i);
+            } else {
+                a = a.inserted(k, i);
+                ea.emplace(k, i);
+            }
+            if (i % 5 == 0) {
+                a = a.inserted(k + 1, i);
+                ea.emplace(k + 1, i);
+            }
+        }
+        
+        using tree = milewski::okasaki::RBMap<int, int>;
+        
+        tree u = tree::united(a, b);
+        tree n = tree::intersected(a, b);
+        tree d = tree::subtracted(a, b);
+        
+        for (tree t : {u, n, d}) ASSERT_TRUE(t.isRedBlack());
+        
+        std::map<int, int> eu = ea;
+        eu.insert(eb.begin(), eb.end());
+        
+        size_t nn = 0;
+        size_t nd = 0;
+        for (int k = 0; k < 3003; k++) {
+            EXPECT_EQ(u.member(k), eu.count(k) == 1);
+            if (u.member(k)) {
+                EXPECT_EQ(u.findWithDefault(0, k), eu[k]);
+            }
+            
+            bool both = ea.count(k) == 1 && eb.count(k) == 1;
+            EXPECT_EQ(n.member(k), both);
+            if (both) {
+                EXPECT_EQ(n.findWithDefault(0, k), ea[k]);
+                nn++;
+            }
+            
+            bool only = ea.count(k) == 1 && eb.count(k) == 0;
+            EXPECT_EQ(d.member(k), only);
+            if (only) nd++;
+        }
+        
+        EXPECT_EQ(u.size(), eu.size());
+        EXPECT_EQ(n.size(), nn);
+        EXPECT_EQ(d.size(), nd);
+        
+        map<int, int> x{{1, 1}, {2, 2}, {3, 3}};
+        map<int, int> y{{3, 4}, {4, 4}};
+        EXPECT_EQ(x.insert(y), (map<int, int>{{1, 1}, {2, 2}, {3, 4}, {4, 4}}));
+        EXPECT_EQ(x.intersect(y), (map<int, int>{{3, 3}}));
+        EXPECT_EQ(x.remove(y), (map<int, int>{{1, 1}, {2, 2}}));
+        
+        set<int> p = set<int>{}.insert(1).insert(2).insert(3);
+        set<int> q = set<int>{}.insert(3).insert(4);
+        EXPECT_EQ(p & q, set<int>{}.insert(1).insert(2).insert(3).insert(4));
+        EXPECT_EQ(p | q, set<int>{}.insert(3));
+        EXPECT_EQ(p - q, set<int>{}.insert(1).insert(2));
+        EXPECT_EQ(p.remove(2), set<int>{}.insert(1).insert(3));
+    }
+    
+    TEST(MapTest, TestMapFindAll) {
+        
+        std::vector<entry<int, int>> entries{};
+        for (int i = 0; i < 20000; i++) entries.push_back(entry<int, int>{3 * i, i});
+        map<int, int> m = map<int, int>::from_sorted(entries.begin(), entries.end());
+        
+        // keys out of order, repeated, and missing. 
+        std::vector<int> keys{};
+        for (int i = 0; i < 30000; i++) keys.push_back((i * 7919) % 70000);
+        
+        for (uint32 threads : {1, 4}) {
+            std::vector<const int*> found = tool::find_all(m, keys.begin(), keys.end(), threads, 1000);
+            ASSERT_EQ(found.size(), keys.size());
+            for (size_t i = 0; i < keys.size(); i++) {
+                if (keys[i] % 3 == 0 && keys[i] < 60000) {
+                    ASSERT_NE(found[i], nullptr);
+                    EXPECT_EQ(*found[i], keys[i] / 3);
+                } else EXPECT_EQ(found[i], nullptr);
+            }
+        }
+        
+        EXPECT_EQ(tool::find_all(m, keys.begin(), keys.end(), 4, 0), tool::find_all(m, keys.begin(), keys.end(), 1));
+        EXPECT_EQ((tool::find_all(map<int, int>{}, keys.begin(), keys.end())[0]), nullptr);
+        EXPECT_TRUE(tool::find_all(m, keys.begin(), keys.begin()).empty());
+        
+        EXPECT_EQ((get_all<int, int>(m, list<int>{9, 1, 3, 9})), (list<int>{3, 1, 3}));
+    }
 }
-
@@ -0,0 +1,87 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <data/tools.hpp>
+#include <data/iterable.hpp>
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace data {
+
+    // compared by key only, so that stability can be checked.
+    struct keyed {
+        int Key;
+        int Index;
+
+        bool operator<(const keyed& k) const {
+            return Key < k.Key;
+        }
+
+        bool operator==(const keyed& k) const {
+            return Key == k.Key && Index == k.Index;
+        }
+    };
+
+    std::vector<keyed> random_keyed(size_t n, int range, uint32 seed) {
+        std::mt19937 random{seed};
+        std::vector<keyed> v(n);
+        for (size_t i = 0; i < n; i++) v[i] = keyed{static_cast<int>(random() % range), static_cast<int>(i)};
+        return v;
+    }
+
+    template <typename L>
+    std::vector<keyed> to_vector(L l) {
+        std::vector<keyed> v{};
+        for (; !l.empty(); l = l.rest()) v.push_back(l.first());
+        return v;
+    }
+
+    TEST(MergeSortTest, TestMergeSortStack) {
+        for (size_t n : {0, 1, 2, 31, 32, 33, 1000, 100000}) {
+            std::vector<keyed> v = random_keyed(n, 50, n);
+            stack<keyed> s = sorting::stack_from<stack<keyed>>(v.begin(), v.end());
+            list<keyed> l = sorting::stack_from<list<keyed>>(v.begin(), v.end());
+            std::stable_sort(v.begin(), v.end());
+            EXPECT_EQ(to_vector(merge_sort(s)), v);
+            EXPECT_EQ(to_vector(natural_merge_sort(s)), v);
+            EXPECT_EQ(to_vector(merge_sort(l)), v);
+        }
+    }
+
+    TEST(MergeSortTest, TestNaturalMergeSort) {
+        // runs going up and down, with repeated elements.
+        std::vector<keyed> v{};
+        for (int r = 0; r < 20; r++)
+            for (int i = 0; i < 500; i++)
+                v.push_back(keyed{r % 2 == 0 ? i / 3 : 500 - i / 3, static_cast<int>(v.size())});
+
+        std::vector<keyed> w = v;
+        std::vector<keyed> buffer = v;
+        sorting::natural_merge_sort(w.begin(), w.end(), buffer.begin());
+        std::vector<keyed> expected = v;
+        std::stable_sort(expected.begin(), expected.end());
+        EXPECT_EQ(w, expected);
+    }
+
+    TEST(MergeSortTest, TestParallelMergeSort) {
+        for (uint32 threads : {1, 2, 3, 8}) {
+            std::vector<keyed> v = random_keyed(200000, 1000, threads);
+            cross<keyed> c(v.size());
+            std::copy(v.begin(), v.end(), c.begin());
+            std::stable_sort(v.begin(), v.end());
+            cross<keyed> sorted = parallel_merge_sort(c, threads, 1000);
+            EXPECT_TRUE(std::equal(sorted.begin(), sorted.end(), v.begin(), v.end()));
+        }
+
+        bytes b(100000);
+        std::mt19937 random{1};
+        for (byte& x : b) x = static_cast<byte>(random());
+        bytes sorted = parallel_merge_sort(b, 4, 1000);
+        std::sort(b.begin(), b.end());
+        EXPECT_TRUE(std::equal(sorted.begin(), sorted.end(), b.begin(), b.end()));
+    }
+
+}
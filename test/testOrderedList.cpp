@@ -0,0 +1,81 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <data/tools.hpp>
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace data {
+    using ordered = tool::ordered_list<int>;
+
+    void expect_same(const ordered& o, const std::vector<int>& v) {
+        ASSERT_EQ(o.size(), v.size());
+        size_t i = 0;
+        for (int x : o) EXPECT_EQ(x, v[i++]);
+        EXPECT_EQ(i, v.size());
+        for (size_t j = 0; j < v.size(); j += 7) EXPECT_EQ(o[j], v[j]);
+        if (!v.empty()) {
+            EXPECT_EQ(o.first(), v.front());
+            EXPECT_EQ(o.last(), v.back());
+        }
+    }
+
+    TEST(OrderedListTest, TestOrderedList) {
+        ordered e{};
+        EXPECT_TRUE(e.empty());
+        EXPECT_EQ(e.begin(), e.end());
+        EXPECT_THROW(e.last(), std::out_of_range);
+
+        ordered o = ordered{} << 3 << 1 << 2 << 1;
+        expect_same(o, {1, 1, 2, 3});
+        expect_same(o.rest(), {1, 2, 3});
+        EXPECT_EQ(o, (tool::linked_stack<int>{1, 1, 2, 3}));
+        EXPECT_NE(o, (tool::linked_stack<int>{1, 2, 3}));
+        EXPECT_THROW(o[4], std::out_of_range);
+
+        ordered q{tool::functional_queue<tool::linked_stack<int>>{} << 5 << 4 << 6};
+        expect_same(q, {4, 5, 6});
+        expect_same(o << tool::linked_stack<int>{0, 7}, {0, 1, 1, 2, 3, 7});
+    }
+
+    TEST(OrderedListTest, TestOrderedListMerge) {
+        std::mt19937 random{7};
+        std::vector<int> a(2000);
+        std::vector<int> b(300);
+        for (int& x : a) x = random() % 1000;
+        for (int& x : b) x = random() % 1000;
+
+        ordered x = ordered::from(a.begin(), a.end());
+        std::sort(a.begin(), a.end());
+        expect_same(x, a);
+        EXPECT_EQ(ordered::from(a.begin(), a.end()), x);
+
+        ordered y{};
+        for (int i : b) y = y << i;
+        std::sort(b.begin(), b.end());
+        expect_same(y, b);
+
+        std::vector<int> m{};
+        std::merge(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(m));
+        expect_same(x.merge(y), m);
+        expect_same(y.merge(x), m);
+        expect_same(x.merge(ordered{}), a);
+        expect_same(ordered{}.merge(y), b);
+    }
+
+    TEST(OrderedListTest, TestOrderedListLarge) {
+        // this used to take quadratic time.
+        ordered o{};
+        for (int i = 100000; i > 0; i--) o = o << (i * 7919) % 100003;
+        EXPECT_EQ(o.size(), 100000);
+        int last = -1;
+        for (int x : o) {
+            EXPECT_LE(last, x);
+            last = x;
+        }
+    }
+
+}
@@ -2,7 +2,7 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
-#include "data/data.hpp"
+#include "data/math/permutation.hpp"
 #include "gtest/gtest.h"
 
 namespace data {
@@ -53,6 +53,49 @@ namespace data {
         EXPECT_EQ(c321.reverse(), c123);
         
     }
+    
+    TEST(PermutationTest, TestCycleRotation) {
+        using cycle = tool::cycle<uint32>;
+        
+        cycle c{1, 2, 3, 4};
+        EXPECT_EQ(c.rotate_left().head(), 2);
+        EXPECT_EQ(c.rotate_right().head(), 4);
+        EXPECT_EQ(c.rotate_left(5).head(), 2);
+        EXPECT_EQ(c.rotate_right(6).head(), 3);
+        EXPECT_EQ(c.rotate_left(3).rotate_right(3).head(), 1);
+        EXPECT_EQ(c.rotate_left(2)[3], 2);
+        EXPECT_EQ(c.rotate_left(2), c);
+        EXPECT_EQ(c.rotate_left(2).hash(), c.hash());
+        EXPECT_NE(c.hash(), (cycle{1, 2, 4, 3}).hash());
+        EXPECT_EQ(cycle{}.rotate_left(3), cycle{});
+        
+        EXPECT_EQ((cycle{3, 4, 1, 2}).normalize().head(), 1);
+        EXPECT_EQ(c.rotate_left(3).normalize().rotate_left().head(), 2);
+        
+        // with repeated elements the least rotation is not 
+        // just the one that starts with the least element. 
+        cycle r{2, 1, 2, 1, 1};
+        cycle n = r.normalize();
+        EXPECT_EQ((std::vector<uint32>(n.begin(), n.end())), (std::vector<uint32>{1, 1, 2, 1, 2}));
+        EXPECT_EQ(r, (cycle{1, 2, 1, 2, 1}));
+        EXPECT_EQ(r.hash(), (cycle{1, 2, 1, 2, 1}).hash());
+        EXPECT_NE(r, (cycle{1, 1, 2, 2, 1}));
+        EXPECT_EQ((cycle{1, 1, 1}).normalize().head(), 1);
+        
+        EXPECT_EQ(c.remove(), (cycle{2, 3, 4}));
+        EXPECT_EQ(c.rotate_left().remove(2), (cycle{4, 1}));
+        EXPECT_EQ(c.remove(4), cycle{});
+        EXPECT_EQ(c.remove(9), cycle{});
+        EXPECT_EQ(c.rotate_left().insert(5), (cycle{2, 3, 4, 1, 5}));
+        
+        std::vector<uint32> v{};
+        for (uint32 i = 0; i < 100000; i++) v.push_back((i * 7919 + 13) % 100000);
+        cycle big{v};
+        cycle turned = big;
+        for (uint32 i = 0; i < 100000; i++) turned = turned.rotate_left(i);
+        EXPECT_EQ(turned, big);
+        EXPECT_EQ(big.normalize().head(), 0);
+    }
     /*
     TEST(PermutationTest, TestPermutation) {
         using perm = permutation<uint32>;
@@ -0,0 +1,123 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <data/math/algebra/permutation_group.hpp>
+#include "gtest/gtest.h"
+#include <random>
+
+namespace data {
+    using dense = math::dense_permutation;
+    using group = math::algebra::permutation_group;
+
+    // cycles are written from 1, as they usually are.
+    dense cycles(size_t n, std::vector<std::vector<uint32>> c) {
+        for (auto& x : c) for (uint32& i : x) i--;
+        return dense::from_cycles(c, n);
+    }
+
+    void expect_closed(const group& g, uint64 seed) {
+        std::mt19937_64 random{seed};
+        for (const dense& x : g.generators()) EXPECT_TRUE(g.contains(x));
+        for (int i = 0; i < 20; i++) {
+            dense x = g.random(random);
+            dense y = g.random(random);
+            EXPECT_TRUE(g.contains(x));
+            EXPECT_TRUE(g.contains(x * y));
+            EXPECT_TRUE(g.contains(x.inverse()));
+        }
+    }
+
+    TEST(PermutationGroupTest, TestSymmetricAndAlternating) {
+        EXPECT_EQ(group{}.order(), 1);
+        EXPECT_EQ(group{4}.order(), 1);
+        EXPECT_EQ(group::symmetric(1).order(), 1);
+        EXPECT_EQ(group::symmetric(5).order(), 120);
+        EXPECT_EQ(group::alternating(5).order(), 60);
+        EXPECT_EQ(group::alternating(8).order(), 20160);
+
+        dense t = dense::from_cycles({{0, 1}});
+        EXPECT_TRUE(group::symmetric(5).contains(t));
+        EXPECT_FALSE(group::alternating(5).contains(t));
+        EXPECT_FALSE(group::symmetric(5).contains(dense::from_cycles({{0, 5}})));
+
+        // small groups go through Schreier-Sims.
+        group s5{5, group::symmetric(5).generators()};
+        EXPECT_FALSE(s5.is_symmetric());
+        EXPECT_EQ(s5.order(), 120);
+        group a5{5, group::alternating(5).generators()};
+        EXPECT_EQ(a5.order(), 60);
+        EXPECT_FALSE(a5.contains(t));
+
+        // large ones are recognized.
+        for (size_t n : {9, 10, 30, 200}) {
+            group s{n, group::symmetric(n).generators()};
+            group a{n, group::alternating(n).generators()};
+            EXPECT_TRUE(s.is_symmetric());
+            EXPECT_TRUE(a.is_alternating());
+            EXPECT_EQ(s.orbit_sizes().size(), n - 1);
+            EXPECT_EQ(a.orbit_sizes().size(), n - 2);
+            expect_closed(s, n);
+            expect_closed(a, n);
+        }
+
+        EXPECT_EQ((group{10, group::symmetric(10).generators()}.order()), 3628800);
+    }
+
+    TEST(PermutationGroupTest, TestSchreierSims) {
+        // dihedral group.
+        group d{50, {cycles(50, {{1, 50}, {2, 49}}) * cycles(50, {{3, 48}, {4, 47}, {5, 46}, {6, 45}, {7, 44}, {8, 43}, {9, 42},
+            {10, 41}, {11, 40}, {12, 39}, {13, 38}, {14, 37}, {15, 36}, {16, 35}, {17, 34}, {18, 33}, {19, 32}, {20, 31},
+            {21, 30}, {22, 29}, {23, 28}, {24, 27}, {25, 26}}), dense::from_cycles({[]() {
+                std::vector<uint32> c{};
+                for (uint32 i = 0; i < 50; i++) c.push_back(i);
+                return c;
+            }()})}};
+        EXPECT_EQ(d.order(), 100);
+        EXPECT_EQ(d.base().size(), 2);
+        expect_closed(d, 1);
+        EXPECT_FALSE(d.contains(dense::from_cycles({{0, 1}})));
+
+        group m11{11, {
+            cycles(11, {{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11}}),
+            cycles(11, {{3, 7, 11, 8}, {4, 10, 5, 6}})}};
+        EXPECT_EQ(m11.order(), 7920);
+        expect_closed(m11, 2);
+
+        group m12{12, {
+            cycles(12, {{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11}}),
+            cycles(12, {{3, 7, 11, 8}, {4, 10, 5, 6}}),
+            cycles(12, {{1, 12}, {2, 11}, {3, 6}, {4, 8}, {5, 9}, {7, 10}})}};
+        EXPECT_EQ(m12.order(), 95040);
+        EXPECT_FALSE(m12.is_symmetric());
+        expect_closed(m12, 3);
+        EXPECT_FALSE(m12.contains(dense::from_cycles({{0, 1}})));
+
+        EXPECT_THROW((group{3, {dense::from_cycles({{0, 5}})}}), std::invalid_argument);
+    }
+
+    TEST(PermutationGroupTest, TestRubiksCube) {
+        group cube{49, {
+            cycles(49, {{1, 3, 8, 6}, {2, 5, 7, 4}, {9, 33, 25, 17}, {10, 34, 26, 18}, {11, 35, 27, 19}}),
+            cycles(49, {{9, 11, 16, 14}, {10, 13, 15, 12}, {1, 17, 41, 40}, {4, 20, 44, 37}, {6, 22, 46, 35}}),
+            cycles(49, {{17, 19, 24, 22}, {18, 21, 23, 20}, {6, 25, 43, 16}, {7, 28, 42, 13}, {8, 30, 41, 11}}),
+            cycles(49, {{25, 27, 32, 30}, {26, 29, 31, 28}, {3, 38, 43, 19}, {5, 36, 45, 21}, {8, 33, 48, 24}}),
+            cycles(49, {{33, 35, 40, 38}, {34, 37, 39, 36}, {3, 9, 46, 32}, {2, 12, 47, 29}, {1, 14, 48, 27}}),
+            cycles(49, {{41, 43, 48, 46}, {42, 45, 47, 44}, {14, 22, 30, 38}, {15, 23, 31, 39}, {16, 24, 32, 40}})}};
+        EXPECT_EQ(cube.order<double>(), 43252003274489856000.0);
+        expect_closed(cube, 4);
+
+        // a single twisted corner.
+        EXPECT_FALSE(cube.contains(cycles(49, {{1, 9, 35}})));
+    }
+
+    TEST(PermutationGroupTest, TestCycleForm) {
+        using perm = math::permutation<uint32>;
+        using cycle = perm::cycle;
+        group g{4, list<perm>{perm{cycle{0, 1, 2, 3}}, perm{cycle{0, 2}}}};
+        EXPECT_EQ(g.order(), 8);
+        EXPECT_TRUE(g.contains(perm{cycle{1, 3}}));
+        EXPECT_FALSE(g.contains(perm{cycle{0, 1}}));
+    }
+
+}
@@ -0,0 +1,80 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <data/tools.hpp>
+#include <data/pipeline.hpp>
+#include <data/list/infinite.hpp>
+#include "gtest/gtest.h"
+
+namespace data {
+
+    TEST(PipelineTest, TestPipelineStack) {
+        stack<int> s{};
+        for (int i = 10; i > 0; i--) s = s << i;
+
+        auto square = [](int x) -> int {
+            return x * x;
+        };
+
+        auto even = [](int x) -> bool {
+            return x % 2 == 0;
+        };
+
+        auto v = pipeline::map(square, pipeline::filter(even, s));
+        EXPECT_EQ(pipeline::to<stack<int>>(v), (stack<int>{4, 16, 36, 64, 100}));
+        EXPECT_EQ(pipeline::to<list<int>>(v), (list<int>{4, 16, 36, 64, 100}));
+        EXPECT_EQ(pipeline::fold([](int a, int b) -> int {
+            return a + b;
+        }, 0, v), 220);
+
+        int count = 0;
+        for (int x : pipeline::take(3, v)) {
+            count++;
+            EXPECT_EQ(x, (2 * count) * (2 * count));
+        }
+        EXPECT_EQ(count, 3);
+
+        EXPECT_TRUE(pipeline::filter([](int) -> bool {
+            return false;
+        }, s).empty());
+        EXPECT_TRUE(pipeline::to<stack<int>>(pipeline::take(0, s)).empty());
+
+        auto z = pipeline::zip(s, v);
+        EXPECT_EQ(z.first(), (std::pair<int, int>{1, 4}));
+        EXPECT_EQ(z.rest().first(), (std::pair<int, int>{2, 16}));
+        EXPECT_EQ((pipeline::to<stack<std::pair<int, int>>>(z).size()), 5);
+    }
+
+    TEST(PipelineTest, TestPipelineInfinite) {
+        auto next = [](uint64 x) -> uint64 {
+            return x + 1;
+        };
+
+        infinite<uint64, decltype(next)> naturals{next, 0};
+
+        // the squares of the first five odd numbers.
+        auto v = pipeline::take(5, pipeline::map([](uint64 x) -> uint64 {
+            return x * x;
+        }, pipeline::filter([](uint64 x) -> bool {
+            return x % 2 == 1;
+        }, naturals)));
+
+        EXPECT_EQ(pipeline::to<list<uint64>>(v), (list<uint64>{1, 9, 25, 49, 81}));
+
+        auto pairs = pipeline::take(3, pipeline::zip(naturals, naturals.rest()));
+        uint64 i = 0;
+        for (const auto& p : pairs) {
+            EXPECT_EQ(p.first, i);
+            EXPECT_EQ(p.second, i + 1);
+            i++;
+        }
+        EXPECT_EQ(i, 3);
+
+        // long chains take constant space.
+        EXPECT_EQ(pipeline::fold([](uint64 a, uint64 b) -> uint64 {
+            return a + b;
+        }, uint64{0}, pipeline::take(1000000, naturals)), 499999500000);
+    }
+
+}
@@ -0,0 +1,141 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <data/tools.hpp>
+#include <data/tools/pairing_heap.hpp>
+#include <data/tools/binary_heap.hpp>
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace data {
+
+    template <typename heap>
+    void test_heap() {
+        heap e{};
+        EXPECT_TRUE(e.empty());
+        EXPECT_EQ(e.size(), 0);
+
+        heap h = e.insert(3).insert(1).insert(2);
+        EXPECT_EQ(h.size(), 3);
+        EXPECT_EQ(h.first(), 1);
+        EXPECT_EQ(h.rest().first(), 2);
+        EXPECT_EQ(h.rest().rest().first(), 3);
+        EXPECT_TRUE(h.rest().rest().rest().empty());
+
+        // old versions are not changed.
+        heap g = h.insert(0);
+        EXPECT_EQ(g.first(), 0);
+        EXPECT_EQ(h.first(), 1);
+        EXPECT_EQ(h.size(), 3);
+
+        std::mt19937 random{7};
+        std::vector<int> v{};
+        for (int i = 0; i < 1000; i++) v.push_back(random() % 100);
+
+        heap a = heap::from(v.begin(), v.begin() + 500);
+        heap b{};
+        for (auto i = v.begin() + 500; i != v.end(); ++i) b = b.insert(*i);
+        heap m = a.merge(b);
+        EXPECT_EQ(m.size(), v.size());
+
+        std::sort(v.begin(), v.end());
+        heap n = m;
+        for (int x : v) {
+            ASSERT_FALSE(n.empty());
+            EXPECT_EQ(n.first(), x);
+            n = n.rest();
+        }
+        EXPECT_TRUE(n.empty());
+        EXPECT_EQ(m.size(), v.size());
+        EXPECT_EQ(m.first(), v.front());
+    }
+
+    TEST(PriorityQueueTest, TestLeftistHeap) {
+        test_heap<tool::leftist_heap<int>>();
+    }
+
+    TEST(PriorityQueueTest, TestPairingHeap) {
+        test_heap<tool::pairing_heap<int>>();
+        test_heap<tool::pairing_heap<int, tool::allocation::local>>();
+
+        // long chains must not be destroyed recursively.
+        tool::pairing_heap<int> d{};
+        for (int i = 1000000; i > 0; i--) d = d.insert(i);
+        EXPECT_EQ(d.first(), 1);
+        EXPECT_EQ(d.rest().first(), 2);
+    }
+
+    template <typename heap>
+    void test_priority_queue() {
+        using queue = tool::priority_queue<int, stack<int>, heap>;
+
+        queue q{5, 3, 8, 1};
+        EXPECT_EQ(q.size(), 4);
+        EXPECT_EQ(q.first(), 1);
+        EXPECT_EQ(q.values(), (stack<int>{1, 3, 5, 8}));
+        EXPECT_EQ(q.insert(stack<int>{4, 0}).values(), (stack<int>{0, 1, 3, 4, 5, 8}));
+        EXPECT_EQ((queue{stack<int>{2, 9, 2}}.values()), (stack<int>{2, 2, 9}));
+        EXPECT_EQ(q.merge(queue{7, 6}).values(), (stack<int>{1, 3, 5, 6, 7, 8}));
+        EXPECT_EQ(q.rest().first(), 3);
+    }
+
+    TEST(PriorityQueueTest, TestPriorityQueue) {
+        test_priority_queue<tool::leftist_heap<int>>();
+        test_priority_queue<tool::pairing_heap<int>>();
+    }
+
+    TEST(PriorityQueueTest, TestBinaryHeap) {
+        using heap = tool::binary_heap<int>;
+
+        std::mt19937 random{11};
+        std::vector<int> v{};
+        for (int i = 0; i < 1000; i++) v.push_back(random() % 1000);
+
+        heap h{v.begin(), v.end()};
+        EXPECT_EQ(h.size(), v.size());
+        for (size_t i = 0; i < v.size(); i++) EXPECT_EQ(h[i], v[i]);
+
+        // change, remove and add some elements, doing the same to v.
+        for (size_t i = 0; i < v.size(); i += 3) {
+            v[i] -= 500;
+            h.decrease(i, v[i]);
+        }
+
+        for (size_t i = 1; i < v.size(); i += 5) {
+            v[i] = random() % 2000;
+            h.update(i, v[i]);
+        }
+
+        std::vector<bool> removed(v.size(), false);
+        for (size_t i = 2; i < v.size(); i += 7) {
+            h.remove(i);
+            removed[i] = true;
+            EXPECT_FALSE(h.contains(i));
+        }
+
+        EXPECT_THROW(h.remove(2), std::out_of_range);
+
+        std::vector<int> expected{};
+        for (size_t i = 0; i < v.size(); i++) if (!removed[i]) expected.push_back(v[i]);
+
+        for (int i = 0; i < 100; i++) {
+            int x = random() % 1000;
+            heap::handle n = h.insert(x);
+            EXPECT_EQ(h[n], x);
+            expected.push_back(x);
+        }
+
+        std::sort(expected.begin(), expected.end());
+        EXPECT_EQ(h.size(), expected.size());
+        for (int x : expected) {
+            ASSERT_FALSE(h.empty());
+            EXPECT_EQ(h.first(), x);
+            h.pop();
+        }
+        EXPECT_TRUE(h.empty());
+    }
+
+}
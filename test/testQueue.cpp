@@ -0,0 +1,96 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <data/tools.hpp>
+#include <data/tools/real_time_queue.hpp>
+#include "gtest/gtest.h"
+#include <deque>
+#include <vector>
+
+namespace data {
+    
+    template <typename queue>
+    void test_queue() {
+        
+        queue e{};
+        EXPECT_TRUE(e.empty());
+        EXPECT_EQ(e.size(), 0);
+        EXPECT_EQ(e.begin(), e.end());
+        
+        queue q = queue{} << 1 << 2 << 3;
+        EXPECT_EQ(q.size(), 3);
+        EXPECT_EQ(q.first(), 1);
+        EXPECT_EQ(q.rest().first(), 2);
+        EXPECT_EQ(q.rest().rest().rest(), e);
+        EXPECT_EQ(q, (queue{1, 2, 3}));
+        EXPECT_NE(q, (queue{1, 2}));
+        EXPECT_NE(q, (queue{1, 2, 4}));
+        EXPECT_EQ(q.prepend(0), (queue{0, 1, 2, 3}));
+        
+        int expected = 1;
+        for (int x : q) EXPECT_EQ(x, expected++);
+        EXPECT_EQ(expected, 4);
+        
+        // compare against std::deque while reusing old versions. 
+        std::vector<queue> versions{queue{}};
+        std::vector<std::deque<int>> expect{std::deque<int>{}};
+        for (int i = 0; i < 2000; i++) {
+            size_t v = (i * 7919) % versions.size();
+            queue x = versions[v];
+            std::deque<int> d = expect[v];
+            if (i % 3 == 2 && !x.empty()) {
+                EXPECT_EQ(x.first(), d.front());
+                x = x.rest();
+                d.pop_front();
+            } else if (i % 17 == 0) {
+                x = x.prepend(-i);
+                d.push_front(-i);
+            } else {
+                x = x << i;
+                d.push_back(i);
+            }
+            EXPECT_EQ(x.size(), d.size());
+            versions.push_back(x);
+            expect.push_back(d);
+        }
+        
+        for (size_t v = 0; v < versions.size(); v += 101) {
+            auto b = expect[v].begin();
+            for (int x : versions[v]) EXPECT_EQ(x, *b++);
+            EXPECT_EQ(b, expect[v].end());
+        }
+    }
+    
+    TEST(QueueTest, TestFunctionalQueue) {
+        test_queue<list<int>>();
+    }
+    
+    TEST(QueueTest, TestRealTimeQueue) {
+        test_queue<rt_list<int>>();
+    }
+    
+    TEST(QueueTest, TestLazyThrows) {
+        int calls = 0;
+        tool::lazy<int> x{std::function<int()>{[&calls]() -> int {
+            if (calls++ == 0) throw std::runtime_error{"first"};
+            return 7;
+        }}};
+        
+        EXPECT_THROW(x.force(), std::runtime_error);
+        EXPECT_FALSE(x.evaluated());
+        EXPECT_EQ(x.force(), 7);
+        EXPECT_EQ(x.force(), 7);
+        EXPECT_EQ(calls, 2);
+    }
+    
+    TEST(QueueTest, TestLongRealTimeQueue) {
+        tool::real_time_queue<int> q{};
+        for (int i = 0; i < 1000000; i++) q = q << i;
+        EXPECT_EQ(q.size(), 1000000);
+        for (int i = 0; i < 500000; i++) q = q.rest();
+        EXPECT_EQ(q.first(), 500000);
+        q = tool::real_time_queue<int>{};
+    }
+    
+}
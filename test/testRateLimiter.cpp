@@ -5,40 +5,59 @@
 
 #include <data/tools/rate_limiter.h>
 #include "gtest/gtest.h"
-#include <iostream>
+#include <atomic>
+#include <thread>
+#include <vector>
 
 namespace data {
     namespace tools {
+        // the time is given explicitly, so nothing
+        // here has to sleep or watch the clock.
         TEST(RateLimiterTest,testRateLimitLong) {
             rate_limiter limiter(3, 10);
-            ASSERT_EQ(limiter.getTime(),0);
-            ASSERT_EQ(limiter.getTime(),0);
-            ASSERT_EQ(limiter.getTime(),0);
-            long time1=limiter.getTime();
-            ASSERT_GT(time1,9);
-            sleep(2);
-            long time2=limiter.getTime();
+            ASSERT_EQ(limiter.getTime(100),0);
+            ASSERT_EQ(limiter.getTime(100),0);
+            ASSERT_EQ(limiter.getTime(100),0);
+            long time1=limiter.getTime(100);
+            ASSERT_EQ(time1,10);
+            long time2=limiter.getTime(102);
 
             ASSERT_LT(time2,time1);
-            sleep(time2);
-            ASSERT_EQ(limiter.getTime(),0);
-            sleep(30);
-            ASSERT_EQ(limiter.getTime(),0);
-            ASSERT_EQ(limiter.getTime(),0);
-            ASSERT_EQ(limiter.getTime(),0);
+            ASSERT_EQ(time2,8);
+            ASSERT_EQ(limiter.getTime(102 + time2),0);
+            ASSERT_EQ(limiter.getTime(140),0);
+            ASSERT_EQ(limiter.getTime(140),0);
+            ASSERT_EQ(limiter.getTime(140),0);
         }
+
+        // with the real clock, the wait can only be
+        // off by the one second that may go by.
         TEST(RateLimiterTest,testRateLimitShort) {
-            rate_limiter limiter(3, 10);
+            rate_limiter limiter(3, 1000);
             ASSERT_EQ(limiter.getTime(), 0);
             ASSERT_EQ(limiter.getTime(), 0);
             ASSERT_EQ(limiter.getTime(), 0);
             long time1 = limiter.getTime();
-            ASSERT_GT(time1, 9);
-            std::cout << time1 << std::endl;
-            sleep(1);
-            long time2 = limiter.getTime();
+            ASSERT_GE(time1, 999);
+            ASSERT_LE(time1, 1000);
+        }
 
-            ASSERT_LT(time2, time1);
+        // every call takes a place in the queue, so exactly
+        // as many calls go ahead at once as there are hits.
+        TEST(RateLimiterTest,testRateLimitConcurrent) {
+            rate_limiter limiter(100, 1000);
+            std::atomic<int> free{0};
+            std::atomic<int> waiting{0};
+            std::vector<std::thread> threads{};
+            for (int i = 0; i < 8; i++) threads.emplace_back([&limiter, &free, &waiting]() {
+                for (int j = 0; j < 50; j++) {
+                    if (limiter.getTime() == 0) free++;
+                    else waiting++;
+                }
+            });
+            for (auto &x : threads) x.join();
+            EXPECT_EQ(free, 100);
+            EXPECT_EQ(waiting, 300);
         }
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,145 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <data/tools/thread_pool.hpp>
+#include "gtest/gtest.h"
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace data {
+
+    // each call spawns a task for one side and waits for it,
+    // so the pool must run tasks while its workers wait.
+    uint64 fib(tool::thread_pool &p, uint32 n) {
+        if (n < 2) return n;
+        auto a = p.spawn([&p, n]() {
+            return fib(p, n - 1);
+        });
+        uint64 b = fib(p, n - 2);
+        return a.get() + b;
+    }
+
+    TEST(ThreadPoolTest, TestSpawn) {
+        for (uint32 threads : {1, 2, 4}) {
+            tool::thread_pool p{threads};
+            EXPECT_EQ(p.size(), threads);
+            EXPECT_FALSE(p.working());
+
+            auto x = p.spawn([]() {
+                return 2;
+            });
+            EXPECT_TRUE(x.valid());
+            EXPECT_EQ(x.get(), 2);
+            EXPECT_TRUE(x.ready());
+
+            std::atomic<int> count{0};
+            std::vector<tool::future<void>> v{};
+            for (int i = 0; i < 1000; i++) v.push_back(p.spawn([&count]() {
+                count++;
+            }));
+            for (auto &f : v) f.get();
+            EXPECT_EQ(count, 1000);
+
+            EXPECT_EQ(fib(p, 20), 6765);
+
+            auto e = p.spawn([]() -> int {
+                throw std::runtime_error{"oops"};
+            });
+            EXPECT_THROW(e.get(), std::runtime_error);
+        }
+
+        // tasks that are spawned before the pool is
+        // destroyed are run before it is destroyed.
+        std::atomic<int> count{0};
+        {
+            tool::thread_pool p{2};
+            for (int i = 0; i < 100; i++) p.spawn([&count]() {
+                count++;
+            });
+        }
+        EXPECT_EQ(count, 100);
+    }
+
+    TEST(ThreadPoolTest, TestThen) {
+        tool::thread_pool p{3};
+        auto x = p.spawn([]() {
+            return 3;
+        }).then([](int x) {
+            return std::to_string(x * 2);
+        }).then([](const std::string &s) {
+            return s + "!";
+        });
+        EXPECT_EQ(x.get(), "6!");
+
+        // a continuation of a future that is already ready.
+        auto y = p.spawn([]() {
+            return 1;
+        });
+        y.wait();
+        EXPECT_EQ(y.then([](int x) {
+            return x + 1;
+        }).get(), 2);
+
+        std::atomic<bool> ran{false};
+        auto z = p.spawn([]() {}).then([&ran]() {
+            ran = true;
+        });
+        z.get();
+        EXPECT_TRUE(ran);
+
+        // exceptions are passed on without calling the continuation.
+        bool called = false;
+        auto w = p.spawn([]() -> int {
+            throw std::logic_error{"oops"};
+        }).then([&called](int x) {
+            called = true;
+            return x;
+        });
+        EXPECT_THROW(w.get(), std::logic_error);
+        EXPECT_FALSE(called);
+    }
+
+    TEST(ThreadPoolTest, TestParallelFor) {
+        for (uint32 threads : {1, 4}) {
+            tool::thread_pool p{threads};
+            for (size_t grain : {0, 1, 7, 1000}) {
+                std::vector<int> v(10000, 0);
+                p.parallel_for(0, v.size(), [&v](size_t i) {
+                    v[i] += i;
+                }, grain);
+                for (size_t i = 0; i < v.size(); i++) EXPECT_EQ(v[i], i);
+            }
+
+            int never = 0;
+            p.parallel_for(5, 5, [&never](size_t) {
+                never++;
+            });
+            EXPECT_EQ(never, 0);
+
+            // nested inside a task.
+            std::atomic<uint64> sum{0};
+            p.spawn([&p, &sum]() {
+                p.parallel_for(0, 100, [&p, &sum](size_t i) {
+                    p.parallel_for(0, 100, [&sum, i](size_t j) {
+                        sum += i * j;
+                    }, 10);
+                }, 10);
+            }).get();
+            EXPECT_EQ(sum, 4950 * 4950);
+
+            EXPECT_THROW(p.parallel_for(0, 1000, [](size_t i) {
+                if (i == 500) throw std::out_of_range{"500"};
+            }, 10), std::out_of_range);
+        }
+
+        std::atomic<int> count{0};
+        tool::thread_pool::shared().parallel_for(0, 100, [&count](size_t) {
+            count++;
+        });
+        EXPECT_EQ(count, 100);
+    }
+
+}
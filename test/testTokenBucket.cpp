@@ -0,0 +1,113 @@
+// Copyright (c) 2021 Daniel Krawisz
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <data/tools/token_bucket.hpp>
+#include <data/tools/keyed_limiter.hpp>
+#include "gtest/gtest.h"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace data {
+    using namespace std::chrono_literals;
+    using bucket = tool::token_bucket;
+
+    TEST(TokenBucketTest, TestTokenBucket) {
+        EXPECT_THROW((bucket{0, 1s}), std::invalid_argument);
+        EXPECT_THROW((bucket{10, 1s, 0}), std::invalid_argument);
+        EXPECT_THROW((bucket{2, 1ns}), std::invalid_argument);
+
+        // ten per second, five at once.
+        bucket b{10, 1s, 5};
+        EXPECT_EQ(b.interval(), 100ms);
+        EXPECT_EQ(b.burst(), 5);
+
+        auto t = bucket::clock::now();
+        EXPECT_EQ(b.available(t), 5);
+        for (int i = 0; i < 5; i++) EXPECT_TRUE(b.try_acquire(1, t));
+        EXPECT_FALSE(b.try_acquire(1, t));
+        EXPECT_EQ(b.available(t), 0);
+
+        // one more every 100 ms.
+        EXPECT_FALSE(b.try_acquire(1, t + 99ms));
+        EXPECT_TRUE(b.try_acquire(1, t + 100ms));
+        EXPECT_FALSE(b.try_acquire(1, t + 150ms));
+        EXPECT_FALSE(b.try_acquire(2, t + 250ms));
+        EXPECT_TRUE(b.try_acquire(2, t + 300ms));
+
+        // it is full again after half a second, but no fuller.
+        EXPECT_EQ(b.available(t + 900ms), 5);
+        EXPECT_EQ(b.available(t + 10s), 5);
+        EXPECT_FALSE(b.try_acquire(6, t + 10s));
+        EXPECT_TRUE(b.try_acquire(5, t + 10s));
+
+        // reserve always takes the tokens and says how long to wait.
+        bucket r{1000, 1s};
+        EXPECT_EQ(r.reserve(1, t), 0ns);
+        EXPECT_EQ(r.reserve(1, t), 1ms);
+        EXPECT_EQ(r.reserve(3, t), 4ms);
+        EXPECT_EQ(r.reserve(1, t + 2ms), 3ms);
+        EXPECT_FALSE(r.try_acquire(1, t + 5ms));
+        EXPECT_TRUE(r.try_acquire(1, t + 6ms));
+
+        // reserving more than the burst leaves nothing
+        // until the tokens have been paid back.
+        bucket d{10, 1s, 5};
+        EXPECT_EQ(d.reserve(20, t), 1500ms);
+        EXPECT_EQ(d.available(t), 0);
+        EXPECT_EQ(d.available(t + 1500ms), 0);
+        EXPECT_EQ(d.available(t + 1600ms), 1);
+        EXPECT_EQ(d.available(t + 2s), 5);
+
+        auto start = bucket::clock::now();
+        bucket a{100, 1s};
+        for (int i = 0; i < 4; i++) a.acquire();
+        EXPECT_GE(bucket::clock::now() - start, 30ms);
+    }
+
+    // many threads race for the tokens at the same moment,
+    // and exactly as many as there are get them.
+    TEST(TokenBucketTest, TestContention) {
+        bucket b{1000, 1s, 5000};
+        auto t = bucket::clock::now();
+        std::atomic<uint32> got{0};
+        std::vector<std::thread> threads{};
+        for (int i = 0; i < 8; i++) threads.emplace_back([&b, &got, t]() {
+            for (int j = 0; j < 2000; j++) if (b.try_acquire(1, t)) got++;
+        });
+        for (auto &x : threads) x.join();
+        EXPECT_EQ(got, 5000);
+    }
+
+    TEST(TokenBucketTest, TestKeyedLimiter) {
+        tool::keyed_limiter<std::string> l{10, 1s, 2, 5};
+        auto t = bucket::clock::now();
+        EXPECT_EQ(l.size(), 0);
+        EXPECT_TRUE(l.try_acquire("alice", 1, t));
+        EXPECT_TRUE(l.try_acquire("alice", 1, t));
+        EXPECT_FALSE(l.try_acquire("alice", 1, t));
+        EXPECT_TRUE(l.try_acquire("bob", 2, t));
+        EXPECT_FALSE(l.try_acquire("bob", 1, t));
+        EXPECT_EQ(l.reserve("carol", 3, t), 100ms);
+        EXPECT_EQ(l.size(), 3);
+
+        EXPECT_TRUE(l.try_acquire("alice", 1, t + 100ms));
+        EXPECT_EQ(l.prune(t + 200ms), 1);
+        EXPECT_EQ(l.size(), 2);
+        EXPECT_EQ(l.prune(t + 300ms), 2);
+        EXPECT_EQ(l.size(), 0);
+
+        // each of several threads has its own key and its own rate.
+        tool::keyed_limiter<uint32> k{1000, 1s, 100};
+        std::vector<uint32> got(8, 0);
+        std::vector<std::thread> threads{};
+        for (uint32 i = 0; i < 8; i++) threads.emplace_back([&k, &got, i, t]() {
+            for (int j = 0; j < 1000; j++) if (k.try_acquire(i, 1, t)) got[i]++;
+        });
+        for (auto &x : threads) x.join();
+        EXPECT_EQ(got, std::vector<uint32>(8, 100));
+    }
+
+}